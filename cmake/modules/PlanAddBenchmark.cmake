@@ -0,0 +1,29 @@
+# - PLAN_ADD_BENCHMARK() adds a QTest based benchmark
+# PLAN_ADD_BENCHMARK( <name> <sources> LINK_LIBRARIES <library> [<library> [...]] [NAME_PREFIX <prefix>] )
+# The benchmark is added as a test labeled "benchmark", so it can be run with
+#   ctest -L benchmark
+# and excluded from normal test runs with
+#   ctest -LE benchmark
+# Besides the normal text output on stdout, the results are written in
+# QTest xml format to ${CMAKE_BINARY_DIR}/benchmarks/<prefix><name>.xml
+# so that they can be compared between builds.
+# Benchmarks are only built when BUILD_BENCHMARKS is ON.
+
+include(CMakeParseArguments)
+include(ECMMarkAsTest)
+
+macro(PLAN_ADD_BENCHMARK _name)
+    cmake_parse_arguments(_PAB "" "NAME_PREFIX" "LINK_LIBRARIES" ${ARGN})
+    set(_sources ${_PAB_UNPARSED_ARGUMENTS})
+    set(_target "${_PAB_NAME_PREFIX}${_name}")
+
+    add_executable(${_target} ${_sources})
+    target_link_libraries(${_target} ${_PAB_LINK_LIBRARIES})
+    ecm_mark_as_test(${_target})
+
+    file(MAKE_DIRECTORY "${CMAKE_BINARY_DIR}/benchmarks")
+    add_test(NAME ${_target}
+        COMMAND ${_target} -o "${CMAKE_BINARY_DIR}/benchmarks/${_target}.xml,xml" -o -,txt
+    )
+    set_tests_properties(${_target} PROPERTIES LABELS "benchmark" TIMEOUT 3600)
+endmacro()
@@ -0,0 +1,556 @@
+/* This file is part of the KDE project
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+// clazy:excludeall=qstring-arg
+#include "kptbatchrunner.h"
+
+#include "kptproject.h"
+#include "kptschedule.h"
+#include "kptschedulerplugin.h"
+#include "kptschedulerpluginloader.h"
+#include "kptbuiltinschedulerplugin.h"
+#include "kptcommand.h"
+#include "kptglobal.h"
+#include "kptpackage.h"
+#include "kptworkpackagemerger.h"
+#include "kptxmlloaderobject.h"
+#include "kptnodeitemmodel.h"
+#include "reportgenerator/ReportGenerator.h"
+#include "kptdebug.h"
+
+#ifdef PLAN_BATCH_ICALENDAR
+#include "icalendarwriter.h"
+#endif
+
+#include <KoStore.h>
+#include <KoStoreDevice.h>
+#include <KoXmlReader.h>
+#include <KoXmlWriter.h>
+
+#include <KLocalizedString>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QUrl>
+
+
+namespace KPlato
+{
+
+BatchRunner::BatchRunner( QObject *parent )
+    : QObject( parent ),
+    m_project( 0 ),
+    m_lastCalculated( 0 ),
+    m_result( Success )
+{
+    m_config.setReadWrite( true );
+    m_totalTimer.start();
+}
+
+BatchRunner::~BatchRunner()
+{
+    qDeleteAll( m_commands );
+    delete m_project;
+}
+
+void BatchRunner::loadSchedulerPlugins()
+{
+    beginStep( "plugins" );
+    m_schedulerPlugins[ "Built-in" ] = new BuiltinSchedulerPlugin( this );
+
+    SchedulerPluginLoader *loader = new SchedulerPluginLoader( this );
+    connect( loader, &SchedulerPluginLoader::pluginLoaded, this, [this]( const QString &key, SchedulerPlugin *plugin ) {
+        m_schedulerPlugins[ key ] = plugin;
+    } );
+    loader->loadAllPlugins();
+    if ( m_project ) {
+        m_project->setSchedulerPlugins( m_schedulerPlugins );
+    }
+    QJsonObject details;
+    details[ "plugins" ] = QJsonArray::fromStringList( schedulerPluginIds() );
+    endStep( true, Success, QString(), details );
+}
+
+QStringList BatchRunner::schedulerPluginIds() const
+{
+    return m_schedulerPlugins.keys();
+}
+
+Project *BatchRunner::project() const
+{
+    return m_project;
+}
+
+BatchRunner::Result BatchRunner::result() const
+{
+    return m_result;
+}
+
+void BatchRunner::setError( Result result, const QString &message )
+{
+    beginStep( "arguments" );
+    endStep( false, result, message );
+}
+
+bool BatchRunner::load( const QString &fileName )
+{
+    beginStep( "load" );
+    KoStore *store = KoStore::createStore( fileName, KoStore::Read, "", KoStore::Auto );
+    if ( store->bad() ) {
+        delete store;
+        return endStep( false, LoadError, i18n( "Not a valid Plan file: %1", fileName ) );
+    }
+    if ( ! store->open( "root" ) ) {
+        delete store;
+        return endStep( false, LoadError, i18n( "File does not have a maindoc.xml: %1", fileName ) );
+    }
+    KoXmlDocument document;
+    QString errorMsg;
+    int errorLine, errorColumn;
+    const bool parsed = document.setContent( store->device(), &errorMsg, &errorLine, &errorColumn );
+    store->close();
+    // The document info and view context are kept as they are, so that save() does not drop them
+    QMap<QString, QByteArray> entries;
+    foreach ( const QString &name, QStringList() << "documentinfo.xml" << "context.xml" << "preview.png" ) {
+        QByteArray data;
+        if ( store->hasFile( name ) && store->extractFile( name, data ) ) {
+            entries.insert( name, data );
+        }
+    }
+    delete store;
+    if ( ! parsed ) {
+        return endStep( false, LoadError, i18n( "Parsing error in %1 at line %2, column %3\nError message: %4", fileName, errorLine, errorColumn, errorMsg ) );
+    }
+    KoXmlElement plan = document.documentElement();
+    const QString mime = plan.attribute( "mime", QString() );
+    if ( mime != "application/x-vnd.kde.plan" ) {
+        return endStep( false, LoadError, i18n( "Invalid document. Expected mimetype application/x-vnd.kde.plan, got %1", mime ) );
+    }
+    // Documents from a newer version are loaded without asking, losing what is not understood
+    XMLLoaderObject loader;
+    loader.setMimetype( mime );
+    loader.setVersion( plan.attribute( "version", PLAN_FILE_SYNTAX_VERSION ) );
+    loader.startLoad();
+    Project *project = 0;
+    KoXmlNode n = plan.firstChild();
+    for ( ; ! n.isNull(); n = n.nextSibling() ) {
+        if ( ! n.isElement() ) {
+            continue;
+        }
+        KoXmlElement e = n.toElement();
+        if ( e.tagName() != "project" ) {
+            continue;
+        }
+        project = new Project( m_config, false );
+        loader.setProject( project );
+        if ( ! project->load( e, loader ) ) {
+            delete project;
+            project = 0;
+        }
+        break;
+    }
+    loader.stopLoad();
+    if ( project == 0 ) {
+        return endStep( false, LoadError, i18n( "Loading of project failed: %1", fileName ) );
+    }
+    if ( project->id().isEmpty() ) {
+        project->setId( project->uniqueNodeId() );
+        project->registerNodeId( project );
+    }
+    // Cleanup after possible bug, see MainDocument::loadXML()
+    foreach ( Node *node, project->nodeDict() ) {
+        foreach ( Schedule *s, node->schedules() ) {
+            if ( s->isDeleted() ) {
+                node->takeSchedule( s );
+                delete s;
+            }
+        }
+    }
+    project->setSchedulerPlugins( m_schedulerPlugins );
+    delete m_project;
+    m_project = project;
+    m_storeEntries = entries;
+
+    QJsonObject details;
+    details[ "file" ] = fileName;
+    details[ "tasks" ] = m_project->allTasks().count();
+    details[ "resources" ] = m_project->resourceList().count();
+    return endStep( true, Success, QString(), details );
+}
+
+bool BatchRunner::mergeWorkPackages( const QString &dirName )
+{
+    beginStep( "merge" );
+    if ( m_project == 0 ) {
+        return endStep( false, MergeError, i18n( "No project loaded" ) );
+    }
+    QDir dir( dirName, "*.planwork" );
+    if ( ! dir.exists() ) {
+        return endStep( false, MergeError, i18n( "Work package directory does not exist: %1", dirName ) );
+    }
+    WorkPackageMerger merger( *m_project );
+    // Merge the oldest first, as the application does
+    QMap<QDateTime, Package*> packages;
+    QJsonArray errors;
+    int ignored = 0;
+    foreach ( const QFileInfo &info, dir.entryInfoList( QDir::Files | QDir::Readable ) ) {
+        Package *package = merger.loadWorkPackage( QUrl::fromLocalFile( info.absoluteFilePath() ) );
+        if ( package == 0 ) {
+            // work packages for other projects are expected in a shared directory
+            warnPlan<<merger.errorMessage();
+            ++ignored;
+            continue;
+        }
+        if ( packages.contains( package->timeTag ) || merger.isMerged( package ) ) {
+            ++ignored;
+            delete package->project;
+            delete package;
+            continue;
+        }
+        packages.insert( package->timeTag, package );
+    }
+    int merged = 0;
+    m_project->beginBatchChange();
+    foreach ( Package *package, packages ) {
+        MacroCommand *cmd = merger.mergeWorkPackage( package );
+        if ( cmd ) {
+            cmd->redo();
+            m_commands << cmd;
+            ++merged;
+        } else {
+            errors << QString( "%1: %2" ).arg( package->url.toLocalFile(), merger.errorMessage() );
+        }
+        delete package->project;
+        delete package;
+    }
+    m_project->endBatchChange();
+
+    QJsonObject details;
+    details[ "merged" ] = merged;
+    details[ "ignored" ] = ignored;
+    if ( ! errors.isEmpty() ) {
+        details[ "errors" ] = errors;
+    }
+    return endStep( errors.isEmpty(), MergeError, errors.isEmpty() ? QString() : i18n( "Some work packages could not be merged" ), details );
+}
+
+int BatchRunner::calculateSchedule( ScheduleManager *sm )
+{
+    SchedulerPlugin *plugin = sm->schedulerPlugin();
+    if ( plugin == 0 ) {
+        return ScheduleManager::CalculationError;
+    }
+    plugin->calculate( *m_project, sm, true );
+    // the scheduler jobs are deleted later
+    QCoreApplication::sendPostedEvents( 0, QEvent::DeferredDelete );
+    return sm->calculationResult();
+}
+
+bool BatchRunner::calculate( const QStringList &names, const QString &pluginId )
+{
+    beginStep( "schedule" );
+    if ( m_project == 0 ) {
+        return endStep( false, ScheduleError, i18n( "No project loaded" ) );
+    }
+    if ( ! pluginId.isEmpty() && ! m_schedulerPlugins.contains( pluginId ) ) {
+        return endStep( false, ScheduleError, i18n( "Unknown scheduler: %1", pluginId ) );
+    }
+    QList<ScheduleManager*> managers;
+    if ( names.isEmpty() ) {
+        // allScheduleManagers() lists parents before their children
+        foreach ( ScheduleManager *sm, m_project->allScheduleManagers() ) {
+            if ( ! sm->isBaselined() ) {
+                managers << sm;
+            }
+        }
+        if ( m_project->allScheduleManagers().isEmpty() ) {
+            ScheduleManager *sm = m_project->createScheduleManager();
+            m_project->addScheduleManager( sm );
+            managers << sm;
+        }
+    } else {
+        foreach ( const QString &name, names ) {
+            ScheduleManager *sm = m_project->findScheduleManagerByName( name );
+            if ( sm == 0 ) {
+                return endStep( false, ScheduleError, i18n( "Unknown schedule: %1", name ) );
+            }
+            if ( sm->isBaselined() ) {
+                return endStep( false, ScheduleError, i18n( "Schedule is baselined: %1", name ) );
+            }
+            managers << sm;
+        }
+    }
+    QJsonArray schedules;
+    bool ok = true;
+    foreach ( ScheduleManager *sm, managers ) {
+        QJsonObject schedule;
+        schedule[ "name" ] = sm->name();
+        if ( sm->parentManager() && ! sm->parentManager()->isScheduled() ) {
+            // the parent must be scheduled
+            schedule[ "status" ] = QString( "skipped" );
+            schedules << schedule;
+            ok = false;
+            continue;
+        }
+        if ( ! pluginId.isEmpty() ) {
+            sm->setSchedulerPluginId( pluginId );
+        }
+        QElapsedTimer timer;
+        timer.start();
+        const int result = calculateSchedule( sm );
+        schedule[ "ms" ] = timer.elapsed();
+        schedule[ "scheduler" ] = sm->schedulerPluginId().isEmpty() ? QString( "Built-in" ) : sm->schedulerPluginId();
+        schedule[ "id" ] = (qint64)sm->scheduleId();
+        if ( result == ScheduleManager::CalculationDone && sm->isScheduled() ) {
+            schedule[ "status" ] = QString( "ok" );
+            m_lastCalculated = sm;
+        } else {
+            schedule[ "status" ] = QString( "failed" );
+            ok = false;
+        }
+        schedules << schedule;
+    }
+    QJsonObject details;
+    details[ "schedules" ] = schedules;
+    return endStep( ok, ScheduleError, ok ? QString() : i18n( "Not all schedules could be calculated" ), details );
+}
+
+bool BatchRunner::save( const QString &fileName )
+{
+    beginStep( "save" );
+    if ( m_project == 0 ) {
+        return endStep( false, SaveError, i18n( "No project loaded" ) );
+    }
+    KoStore *store = KoStore::createStore( fileName, KoStore::Write, "application/x-vnd.kde.plan", KoStore::Zip );
+    if ( store->bad() ) {
+        delete store;
+        return endStep( false, SaveError, i18n( "Could not create the file for saving: %1", fileName ) );
+    }
+    if ( ! store->open( "root" ) ) {
+        delete store;
+        return endStep( false, SaveError, i18n( "Not able to write '%1'. Partition full?", QString( "maindoc.xml" ) ) );
+    }
+    {
+        // Same format as MainDocument::saveXMLStream()
+        KoStoreDevice dev( store );
+        dev.open( QIODevice::WriteOnly );
+        KoXmlWriter writer( &dev );
+        writer.startDocument( "plan" );
+        writer.startElement( "plan" );
+        writer.addAttribute( "editor", "Plan" );
+        writer.addAttribute( "mime", "application/x-vnd.kde.plan" );
+        writer.addAttribute( "version", PLAN_FILE_SYNTAX_VERSION );
+        m_project->save( writer );
+        writer.endElement();
+        writer.endDocument();
+    }
+    bool ok = store->close();
+    for ( QMap<QString, QByteArray>::const_iterator it = m_storeEntries.constBegin(); ok && it != m_storeEntries.constEnd(); ++it ) {
+        if ( ! store->open( it.key() ) ) {
+            ok = false;
+            break;
+        }
+        ok = store->write( it.value() ) == it.value().size();
+        ok = store->close() && ok;
+    }
+    ok = ok && store->finalize();
+    delete store;
+    QJsonObject details;
+    details[ "file" ] = fileName;
+    return endStep( ok, SaveError, ok ? QString() : i18n( "Failed to save: %1", fileName ), details );
+}
+
+ScheduleManager *BatchRunner::reportManager( const QString &name ) const
+{
+    if ( ! name.isEmpty() ) {
+        return m_project->findScheduleManagerByName( name );
+    }
+    if ( m_lastCalculated ) {
+        return m_lastCalculated;
+    }
+    foreach ( ScheduleManager *sm, m_project->allScheduleManagers() ) {
+        if ( sm->isScheduled() ) {
+            return sm;
+        }
+    }
+    return 0;
+}
+
+static QString csvField( const QString &value )
+{
+    if ( value.contains( QLatin1Char( ',' ) ) || value.contains( QLatin1Char( '"' ) ) || value.contains( QLatin1Char( '\n' ) ) ) {
+        QString s = value;
+        s.replace( QLatin1Char( '"' ), QLatin1String( "\"\"" ) );
+        return QLatin1Char( '"' ) + s + QLatin1Char( '"' );
+    }
+    return value;
+}
+
+static void writeCsvRows( QTextStream &out, const QAbstractItemModel &model, const QModelIndex &parent )
+{
+    const int columns = model.columnCount();
+    for ( int row = 0; row < model.rowCount( parent ); ++row ) {
+        QStringList fields;
+        for ( int column = 0; column < columns; ++column ) {
+            fields << csvField( model.index( row, column, parent ).data().toString() );
+        }
+        out << fields.join( QLatin1Char( ',' ) ) << "\r\n";
+        writeCsvRows( out, model, model.index( row, 0, parent ) );
+    }
+}
+
+bool BatchRunner::exportCsv( const QString &fileName, const QString &name )
+{
+    beginStep( "csv" );
+    if ( m_project == 0 ) {
+        return endStep( false, ExportError, i18n( "No project loaded" ) );
+    }
+    ScheduleManager *sm = reportManager( name );
+    if ( ! name.isEmpty() && sm == 0 ) {
+        return endStep( false, ExportError, i18n( "Unknown schedule: %1", name ) );
+    }
+    QSaveFile file( fileName );
+    if ( ! file.open( QIODevice::WriteOnly ) ) {
+        return endStep( false, ExportError, i18n( "Failed to open output file: %1", fileName ) );
+    }
+    NodeItemModel model;
+    model.setProject( m_project );
+    model.setScheduleManager( sm );
+    {
+        QTextStream out( &file );
+        out.setCodec( "UTF-8" );
+        QStringList header;
+        for ( int column = 0; column < model.columnCount(); ++column ) {
+            header << csvField( model.headerData( column, Qt::Horizontal ).toString() );
+        }
+        out << header.join( QLatin1Char( ',' ) ) << "\r\n";
+        // parents are written before their children
+        writeCsvRows( out, model, QModelIndex() );
+    }
+    const bool ok = file.commit();
+    QJsonObject details;
+    details[ "file" ] = fileName;
+    details[ "schedule" ] = sm ? sm->name() : QString();
+    return endStep( ok, ExportError, ok ? QString() : file.errorString(), details );
+}
+
+bool BatchRunner::exportReport( const QString &templateFile, const QString &fileName, const QString &name )
+{
+    beginStep( "odt" );
+    if ( m_project == 0 ) {
+        return endStep( false, ExportError, i18n( "No project loaded" ) );
+    }
+    ScheduleManager *sm = reportManager( name );
+    if ( ! name.isEmpty() && sm == 0 ) {
+        return endStep( false, ExportError, i18n( "Unknown schedule: %1", name ) );
+    }
+    ReportGenerator rg;
+    rg.setReportType( "odt" );
+    rg.setTemplateFile( templateFile );
+    // the report generator takes an url
+    rg.setReportFile( QUrl::fromLocalFile( QFileInfo( fileName ).absoluteFilePath() ).toString() );
+    rg.setProject( m_project );
+    rg.setScheduleManager( sm );
+    QJsonObject details;
+    details[ "file" ] = fileName;
+    details[ "template" ] = templateFile;
+    details[ "schedule" ] = sm ? sm->name() : QString();
+    if ( ! rg.open() || ! rg.createReport() ) {
+        return endStep( false, ExportError, rg.lastError(), details );
+    }
+    return endStep( true, Success, QString(), details );
+}
+
+bool BatchRunner::exportICalendar( const QString &fileName, const QString &name )
+{
+    beginStep( "ical" );
+#ifdef PLAN_BATCH_ICALENDAR
+    if ( m_project == 0 ) {
+        return endStep( false, ExportError, i18n( "No project loaded" ) );
+    }
+    long id = NOTSCHEDULED;
+    if ( name.isEmpty() && m_lastCalculated == 0 ) {
+        id = ICalendarWriter::scheduleId( *m_project );
+    } else {
+        ScheduleManager *sm = reportManager( name );
+        if ( sm == 0 ) {
+            return endStep( false, ExportError, i18n( "Unknown schedule: %1", name ) );
+        }
+        id = sm->scheduleId();
+    }
+    QSaveFile file( fileName );
+    if ( ! file.open( QIODevice::WriteOnly ) ) {
+        return endStep( false, ExportError, i18n( "Failed to open output file: %1", fileName ) );
+    }
+    ICalendarWriter writer;
+    bool ok = writer.write( *m_project, id, file );
+    QString message = writer.errorMessage();
+    if ( ok ) {
+        ok = file.commit();
+        message = file.errorString();
+    } else {
+        file.cancelWriting();
+    }
+    QJsonObject details;
+    details[ "file" ] = fileName;
+    details[ "id" ] = (qint64)id;
+    return endStep( ok, ExportError, ok ? QString() : message, details );
+#else
+    Q_UNUSED( fileName );
+    Q_UNUSED( name );
+    return endStep( false, ExportError, i18n( "iCalendar export is not available, Plan was built without KCalCore" ) );
+#endif
+}
+
+void BatchRunner::beginStep( const QString &name )
+{
+    m_stepName = name;
+    m_stepTimer.start();
+}
+
+bool BatchRunner::endStep( bool ok, Result failure, const QString &message, const QJsonObject &details )
+{
+    QJsonObject step = details;
+    step[ "step" ] = m_stepName;
+    step[ "ms" ] = m_stepTimer.elapsed();
+    step[ "status" ] = ok ? QString( "ok" ) : QString( "error" );
+    if ( ! message.isEmpty() ) {
+        step[ "message" ] = message;
+    }
+    m_steps << step;
+    if ( ! ok && m_result == Success ) {
+        m_result = failure;
+    }
+    return ok;
+}
+
+QJsonObject BatchRunner::status() const
+{
+    QJsonObject status;
+    status[ "status" ] = m_result == Success ? QString( "ok" ) : QString( "error" );
+    status[ "result" ] = (int)m_result;
+    status[ "ms" ] = m_totalTimer.elapsed();
+    status[ "steps" ] = m_steps;
+    return status;
+}
+
+} //namespace KPlato
@@ -0,0 +1,133 @@
+/* This file is part of the KDE project
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef KPTBATCHRUNNER_H
+#define KPTBATCHRUNNER_H
+
+#include "kptconfigbase.h"
+
+#include <QObject>
+#include <QByteArray>
+#include <QMap>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QElapsedTimer>
+
+
+namespace KPlato
+{
+
+class Project;
+class ScheduleManager;
+class SchedulerPlugin;
+class MacroCommand;
+
+/**
+ * Schedules and reports on a project without any user interaction.
+ *
+ * The project is loaded from a .plan file, work packages are merged into it,
+ * the selected schedule managers are calculated synchronously and the result
+ * is saved and exported.
+ * Nothing here creates widgets, so it can run on a server without a display.
+ *
+ * Each step is timed, and the outcome of all steps is available as a json object from status().
+ */
+class BatchRunner : public QObject
+{
+    Q_OBJECT
+public:
+    /// The exit codes of the batch tool
+    enum Result {
+        Success = 0,
+        UsageError,
+        LoadError,
+        MergeError,
+        ScheduleError,
+        SaveError,
+        ExportError
+    };
+
+    explicit BatchRunner( QObject *parent = 0 );
+    ~BatchRunner();
+
+    /// Load the built-in scheduler and all installed scheduler plugins
+    void loadSchedulerPlugins();
+    /// The identifiers of the loaded scheduler plugins
+    QStringList schedulerPluginIds() const;
+
+    /// Load the project from the native file @p fileName
+    bool load( const QString &fileName );
+    /// Merge all work packages for this project found in directory @p dir, the oldest first
+    bool mergeWorkPackages( const QString &dir );
+    /**
+     * Calculate the schedule managers named @p names, or all managers that are not baselined
+     * if @p names is empty. A schedule manager is created if the project has none.
+     * If @p pluginId is not empty, the managers are calculated with this scheduler plugin.
+     */
+    bool calculate( const QStringList &names, const QString &pluginId );
+    /// Save the project to the native file @p fileName
+    bool save( const QString &fileName );
+
+    /// Export the task list of schedule @p name as comma separated values to @p fileName
+    bool exportCsv( const QString &fileName, const QString &name );
+    /// Create an odt report from @p templateFile for schedule @p name
+    bool exportReport( const QString &templateFile, const QString &fileName, const QString &name );
+    /// Export the tasks of schedule @p name as iCalendar todos to @p fileName
+    bool exportICalendar( const QString &fileName, const QString &name );
+
+    Project *project() const;
+    /// The result of the first failed step, or Success
+    Result result() const;
+    /// Mark the run as failed with @p result, typically on invalid arguments
+    void setError( Result result, const QString &message );
+    /// The timing and outcome of all steps run so far
+    QJsonObject status() const;
+
+private:
+    /// Start timing a step named @p name
+    void beginStep( const QString &name );
+    /// Record the current step, returns @p ok
+    bool endStep( bool ok, Result failure, const QString &message = QString(), const QJsonObject &details = QJsonObject() );
+    /// The manager named @p name, else the last calculated manager, else the first scheduled manager
+    ScheduleManager *reportManager( const QString &name ) const;
+    /// Calculate @p sm synchronously, returns the calculation result
+    int calculateSchedule( ScheduleManager *sm );
+
+private:
+    ConfigBase m_config;
+    Project *m_project;
+    QMap<QString, SchedulerPlugin*> m_schedulerPlugins;
+    /// The merge commands own the work packages added to the tasks, so they are kept as long as the project
+    QList<MacroCommand*> m_commands;
+    /// The entries of the loaded file that are not generated from the project, by name
+    QMap<QString, QByteArray> m_storeEntries;
+    ScheduleManager *m_lastCalculated;
+
+    Result m_result;
+    QJsonArray m_steps;
+    QString m_stepName;
+    QElapsedTimer m_stepTimer;
+    QElapsedTimer m_totalTimer;
+};
+
+} //namespace KPlato
+
+#endif
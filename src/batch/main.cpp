@@ -0,0 +1,121 @@
+/* This file is part of the KDE project
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+// clazy:excludeall=qstring-arg
+#include "kptbatchrunner.h"
+#include "config.h"
+
+#include <KAboutData>
+#include <KLocalizedString>
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QJsonDocument>
+#include <QLoggingCategory>
+#include <QTextStream>
+
+using namespace KPlato;
+
+/**
+ * Loads a project, merges work packages, calculates schedules and writes the results,
+ * all without a user interface.
+ * The outcome is printed to stdout as a single json object,
+ * the exit code is 0 on success, else the BatchRunner::Result of the first failed step.
+ */
+int main( int argc, char **argv )
+{
+    // Only the json status goes to stdout, keep the logs quiet unless asked for with QT_LOGGING_RULES
+    QLoggingCategory::setFilterRules("calligra.*.debug=false\n"
+                                     "calligra.*.warning=true");
+
+    QCoreApplication app( argc, argv );
+    KLocalizedString::setApplicationDomain( "calligraplan" );
+
+    KAboutData aboutData( QStringLiteral( "calligraplanbatch" ),
+                          i18nc( "application name", "Plan Batch" ),
+                          QStringLiteral( PLAN_VERSION_STRING ),
+                          i18n( "Schedule Plan projects and create reports without a user interface" ),
+                          KAboutLicense::GPL,
+                          i18n( "Copyright 1998-%1, The Plan Team", QStringLiteral( PLAN_YEAR ) ) );
+    KAboutData::setApplicationData( aboutData );
+
+    QCommandLineParser parser;
+    aboutData.setupCommandLine( &parser );
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument( QStringLiteral( "file" ), i18n( "The Plan file to process" ) );
+
+    const QCommandLineOption workPackagesOption( QStringLiteral( "workpackages" ), i18n( "Merge the work packages in <directory>" ), QStringLiteral( "directory" ) );
+    const QCommandLineOption scheduleOption( QStringLiteral( "schedule" ), i18n( "Calculate the schedule <name>. Can be given more than once. By default all schedules that are not baselined are calculated" ), QStringLiteral( "name" ) );
+    const QCommandLineOption noCalculateOption( QStringLiteral( "no-calculate" ), i18n( "Do not calculate any schedules" ) );
+    const QCommandLineOption schedulerOption( QStringLiteral( "scheduler" ), i18n( "Calculate with the scheduler plugin <id>" ), QStringLiteral( "id" ) );
+    const QCommandLineOption listSchedulersOption( QStringLiteral( "list-schedulers" ), i18n( "List the available scheduler plugins and exit" ) );
+    const QCommandLineOption outputOption( QStringList() << QStringLiteral( "o" ) << QStringLiteral( "output" ), i18n( "Save the project to <file>" ), QStringLiteral( "file" ) );
+    const QCommandLineOption reportScheduleOption( QStringLiteral( "report-schedule" ), i18n( "Use the schedule <name> for csv, odt and ical output. By default the last calculated schedule is used" ), QStringLiteral( "name" ) );
+    const QCommandLineOption csvOption( QStringLiteral( "csv" ), i18n( "Write the task list as comma separated values to <file>" ), QStringLiteral( "file" ) );
+    const QCommandLineOption odtOption( QStringLiteral( "odt" ), i18n( "Write an odt report to <file>, needs --odt-template" ), QStringLiteral( "file" ) );
+    const QCommandLineOption odtTemplateOption( QStringLiteral( "odt-template" ), i18n( "Create the odt report from the template <file>" ), QStringLiteral( "file" ) );
+    const QCommandLineOption icalOption( QStringLiteral( "ical" ), i18n( "Write the tasks as iCalendar todos to <file>" ), QStringLiteral( "file" ) );
+    parser.addOptions( QList<QCommandLineOption>()
+                       << workPackagesOption << scheduleOption << noCalculateOption
+                       << schedulerOption << listSchedulersOption << outputOption
+                       << reportScheduleOption << csvOption << odtOption << odtTemplateOption << icalOption );
+    parser.process( app );
+    aboutData.processCommandLine( &parser );
+
+    BatchRunner runner;
+    runner.loadSchedulerPlugins();
+
+    QTextStream out( stdout );
+    if ( parser.isSet( listSchedulersOption ) ) {
+        foreach ( const QString &id, runner.schedulerPluginIds() ) {
+            out << id << endl;
+        }
+        return 0;
+    }
+    const QStringList files = parser.positionalArguments();
+    const QString reportSchedule = parser.value( reportScheduleOption );
+    if ( files.count() != 1 ) {
+        runner.setError( BatchRunner::UsageError, i18n( "Exactly one Plan file must be given" ) );
+    } else if ( parser.isSet( odtOption ) != parser.isSet( odtTemplateOption ) ) {
+        runner.setError( BatchRunner::UsageError, i18n( "--odt and --odt-template must be used together" ) );
+    } else if ( runner.load( files.first() ) ) {
+        // Each step runs only if all previous steps succeeded
+        bool ok = true;
+        if ( parser.isSet( workPackagesOption ) ) {
+            ok = runner.mergeWorkPackages( parser.value( workPackagesOption ) );
+        }
+        if ( ok && ! parser.isSet( noCalculateOption ) ) {
+            ok = runner.calculate( parser.values( scheduleOption ), parser.value( schedulerOption ) );
+        }
+        if ( ok && parser.isSet( outputOption ) ) {
+            ok = runner.save( parser.value( outputOption ) );
+        }
+        if ( ok && parser.isSet( csvOption ) ) {
+            ok = runner.exportCsv( parser.value( csvOption ), reportSchedule );
+        }
+        if ( ok && parser.isSet( odtOption ) ) {
+            ok = runner.exportReport( parser.value( odtTemplateOption ), parser.value( odtOption ), reportSchedule );
+        }
+        if ( ok && parser.isSet( icalOption ) ) {
+            ok = runner.exportICalendar( parser.value( icalOption ), reportSchedule );
+        }
+    }
+    out << QJsonDocument( runner.status() ).toJson( QJsonDocument::Compact ) << endl;
+    return runner.result();
+}
@@ -0,0 +1,159 @@
+/* This file is part of the KDE project
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+// clazy:excludeall=qstring-arg
+#include "BatchRunnerTester.h"
+
+#include "kptbatchrunner.h"
+#include "kptproject.h"
+#include "kptschedule.h"
+#include "kptglobal.h"
+
+#include "tests/ProjectGenerator.h"
+
+#include <KoStore.h>
+#include <KoStoreDevice.h>
+#include <KoXmlWriter.h>
+
+#include <QFile>
+#include <QJsonArray>
+#include <QTest>
+
+
+namespace KPlato
+{
+
+// Written by MainDocument, not generated from the project
+static const QByteArray s_documentInfo =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    "<document-info><about><title>Generated</title></about><author><full-name>Tester</full-name></author></document-info>";
+static const QByteArray s_context =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    "<context><current-view name=\"ResourceEditor\"/></context>";
+
+void BatchRunnerTester::initTestCase()
+{
+    QVERIFY( m_dir.isValid() );
+    m_projectFile = m_dir.path() + "/generated.plan";
+
+    // Same format as MainDocument::saveXMLStream()
+    QScopedPointer<Project> project( ProjectGenerator::createProject( 20, 3, 1 ) );
+    QScopedPointer<KoStore> store( KoStore::createStore( m_projectFile, KoStore::Write, "application/x-vnd.kde.plan", KoStore::Zip ) );
+    QVERIFY( ! store->bad() );
+    QVERIFY( store->open( "root" ) );
+    {
+        KoStoreDevice dev( store.data() );
+        dev.open( QIODevice::WriteOnly );
+        KoXmlWriter writer( &dev );
+        writer.startDocument( "plan" );
+        writer.startElement( "plan" );
+        writer.addAttribute( "editor", "Plan" );
+        writer.addAttribute( "mime", "application/x-vnd.kde.plan" );
+        writer.addAttribute( "version", PLAN_FILE_SYNTAX_VERSION );
+        project->save( writer );
+        writer.endElement();
+        writer.endDocument();
+    }
+    QVERIFY( store->close() );
+    QVERIFY( store->open( "documentinfo.xml" ) );
+    QCOMPARE( store->write( s_documentInfo ), (qint64)s_documentInfo.size() );
+    QVERIFY( store->close() );
+    QVERIFY( store->open( "context.xml" ) );
+    QCOMPARE( store->write( s_context ), (qint64)s_context.size() );
+    QVERIFY( store->close() );
+    QVERIFY( store->finalize() );
+}
+
+void BatchRunnerTester::run()
+{
+    const QString savedFile = m_dir.path() + "/saved.plan";
+    const QString csvFile = m_dir.path() + "/tasks.csv";
+
+    BatchRunner runner;
+    runner.loadSchedulerPlugins();
+    QVERIFY( runner.schedulerPluginIds().contains( "Built-in" ) );
+
+    QVERIFY( runner.load( m_projectFile ) );
+    QVERIFY( runner.project() );
+    QCOMPARE( runner.project()->allTasks().count(), 22 );
+    QVERIFY( runner.project()->allScheduleManagers().isEmpty() );
+
+    // A schedule manager is created when the project has none
+    QVERIFY( runner.calculate( QStringList(), QString() ) );
+    QCOMPARE( runner.project()->allScheduleManagers().count(), 1 );
+    ScheduleManager *sm = runner.project()->allScheduleManagers().first();
+    QVERIFY( sm->isScheduled() );
+
+    QVERIFY( runner.save( savedFile ) );
+    QVERIFY( runner.exportCsv( csvFile, QString() ) );
+
+    QCOMPARE( runner.result(), BatchRunner::Success );
+    const QJsonObject status = runner.status();
+    QCOMPARE( status[ "status" ].toString(), QString( "ok" ) );
+    QCOMPARE( status[ "steps" ].toArray().count(), 4 );
+
+    // The saved project has the calculated schedule
+    BatchRunner reloaded;
+    QVERIFY( reloaded.load( savedFile ) );
+    QCOMPARE( reloaded.project()->allTasks().count(), 22 );
+    ScheduleManager *rsm = reloaded.project()->findScheduleManagerByName( sm->name() );
+    QVERIFY( rsm );
+    QVERIFY( rsm->isScheduled() );
+    QCOMPARE( reloaded.project()->endTime( rsm->scheduleId() ), runner.project()->endTime( sm->scheduleId() ) );
+
+    // A header and one row for each summary task and task
+    QFile csv( csvFile );
+    QVERIFY( csv.open( QIODevice::ReadOnly ) );
+    const QList<QByteArray> lines = csv.readAll().split( '\n' );
+    QCOMPARE( lines.count(), 1 + 22 + 1 ); // the last line is empty
+    QVERIFY( lines.last().isEmpty() );
+    QVERIFY( lines.at( 1 ).startsWith( "S1," ) );
+    QVERIFY( lines.at( 2 ).startsWith( "T1," ) );
+}
+
+void BatchRunnerTester::saveOverInput()
+{
+    // The nightly load, reschedule and save of the same file
+    const QString fileName = m_dir.path() + "/overwritten.plan";
+    QVERIFY( QFile::copy( m_projectFile, fileName ) );
+
+    BatchRunner runner;
+    runner.loadSchedulerPlugins();
+    QVERIFY( runner.load( fileName ) );
+    QVERIFY( runner.calculate( QStringList(), QString() ) );
+    QVERIFY( runner.save( fileName ) );
+
+    QScopedPointer<KoStore> store( KoStore::createStore( fileName, KoStore::Read, "", KoStore::Auto ) );
+    QVERIFY( ! store->bad() );
+    QVERIFY( store->hasFile( "root" ) );
+    QByteArray data;
+    QVERIFY( store->extractFile( "documentinfo.xml", data ) );
+    QCOMPARE( data, s_documentInfo );
+    QVERIFY( store->extractFile( "context.xml", data ) );
+    QCOMPARE( data, s_context );
+    store.reset();
+
+    // and the rescheduled project can be loaded again
+    BatchRunner reloaded;
+    QVERIFY( reloaded.load( fileName ) );
+    QCOMPARE( reloaded.project()->allScheduleManagers().count(), 1 );
+    QVERIFY( reloaded.project()->allScheduleManagers().first()->isScheduled() );
+}
+
+} //namespace KPlato
+
+QTEST_GUILESS_MAIN( KPlato::BatchRunnerTester )
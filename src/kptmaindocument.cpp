@@ -37,11 +37,13 @@
 #include "kpttask.h"
 #include "KPlatoXmlLoader.h"
 #include "kptpackage.h"
+#include "kptworkpackagemerger.h"
 #include "kptworkpackagemergedialog.h"
 #include "kptdebug.h"
 
 #include <KoStore.h>
 #include <KoXmlReader.h>
+#include <KoXmlWriter.h>
 #include <KoStoreDevice.h>
 #include <KoOdfReadStore.h>
 #include <KoUpdater.h>
@@ -52,11 +54,9 @@
 #include <QPainter>
 #include <QDir>
 #include <QMutableMapIterator>
-#include <QTemporaryFile>
 
 #include <klocalizedstring.h>
 #include <kmessagebox.h>
-#include <KIO/CopyJob>
 
 #include <kundo2command.h>
 
@@ -149,6 +149,12 @@ void MainDocument::setProject( Project *project )
     emit changed();
 }
 
+int MainDocument::previewRevision() const
+{
+    // paintContent() paints nothing, so the preview never changes
+    return 0;
+}
+
 bool MainDocument::loadOdf( KoOdfReadStore &odfStore )
 {
     warnPlan<< "OpenDocument not supported, let's try native xml format";
@@ -243,6 +249,8 @@ This test does not work any longer. KoXml adds a couple of elements not present
     }
 #endif
     m_xmlLoader.startLoad();
+    // Only the schedules in use are loaded in full, the others when they are needed
+    m_xmlLoader.setLoadSchedulesOnDemand( true );
     KoXmlNode n = plan.firstChild();
     for ( ; ! n.isNull(); n = n.nextSibling() ) {
         if ( ! n.isElement() ) {
@@ -277,6 +285,7 @@ This test does not work any longer. KoXml adds a couple of elements not present
             }
         }
     }
+    m_xmlLoader.setLoadSchedulesOnDemand( false );
     m_xmlLoader.stopLoad();
 
     if (updater) updater->setProgress(100); // the rest is only processing, not loading
@@ -307,6 +316,24 @@ QDomDocument MainDocument::saveXML()
     return document;
 }
 
+bool MainDocument::saveXMLStream( KoXmlWriter &writer )
+{
+    debugPlan;
+    writer.startDocument( "plan" );
+
+    writer.startElement( "plan" );
+    writer.addAttribute( "editor", "Plan" );
+    writer.addAttribute( "mime", "application/x-vnd.kde.plan" );
+    writer.addAttribute( "version", PLAN_FILE_SYNTAX_VERSION );
+
+    // Save the project
+    m_project->save( writer );
+
+    writer.endElement();
+    writer.endDocument();
+    return true;
+}
+
 QDomDocument MainDocument::saveWorkPackageXML( const Node *node, long id, Resource *resource )
 {
     debugPlan;
@@ -582,36 +609,7 @@ Package *MainDocument::loadWorkPackageXML( Project &project, QIODevice *, const
 
 bool MainDocument::extractFiles( KoStore *store, Package *package )
 {
-    if ( package->task == 0 ) {
-        errorPlan<<"No task!";
-        return false;
-    }
-    foreach ( Document *doc, package->task->documents().documents() ) {
-        if ( ! doc->isValid() || doc->type() != Document::Type_Product || doc->sendAs() != Document::SendAs_Copy ) {
-            continue;
-        }
-        if ( ! extractFile( store, package, doc ) ) {
-            return false;
-        }
-    }
-    return true;
-}
-
-bool MainDocument::extractFile( KoStore *store, Package *package, const Document *doc )
-{
-    QTemporaryFile tmpfile;
-    if ( ! tmpfile.open() ) {
-        errorPlan<<"Failed to open temporary file";
-        return false;
-    }
-    if ( ! store->extractFile( doc->url().fileName(), tmpfile.fileName() ) ) {
-        errorPlan<<"Failed to extract file:"<<doc->url().fileName()<<"to:"<<tmpfile.fileName();
-        return false;
-    }
-    package->documents.insert( tmpfile.fileName(), doc->url() );
-    tmpfile.setAutoRemove( false );
-    debugPlan<<"extracted:"<<doc->url().fileName()<<"->"<<tmpfile.fileName();
-    return true;
+    return WorkPackageMerger( *m_project ).extractFiles( store, package );
 }
 
 void MainDocument::autoCheckForWorkPackages()
@@ -677,10 +675,12 @@ void MainDocument::workPackageMergeDialogFinished( int result )
     }
     if ( result == KoDialog::Yes ) {
         // merge the oldest first
+        const QList<Package*> &packages = m_workpackages.values();
+        QList<const Package*> checked;
         foreach( int i, dlg->checkedList() ) {
-            const QList<Package*> &packages = m_workpackages.values();
-            mergeWorkPackage(packages.at(i));
+            checked << packages.at(i);
         }
+        mergeWorkPackages( checked );
         // 'Yes' was hit so terminate all packages
         foreach(const Package *p, m_workpackages) {
             terminateWorkPackage( p );
@@ -694,9 +694,39 @@ void MainDocument::workPackageMergeDialogFinished( int result )
 
 void MainDocument::mergeWorkPackages()
 {
+    QList<const Package*> packages;
     foreach (const Package *package, m_workpackages) {
-        mergeWorkPackage( package );
+        packages << package;
+    }
+    mergeWorkPackages( packages );
+}
+
+void MainDocument::mergeWorkPackages( const QList<const Package*> &packages )
+{
+    BatchMacroCommand *cmd = new BatchMacroCommand( *m_project, kundo2_i18n( "Merge work packages" ) );
+    // Each package is merged before the next one is compared with the task,
+    // but the views are only notified when all packages are merged
+    m_project->beginBatchChange();
+    foreach ( const Package *package, packages ) {
+        const Project &proj = *(package->project);
+        if ( proj.id() == m_project->id() && proj.childNode( 0 ) ) {
+            const Task *from = package->task;
+            Task *to = package->toTask;
+            if ( to && from ) {
+                MacroCommand *c = mergeWorkPackage( to, from, package );
+                if ( c ) {
+                    c->redo();
+                    cmd->addExecutedCommand( c );
+                }
+            }
+        }
+    }
+    m_project->endBatchChange();
+    if ( cmd->isEmpty() ) {
+        delete cmd;
+        return;
     }
+    addCommand( cmd );
 }
 
 void MainDocument::terminateWorkPackage( const Package *package )
@@ -741,102 +771,21 @@ void MainDocument::terminateWorkPackage( const Package *package )
 
 void MainDocument::mergeWorkPackage( const Package *package )
 {
-    const Project &proj = *(package->project);
-    if ( proj.id() == m_project->id() && proj.childNode( 0 ) ) {
-        const Task *from = package->task;
-        Task *to = package->toTask;
-        if ( to && from ) {
-            mergeWorkPackage( to, from, package );
-        }
-    }
+    mergeWorkPackages( QList<const Package*>() << package );
 }
 
-void MainDocument::mergeWorkPackage( Task *to, const Task *from, const Package *package )
+MacroCommand *MainDocument::mergeWorkPackage( Task *to, const Task *from, const Package *package )
 {
-    Resource *resource = m_project->findResource( package->ownerId );
-    if ( resource == 0 ) {
-        KMessageBox::error( 0, i18n( "The package owner '%1' is not a resource in this project. You must handle this manually.", package->ownerName ) );
-        return;
-    }
-
-    MacroCommand *cmd = new MacroCommand( kundo2_noi18n("Merge workpackage") );
-    Completion &org = to->completion();
-    const Completion &curr = from->completion();
-
-    if ( package->settings.progress ) {
-        if ( org.isStarted() != curr.isStarted() ) {
-            cmd->addCommand( new ModifyCompletionStartedCmd(org, curr.isStarted() ) );
-        }
-        if ( org.isFinished() != curr.isFinished() ) {
-            cmd->addCommand( new ModifyCompletionFinishedCmd( org, curr.isFinished() ) );
-        }
-        if ( org.startTime() != curr.startTime() ) {
-            cmd->addCommand( new ModifyCompletionStartTimeCmd( org, curr.startTime() ) );
-        }
-        if ( org.finishTime() != curr.finishTime() ) {
-            cmd->addCommand( new ModifyCompletionFinishTimeCmd( org, curr.finishTime() ) );
-        }
-        // TODO: review how/if to merge data from different resources
-        // remove entries
-        const QList<QDate> &dates = org.entries().keys();
-        for (const QDate &d : dates) {
-            if ( ! curr.entries().contains( d ) ) {
-                debugPlan<<"remove entry "<<d;
-                cmd->addCommand( new RemoveCompletionEntryCmd( org, d ) );
-            }
-        }
-        // add new entries / modify existing
-        const QList<QDate> &cdates = curr.entries().keys();
-        for (const QDate &d : cdates) {
-            if ( org.entries().contains( d ) && curr.entry( d ) == org.entry( d ) ) {
-                continue;
-            }
-            Completion::Entry *e = new Completion::Entry( *( curr.entry( d ) ) );
-            cmd->addCommand( new ModifyCompletionEntryCmd( org, d, e ) );
-        }
-    }
-    if ( package->settings.usedEffort ) {
-        Completion::UsedEffort *ue = new Completion::UsedEffort();
-        Completion::Entry prev;
-        Completion::EntryList::ConstIterator entriesIt = curr.entries().constBegin();
-        const Completion::EntryList::ConstIterator entriesEnd = curr.entries().constEnd();
-        for (; entriesIt != entriesEnd; ++entriesIt) {
-            const QDate &d = entriesIt.key();
-            const Completion::Entry &e = *entriesIt.value();
-            // set used effort from date entry and remove used effort from date entry
-            Completion::UsedEffort::ActualEffort effort( e.totalPerformed - prev.totalPerformed );
-            ue->setEffort( d, effort );
-            prev = e;
-        }
-        cmd->addCommand( new AddCompletionUsedEffortCmd( org, resource, ue ) );
-    }
-    bool docsaved = false;
-    if ( package->settings.documents ) {
-        //TODO: handle remote files
-        QMap<QString, QUrl>::const_iterator it = package->documents.constBegin();
-        QMap<QString, QUrl>::const_iterator end = package->documents.constEnd();
-        for ( ; it != end; ++it ) {
-            const QUrl src = QUrl::fromLocalFile(it.key());
-            KIO::CopyJob *job = KIO::move( src, it.value(), KIO::Overwrite );
-            if ( job->exec() ) {
-                docsaved = true;
-                //TODO: async
-                debugPlan<<"Moved file:"<<src<<it.value();
-            }
-        }
+    WorkPackageMerger merger( *m_project );
+    MacroCommand *cmd = merger.mergeWorkPackage( to, from, package );
+    if ( cmd == 0 ) {
+        KMessageBox::error( 0, merger.errorMessage() );
+        return 0;
     }
-    if ( ! docsaved && cmd->isEmpty() ) {
+    if ( merger.nothingToSave() ) {
         KMessageBox::information( 0, i18n( "Nothing to save from this package" ) );
     }
-    // add a copy to our tasks list of transmitted packages
-    WorkPackage *wp = new WorkPackage( from->workPackage() );
-    wp->setParentTask( to );
-    if ( ! wp->transmitionTime().isValid() ) {
-        wp->setTransmitionTime( package->timeTag );
-    }
-    wp->setTransmitionStatus( WorkPackage::TS_Receive );
-    cmd->addCommand( new WorkPackageAddCmd( m_project, to, wp ) );
-    addCommand( cmd );
+    return cmd;
 }
 
 void MainDocument::paintContent( QPainter &, const QRect &)
@@ -51,6 +51,7 @@ class ViewListItem;
 class View;
 
 class Package;
+class MacroCommand;
 
 class PLAN_EXPORT MainDocument : public KoDocument
 {
@@ -90,6 +91,8 @@ public:
     // The load and save functions. Look in the file kplato.dtd for info
     virtual bool loadXML( const KoXmlDocument &document, KoStore *store );
     virtual QDomDocument saveXML();
+    /// Stream the project to @p writer, used instead of saveXML() when saving to file
+    virtual bool saveXMLStream( KoXmlWriter &writer );
     /// Save a workpackage file containing @p node with schedule identity @p id, owned by @p resource
     QDomDocument saveWorkPackageXML( const Node *node, long id, Resource *resource = 0 );
 
@@ -99,7 +102,7 @@ public:
     Config &config() { return m_config; }
     Context *context() const { return m_context; }
 
-    WBSDefinition &wbsDefinition() { return m_project->wbsDefinition(); }
+    const WBSDefinition &wbsDefinition() const { return m_project->wbsDefinition(); }
 
     const XMLLoaderObject &xmlLoader() const { return m_xmlLoader; }
 
@@ -124,7 +127,6 @@ public:
     KPlatoAboutPage &aboutPage() { return m_aboutPage; }
 
     bool extractFiles( KoStore *store, Package *package );
-    bool extractFile( KoStore *store, Package *package, const Document *doc );
 
     void registerView( View *view );
 
@@ -180,7 +182,13 @@ protected:
     /// Save kplato specific files
     virtual bool completeSaving( KoStore* store );
 
-    void mergeWorkPackage( Task *to, const Task *from, const Package *package );
+    /// The preview does not show any project data, so it is the same for all revisions
+    virtual int previewRevision() const;
+
+    /// Merge @p packages as one undoable command, views are notified when all are merged
+    void mergeWorkPackages( const QList<const Package*> &packages );
+    /// Returns a command that merges @p package from @p from into @p to, or 0 if it can not be merged
+    MacroCommand *mergeWorkPackage( Task *to, const Task *from, const Package *package );
 
     // used by insert file
     struct InsertFileInfo {
@@ -242,6 +250,7 @@ private:
     bool m_skipSharedProjects;
 
     bool m_isTaskModule;
+
 };
 
 
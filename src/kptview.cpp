@@ -1665,6 +1665,10 @@ QAction *View::addScheduleAction( Schedule *sch )
 void View::slotViewScheduleManager(ScheduleManager *sm)
 {
     QApplication::setOverrideCursor( Qt::WaitCursor );
+    if ( sm ) {
+        // the schedule may not have been loaded yet
+        sm->restoreSchedule();
+    }
     setLabel(sm);
     emit currentScheduleManagerChanged(sm);
     QApplication::restoreOverrideCursor();
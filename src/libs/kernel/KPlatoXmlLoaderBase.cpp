@@ -298,7 +298,9 @@ bool KPlatoXmlLoaderBase::load( Project *project, const KoXmlElement &element, X
             }
             //debugPlanXml<<"Resource teams<---";
         } else if ( e.tagName() == "wbs-definition" ) {
-            load( project->wbsDefinition(), e, status );
+            WBSDefinition def = project->wbsDefinition();
+            load( def, e, status );
+            project->setWbsDefinition( def );
         } else if ( e.tagName() == "locale" ) {
             // handled earlier
         } else if ( e.tagName() == "resource-group" ) {
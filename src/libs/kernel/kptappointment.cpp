@@ -32,6 +32,7 @@
 #include "kptdebug.h"
 
 #include <KoXmlReader.h>
+#include <KoXmlWriter.h>
 
 
 namespace KPlato
@@ -186,6 +187,16 @@ void AppointmentInterval::saveXML(QDomElement &element) const
     me.setAttribute(QStringLiteral("load"), QString::number(d->load));
 }
 
+void AppointmentInterval::saveXML(KoXmlWriter &writer) const
+{
+    Q_ASSERT( isValid() );
+    writer.startElement("interval");
+    writer.addAttribute("start", d->start.toString( Qt::ISODate ));
+    writer.addAttribute("end", d->end.toString( Qt::ISODate ));
+    writer.addAttribute("load", QString::number(d->load));
+    writer.endElement();
+}
+
 bool AppointmentInterval::isValid() const {
     return d->start.isValid() && d->end.isValid() && d->start < d->end && d->load >= 0.0;
 }
@@ -572,6 +583,19 @@ void AppointmentIntervalList::saveXML( QDomElement &element ) const
     }
 }
 
+void AppointmentIntervalList::saveXML( KoXmlWriter &writer ) const
+{
+    foreach ( const AppointmentInterval &i, m_map ) {
+        i.saveXML( writer );
+#ifndef NDEBUG
+        if ( !i.isValid() ) {
+            // NOTE: This should not happen, so hunt down cause if it does
+            warnPlan<<"Invalid interval:"<<i;
+        }
+#endif
+    }
+}
+
 bool AppointmentIntervalList::loadXML( KoXmlElement &element, XMLLoaderObject &status )
 {
     KoXmlElement e;
@@ -769,6 +793,25 @@ void Appointment::saveXML(QDomElement &element) const {
     m_intervals.saveXML( me );
 }
 
+void Appointment::saveXML(KoXmlWriter &writer) const {
+    if (isEmpty()) {
+        errorPlan<<"Incomplete appointment data: No intervals";
+    }
+    if (m_resource == 0 || m_resource->resource() == 0) {
+        errorPlan<<"Incomplete appointment data: No resource";
+        return;
+    }
+    if (m_node == 0 || m_node->node() == 0) {
+        errorPlan<<"Incomplete appointment data: No node";
+        return; // shouldn't happen
+    }
+    writer.startElement("appointment");
+    writer.addAttribute("resource-id", m_resource->resource()->id());
+    writer.addAttribute("task-id", m_node->node()->id());
+    m_intervals.saveXML( writer );
+    writer.endElement();
+}
+
 // Returns the total planned effort for this appointment
 Duration Appointment::plannedEffort( const Resource *resource, EffortCostCalculationType type) const {
     if ( m_resource->resource() != resource ) {
@@ -35,6 +35,7 @@
 #include <QSharedData>
 
 class QDomElement;
+class KoXmlWriter;
 
 namespace KPlato
 {
@@ -78,6 +79,7 @@ public:
     
     bool loadXML(KoXmlElement &element, XMLLoaderObject &status);
     void saveXML(QDomElement &element) const;
+    void saveXML(KoXmlWriter &writer) const;
     
     const DateTime &startTime() const;
     void setStartTime( const DateTime &time );
@@ -122,6 +124,8 @@ public:
     bool loadXML(KoXmlElement &element, XMLLoaderObject &status);
     /// Save intervals to document
     void saveXML(QDomElement &element) const;
+    /// Save intervals to @p writer
+    void saveXML(KoXmlWriter &writer) const;
     
     AppointmentIntervalList &operator+=( const AppointmentIntervalList &lst );
     AppointmentIntervalList &operator-=( const AppointmentIntervalList &lst );
@@ -208,6 +212,7 @@ public:
 
     bool loadXML(KoXmlElement &element, XMLLoaderObject &status, Schedule &sch);
     void saveXML(QDomElement &element) const;
+    void saveXML(KoXmlWriter &writer) const;
 
     /**
      * Returns the planned effort and cost for the interval start to end (inclusive).
@@ -105,6 +105,49 @@ void MacroCommand::unexecute()
     }
 }
 
+qint64 MacroCommand::memoryUsage() const
+{
+    qint64 size = 0;
+    foreach ( const KUndo2Command *c, cmds ) {
+        size += c->memoryUsage();
+    }
+    return size;
+}
+
+bool MacroCommand::releaseMemory()
+{
+    bool released = false;
+    foreach ( KUndo2Command *c, cmds ) {
+        released = c->releaseMemory() || released;
+    }
+    return released;
+}
+
+void BatchMacroCommand::addExecutedCommand( KUndo2Command *cmd )
+{
+    addCommand( cmd );
+    m_executed = true;
+}
+
+void BatchMacroCommand::execute()
+{
+    if ( m_executed ) {
+        // executed when the batch was built
+        m_executed = false;
+        return;
+    }
+    m_project.beginBatchChange();
+    MacroCommand::execute();
+    m_project.endBatchChange();
+}
+
+void BatchMacroCommand::unexecute()
+{
+    m_project.beginBatchChange();
+    MacroCommand::unexecute();
+    m_project.endBatchChange();
+}
+
 //-------------------------------------------------
 CalendarAddCmd::CalendarAddCmd( Project *project, Calendar *cal, int pos, Calendar *parent, const KUndo2MagicString& name )
         : NamedCommand( name ),
@@ -2899,6 +2942,29 @@ void CalculateScheduleCmd::unexecute()
     m_sm->setExpected( m_oldexpected );
 }
 
+MainSchedule *CalculateScheduleCmd::retainedSchedule() const
+{
+    if ( m_sm.isNull() || m_sm->expected() == 0 ) {
+        return 0;
+    }
+    MainSchedule *sch = m_sm->expected() == m_oldexpected ? m_newexpected : m_oldexpected;
+    return sch == m_sm->expected() ? 0 : sch;
+}
+
+qint64 CalculateScheduleCmd::memoryUsage() const
+{
+    return m_node.scheduleMemoryUsage( retainedSchedule() );
+}
+
+bool CalculateScheduleCmd::releaseMemory()
+{
+    if ( m_sm.isNull() || m_sm->scheduling() ) {
+        return false;
+    }
+    // Restored by ScheduleManager::setExpected() on undo/redo
+    return m_node.releaseSchedule( retainedSchedule() );
+}
+
 //------------------------
 BaselineScheduleCmd::BaselineScheduleCmd( ScheduleManager &sm, const KUndo2MagicString& name )
     : NamedCommand( name ),
@@ -100,12 +100,44 @@ public:
     virtual void execute();
     virtual void unexecute();
 
+    virtual qint64 memoryUsage() const;
+    virtual bool releaseMemory();
+
     bool isEmpty() const { return cmds.isEmpty(); }
 
 protected:
     QList<KUndo2Command*> cmds;
 };
 
+/**
+ * A MacroCommand that executes and unexecutes its commands as one batch change of the project.
+ * Views are notified once for each changed node when all commands are done,
+ * instead of once for each command.
+ *
+ * If commands depend on the result of earlier commands, they can be executed while the batch
+ * is built and added with addExecutedCommand(). The first execute() is then skipped.
+ * Do not mix addCommand() and addExecutedCommand().
+ */
+class PLANKERNEL_EXPORT BatchMacroCommand : public MacroCommand
+{
+public:
+    explicit BatchMacroCommand( Project &project, const KUndo2MagicString& name = KUndo2MagicString() )
+        : MacroCommand( name ),
+        m_project( project ),
+        m_executed( false )
+    {}
+
+    /// Add @p cmd that has already been executed
+    void addExecutedCommand( KUndo2Command *cmd );
+
+    virtual void execute();
+    virtual void unexecute();
+
+private:
+    Project &m_project;
+    bool m_executed;
+};
+
 
 class PLANKERNEL_EXPORT CalendarAddCmd : public NamedCommand
 {
@@ -1608,7 +1640,14 @@ public:
     void execute();
     void unexecute();
 
+    /// Returns the memory used by the schedule that is not in use
+    qint64 memoryUsage() const;
+    /// Compress the schedule that is not in use, it is restored when needed
+    bool releaseMemory();
+
 private:
+    MainSchedule *retainedSchedule() const;
+
     Project &m_node;
     QPointer<ScheduleManager> m_sm;
     bool m_first;
@@ -0,0 +1,270 @@
+/*  This file is part of the KDE project
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+*/
+
+// clazy:excludeall=qstring-arg
+#include "kpteffortcube.h"
+
+#include "kptappointment.h"
+#include "kptnode.h"
+#include "kptproject.h"
+#include "kptresource.h"
+#include "kptschedule.h"
+#include "kptdebug.h"
+
+#include <QMap>
+
+#include <algorithm>
+#include <functional>
+
+
+namespace KPlato
+{
+
+static bool nodeLessThan( const Appointment *a1, const Appointment *a2 )
+{
+    return std::less<const Node*>()( a1->node()->node(), a2->node()->node() );
+}
+
+EffortCube::EffortCube()
+    : m_valid( false ),
+    m_id( -1 )
+{
+}
+
+void EffortCube::clear()
+{
+    m_valid = false;
+    m_id = -1;
+    m_startDate = QDate();
+    m_endDate = QDate();
+    m_resources.clear();
+    m_rowOffsets.clear();
+    m_nodes.clear();
+    m_days.clear();
+    m_efforts.clear();
+    m_costs.clear();
+    m_totalOffsets.clear();
+    m_totalDays.clear();
+    m_totalEfforts.clear();
+    m_totalCosts.clear();
+}
+
+void EffortCube::build( const Project *project, long id )
+{
+    clear();
+    m_id = id;
+    const QList<Resource*> resources = project->resourceList();
+    m_rowOffsets.reserve( resources.count() + 1 );
+    m_totalOffsets.reserve( resources.count() + 1 );
+    QMap<qint64, QPair<qint64, double> > totals;
+    foreach ( const Resource *r, resources ) {
+        m_resources.insert( r, m_rowOffsets.count() );
+        m_rowOffsets << m_nodes.count();
+        m_totalOffsets << m_totalDays.count();
+
+        QList<Appointment*> appointments;
+        foreach ( Appointment *a, r->appointments( id ) ) {
+            if ( a->node() && a->node()->node() ) {
+                appointments << a;
+            }
+        }
+        std::sort( appointments.begin(), appointments.end(), nodeLessThan );
+        totals.clear();
+        foreach ( const Appointment *a, appointments ) {
+            const Node *node = a->node()->node();
+            const double rate = a->resource() ? a->resource()->normalRatePrHour() : 0.0;
+            const QMultiMap<QDate, AppointmentInterval> &map = a->intervals().map();
+            // the intervals are sorted on date, so the rows of one appointment are added in order
+            int row = -1;
+            QMultiMap<QDate, AppointmentInterval>::const_iterator it;
+            for ( it = map.constBegin(); it != map.constEnd(); ++it ) {
+                const qint64 day = it.key().toJulianDay();
+                const Duration effort = it.value().effort();
+                const double cost = effort.toDouble( Duration::Unit_h ) * rate;
+                if ( row < 0 || m_days.at( row ) != day ) {
+                    row = m_nodes.count();
+                    m_nodes << node;
+                    m_days << day;
+                    m_efforts << 0;
+                    m_costs << 0.0;
+                }
+                m_efforts[ row ] += effort.milliseconds();
+                m_costs[ row ] += cost;
+                QPair<qint64, double> &total = totals[ day ];
+                total.first += effort.milliseconds();
+                total.second += cost;
+            }
+        }
+        QMap<qint64, QPair<qint64, double> >::const_iterator it;
+        for ( it = totals.constBegin(); it != totals.constEnd(); ++it ) {
+            m_totalDays << it.key();
+            m_totalEfforts << it.value().first;
+            m_totalCosts << it.value().second;
+        }
+        if ( ! totals.isEmpty() ) {
+            const QDate start = QDate::fromJulianDay( totals.firstKey() );
+            const QDate end = QDate::fromJulianDay( totals.lastKey() );
+            if ( ! m_startDate.isValid() || start < m_startDate ) {
+                m_startDate = start;
+            }
+            if ( ! m_endDate.isValid() || end > m_endDate ) {
+                m_endDate = end;
+            }
+        }
+    }
+    m_rowOffsets << m_nodes.count();
+    m_totalOffsets << m_totalDays.count();
+    m_valid = true;
+}
+
+bool EffortCube::rows( const Resource *resource, int &first, int &last ) const
+{
+    QHash<const Resource*, int>::const_iterator it = m_resources.constFind( resource );
+    if ( it == m_resources.constEnd() ) {
+        return false;
+    }
+    first = m_rowOffsets.at( it.value() );
+    last = m_rowOffsets.at( it.value() + 1 );
+    return first < last;
+}
+
+bool EffortCube::rows( const Resource *resource, const Node *node, int &first, int &last ) const
+{
+    if ( ! rows( resource, first, last ) ) {
+        return false;
+    }
+    QVector<const Node*>::const_iterator begin = m_nodes.constBegin();
+    QPair<QVector<const Node*>::const_iterator, QVector<const Node*>::const_iterator> range;
+    range = std::equal_range( begin + first, begin + last, node, std::less<const Node*>() );
+    first = range.first - begin;
+    last = range.second - begin;
+    return first < last;
+}
+
+bool EffortCube::totalRows( const Resource *resource, int &first, int &last ) const
+{
+    QHash<const Resource*, int>::const_iterator it = m_resources.constFind( resource );
+    if ( it == m_resources.constEnd() ) {
+        return false;
+    }
+    first = m_totalOffsets.at( it.value() );
+    last = m_totalOffsets.at( it.value() + 1 );
+    return first < last;
+}
+
+QList<const Node*> EffortCube::nodes( const Resource *resource ) const
+{
+    QList<const Node*> lst;
+    int first, last;
+    if ( rows( resource, first, last ) ) {
+        for ( int i = first; i < last; ++i ) {
+            if ( lst.isEmpty() || lst.last() != m_nodes.at( i ) ) {
+                lst << m_nodes.at( i );
+            }
+        }
+    }
+    return lst;
+}
+
+EffortCost EffortCube::effortCost( const Resource *resource ) const
+{
+    EffortCost ec;
+    int first, last;
+    if ( totalRows( resource, first, last ) ) {
+        qint64 effort = 0;
+        double cost = 0.0;
+        for ( int i = first; i < last; ++i ) {
+            effort += m_totalEfforts.at( i );
+            cost += m_totalCosts.at( i );
+        }
+        ec.add( Duration( effort ), cost );
+    }
+    return ec;
+}
+
+EffortCost EffortCube::effortCost( const Resource *resource, const QDate &date ) const
+{
+    EffortCost ec;
+    int first, last;
+    if ( totalRows( resource, first, last ) ) {
+        QVector<qint64>::const_iterator begin = m_totalDays.constBegin();
+        QVector<qint64>::const_iterator it = std::lower_bound( begin + first, begin + last, date.toJulianDay() );
+        if ( it != begin + last && *it == date.toJulianDay() ) {
+            const int row = it - begin;
+            ec.add( Duration( m_totalEfforts.at( row ) ), m_totalCosts.at( row ) );
+        }
+    }
+    return ec;
+}
+
+EffortCost EffortCube::effortCost( const Resource *resource, const Node *node ) const
+{
+    EffortCost ec;
+    int first, last;
+    if ( rows( resource, node, first, last ) ) {
+        qint64 effort = 0;
+        double cost = 0.0;
+        for ( int i = first; i < last; ++i ) {
+            effort += m_efforts.at( i );
+            cost += m_costs.at( i );
+        }
+        ec.add( Duration( effort ), cost );
+    }
+    return ec;
+}
+
+EffortCost EffortCube::effortCost( const Resource *resource, const Node *node, const QDate &date ) const
+{
+    EffortCost ec;
+    int first, last;
+    if ( rows( resource, node, first, last ) ) {
+        QVector<qint64>::const_iterator begin = m_days.constBegin();
+        QVector<qint64>::const_iterator it = std::lower_bound( begin + first, begin + last, date.toJulianDay() );
+        if ( it != begin + last && *it == date.toJulianDay() ) {
+            const int row = it - begin;
+            ec.add( Duration( m_efforts.at( row ) ), m_costs.at( row ) );
+        }
+    }
+    return ec;
+}
+
+EffortCostMap EffortCube::effortCostPrDay( const Resource *resource ) const
+{
+    EffortCostMap ec;
+    int first, last;
+    if ( totalRows( resource, first, last ) ) {
+        for ( int i = first; i < last; ++i ) {
+            ec.insert( QDate::fromJulianDay( m_totalDays.at( i ) ), Duration( m_totalEfforts.at( i ) ), m_totalCosts.at( i ) );
+        }
+    }
+    return ec;
+}
+
+EffortCostMap EffortCube::effortCostPrDay( const Resource *resource, const Node *node ) const
+{
+    EffortCostMap ec;
+    int first, last;
+    if ( rows( resource, node, first, last ) ) {
+        for ( int i = first; i < last; ++i ) {
+            ec.insert( QDate::fromJulianDay( m_days.at( i ) ), Duration( m_efforts.at( i ) ), m_costs.at( i ) );
+        }
+    }
+    return ec;
+}
+
+} //namespace KPlato
@@ -0,0 +1,118 @@
+/*  This file is part of the KDE project
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+*/
+
+#ifndef KPTEFFORTCUBE_H
+#define KPTEFFORTCUBE_H
+
+#include "plankernel_export.h"
+
+#include "kpteffortcostmap.h"
+
+#include <QDate>
+#include <QHash>
+#include <QVector>
+
+
+namespace KPlato
+{
+
+class Node;
+class Project;
+class Resource;
+
+/**
+ * EffortCube holds the planned effort and cost of a schedule
+ * per resource, task and day.
+ *
+ * The cube is built in one sweep over the appointments of all resources,
+ * only days with planned effort are stored.
+ * The values are stored column-wise, with the rows sorted on resource, task and day,
+ * so the values of a resource, or of a resource on a task, is a contiguous slice.
+ * The totals per resource and day are stored in the same way.
+ *
+ * Effort and cost are calculated like Appointment::plannedPrDay() with ECCT_All.
+ * The owner is responsible for calling clear() when the schedule changes.
+ */
+class PLANKERNEL_EXPORT EffortCube
+{
+public:
+    EffortCube();
+
+    /// Returns true if the cube has been built
+    bool isValid() const { return m_valid; }
+    /// Remove all values, the cube must be re-built before use
+    void clear();
+    /// Build the cube from the appointments of all resources in @p project for schedule @p id
+    void build( const Project *project, long id );
+
+    long id() const { return m_id; }
+    /// The first day with planned effort
+    QDate startDate() const { return m_startDate; }
+    /// The last day with planned effort
+    QDate endDate() const { return m_endDate; }
+
+    /// Returns the tasks @p resource is planned to work on
+    QList<const Node*> nodes( const Resource *resource ) const;
+
+    /// Returns the total planned effort and cost of @p resource
+    EffortCost effortCost( const Resource *resource ) const;
+    /// Returns the planned effort and cost of @p resource on @p date
+    EffortCost effortCost( const Resource *resource, const QDate &date ) const;
+    /// Returns the total planned effort and cost of @p resource on @p node
+    EffortCost effortCost( const Resource *resource, const Node *node ) const;
+    /// Returns the planned effort and cost of @p resource on @p node on @p date
+    EffortCost effortCost( const Resource *resource, const Node *node, const QDate &date ) const;
+
+    /// Returns the planned effort and cost of @p resource per day
+    EffortCostMap effortCostPrDay( const Resource *resource ) const;
+    /// Returns the planned effort and cost of @p resource on @p node per day
+    EffortCostMap effortCostPrDay( const Resource *resource, const Node *node ) const;
+
+protected:
+    /// Set the rows of @p resource to @p first and @p last (exclusive), returns false if there are none
+    bool rows( const Resource *resource, int &first, int &last ) const;
+    /// Set the rows of @p resource on @p node to @p first and @p last (exclusive), returns false if there are none
+    bool rows( const Resource *resource, const Node *node, int &first, int &last ) const;
+    /// Set the day total rows of @p resource to @p first and @p last (exclusive), returns false if there are none
+    bool totalRows( const Resource *resource, int &first, int &last ) const;
+
+private:
+    bool m_valid;
+    long m_id;
+    QDate m_startDate;
+    QDate m_endDate;
+    /// Index into the offset columns
+    QHash<const Resource*, int> m_resources;
+
+    /// The first row of each resource, the last entry is the number of rows
+    QVector<int> m_rowOffsets;
+    QVector<const Node*> m_nodes;
+    QVector<qint64> m_days; // julian day
+    QVector<qint64> m_efforts; // milliseconds
+    QVector<double> m_costs;
+
+    /// The first day total row of each resource, the last entry is the number of rows
+    QVector<int> m_totalOffsets;
+    QVector<qint64> m_totalDays;
+    QVector<qint64> m_totalEfforts;
+    QVector<double> m_totalCosts;
+};
+
+} //namespace KPlato
+
+#endif
@@ -0,0 +1,98 @@
+/*  This file is part of the KDE project
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+*/
+
+// clazy:excludeall=qstring-arg
+#include "kptevmsnapshot.h"
+
+#include "kptnode.h"
+#include "kptproject.h"
+#include "kptdebug.h"
+
+
+namespace KPlato
+{
+
+EvmSnapshot::EvmSnapshot()
+    : m_valid( false ),
+    m_id( -1 )
+{
+}
+
+bool EvmSnapshot::isValid( long id, const QDate &date ) const
+{
+    return m_valid && m_id == id && m_date == date;
+}
+
+void EvmSnapshot::clear()
+{
+    m_valid = false;
+    m_values.clear();
+}
+
+void EvmSnapshot::calculate( const Project *project, long id, const QDate &date )
+{
+    m_values.clear();
+    m_id = id;
+    m_date = date;
+    m_valid = true;
+    if ( project == 0 ) {
+        return;
+    }
+    m_values.reserve( project->allNodes().count() + 1 );
+    // The project calculates bcwp differently from tasks, so ask it directly
+    foreach ( const Node *n, project->childNodeIterator() ) {
+        calculate( n );
+    }
+    Values v;
+    v.plannedCostTo = project->plannedCostTo( date, id );
+    v.actualCostTo = project->actualCostTo( id, date );
+    v.bcws = project->bcws( date, id );
+    v.bcwp = project->bcwp( id );
+    v.bcwpTo = project->bcwp( date, id );
+    v.acwp = project->acwp( date, id );
+    v.spi = v.bcws > 0.0 ? v.bcwpTo / v.bcws : 1.0;
+    m_values.insert( project, v );
+}
+
+const EvmSnapshot::Values &EvmSnapshot::calculate( const Node *node )
+{
+    Values v;
+    if ( node->type() == Node::Type_Summarytask ) {
+        // Summary tasks sums up their children, so use the values we already have
+        foreach ( const Node *n, node->childNodeIterator() ) {
+            const Values &cv = calculate( n );
+            v.plannedCostTo += cv.plannedCostTo;
+            v.actualCostTo += cv.actualCostTo;
+            v.bcwp += cv.bcwp;
+            v.bcwpTo += cv.bcwpTo;
+            v.acwp += cv.acwp;
+        }
+        v.bcws = v.plannedCostTo;
+    } else {
+        v.plannedCostTo = node->plannedCostTo( m_date, m_id );
+        v.actualCostTo = node->actualCostTo( m_id, m_date );
+        v.bcws = node->bcws( m_date, m_id );
+        v.bcwp = node->bcwp( m_id );
+        v.bcwpTo = node->bcwp( m_date, m_id );
+        v.acwp = node->acwp( m_date, m_id );
+    }
+    v.spi = v.bcws > 0.0 ? v.bcwpTo / v.bcws : 1.0;
+    return *m_values.insert( node, v );
+}
+
+} //namespace KPlato
@@ -0,0 +1,95 @@
+/*  This file is part of the KDE project
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+*/
+
+#ifndef KPTEVMSNAPSHOT_H
+#define KPTEVMSNAPSHOT_H
+
+#include "plankernel_export.h"
+
+#include "kpteffortcostmap.h"
+
+#include <QDate>
+#include <QHash>
+
+
+namespace KPlato
+{
+
+class Node;
+class Project;
+
+/**
+ * EvmSnapshot holds the earned value figures of all nodes in a project
+ * for one schedule and status date.
+ *
+ * The values are calculated in one bottom-up pass over the work breakdown structure:
+ * leaf tasks are asked for their values, summary tasks sum the values of their children.
+ * The owner is responsible for calling clear() when the project changes.
+ *
+ * NodeModel uses it for the earned value columns. The performance chart views
+ * show values per day, and calculate them from EffortCostMap instead.
+ */
+class PLANKERNEL_EXPORT EvmSnapshot
+{
+public:
+    struct Values {
+        Values() : plannedCostTo( 0.0 ), bcws( 0.0 ), bcwp( 0.0 ), bcwpTo( 0.0 ), spi( 1.0 ) {}
+        /// Planned cost up to and including the status date
+        double plannedCostTo;
+        /// Actual cost up to and including the status date
+        EffortCost actualCostTo;
+        /// Budgeted Cost of Work Scheduled at the status date
+        double bcws;
+        /// Budgeted Cost of Work Performed (today)
+        double bcwp;
+        /// Budgeted Cost of Work Performed at the status date
+        double bcwpTo;
+        /// Actual Cost of Work Performed at the status date
+        EffortCost acwp;
+        /// Schedule Performance Index at the status date
+        double spi;
+    };
+
+    EvmSnapshot();
+
+    /// Returns true if the snapshot has been calculated for schedule @p id at @p date
+    bool isValid( long id, const QDate &date ) const;
+    /// Remove all values, the snapshot must be re-calculated before use
+    void clear();
+    /// Calculate values for all nodes in @p project for schedule @p id at status date @p date
+    void calculate( const Project *project, long id, const QDate &date );
+
+    long id() const { return m_id; }
+    QDate date() const { return m_date; }
+
+    /// Returns the values for @p node. Returns default values if @p node is unknown.
+    Values values( const Node *node ) const { return m_values.value( node ); }
+
+protected:
+    const Values &calculate( const Node *node );
+
+private:
+    bool m_valid;
+    long m_id;
+    QDate m_date;
+    QHash<const Node*, Values> m_values;
+};
+
+} //namespace KPlato
+
+#endif
@@ -24,11 +24,13 @@
 #include "kptaccount.h"
 #include "kptwbsdefinition.h"
 #include "kptresource.h"
+#include "kptproject.h"
 #include "kptschedule.h"
 #include "kptxmlloaderobject.h"
 #include "kptdebug.h"
 
 #include <KoXmlReader.h>
+#include <KoXmlWriter.h>
 
 #include <KLocalizedString>
 
@@ -121,6 +123,10 @@ void Node::init() {
     m_shutdownAccount = 0;
     m_startupCost = 0.0;
     m_shutdownCost = 0.0;
+
+    m_childIndex = -1;
+    m_wbsCodeGeneration = -1;
+    m_sortableWbsCodeGeneration = -1;
 }
 
 QString Node::typeToString( bool trans ) const
@@ -193,11 +199,14 @@ const Node *Node::projectNode() const {
 void Node::takeChildNode( Node *node) {
     //debugPlan<<"find="<<m_nodes.indexOf(node);
     int t = type();
-    int i = m_nodes.indexOf(node);
+    int i = indexOf(node);
     if ( i != -1 ) {
         m_nodes.removeAt(i);
+        childNodesMoved( i );
     }
     node->setParentNode(0);
+    node->m_childIndex = -1;
+    node->invalidateWbsCode();
     if ( t != type() ) {
         changed( Type );
     }
@@ -208,8 +217,11 @@ void Node::takeChildNode( int number ) {
     if (number >= 0 && number < m_nodes.size()) {
         Node *n = m_nodes.takeAt(number);
         //debugPlan<<(n?n->id():"null")<<" :"<<(n?n->name():"");
+        childNodesMoved( number );
         if (n) {
             n->setParentNode( 0 );
+            n->m_childIndex = -1;
+            n->invalidateWbsCode();
         }
     }
     if ( t != type() ) {
@@ -219,11 +231,14 @@ void Node::takeChildNode( int number ) {
 
 void Node::insertChildNode( int index, Node *node ) {
     int t = type();
-    if (index == -1)
+    if (index == -1 || index >= m_nodes.count()) {
+        index = m_nodes.count();
         m_nodes.append(node);
-    else
+    } else {
         m_nodes.insert(index,node);
+    }
     node->setParentNode( this );
+    childNodesMoved( index );
     if ( t != type() ) {
         changed( Type );
     }
@@ -231,10 +246,11 @@ void Node::insertChildNode( int index, Node *node ) {
 
 void Node::addChildNode( Node *node, Node *after) {
     int t = type();
-    int index = m_nodes.indexOf(after);
+    int index = after ? indexOf(after) : -1;
     if (index == -1) {
         m_nodes.append(node);
         node->setParentNode( this );
+        childNodesMoved( m_nodes.count() - 1 );
         if ( t != type() ) {
             changed( Type );
         }
@@ -242,6 +258,7 @@ void Node::addChildNode( Node *node, Node *after) {
     }
     m_nodes.insert(index+1, node);
     node->setParentNode(this);
+    childNodesMoved( index + 1 );
     if ( t != type() ) {
         changed( Type );
     }
@@ -249,7 +266,7 @@ void Node::addChildNode( Node *node, Node *after) {
 
 int Node::findChildNode( const Node* node ) const
 {
-    return m_nodes.indexOf( const_cast<Node*>( node ) );
+    return indexOf( node );
 }
 
 bool Node::isChildOf( const Node* node ) const
@@ -280,7 +297,27 @@ const Node* Node::childNode(int number) const
 
 int Node::indexOf( const Node *node ) const
 {
-    return m_nodes.indexOf( const_cast<Node*>(node) );
+    if ( node == 0 ) {
+        return -1;
+    }
+    int i = node->m_childIndex;
+    if ( i >= 0 && i < m_nodes.count() && m_nodes.at( i ) == node ) {
+        return i;
+    }
+    i = m_nodes.indexOf( const_cast<Node*>(node) );
+    if ( i != -1 ) {
+        node->m_childIndex = i;
+    }
+    return i;
+}
+
+void Node::childNodesMoved( int index )
+{
+    for ( int i = qMax( 0, index ); i < m_nodes.count(); ++i ) {
+        Node *n = m_nodes.at( i );
+        n->m_childIndex = i;
+        n->invalidateWbsCode();
+    }
 }
 
 
@@ -855,7 +892,7 @@ Node *Node::siblingBefore() {
 
 Node *Node::childBefore(Node *node) {
     //debugPlan;
-    int index = m_nodes.indexOf(node);
+    int index = indexOf(node);
     if (index > 0){
         return m_nodes.at(index-1);
     }
@@ -872,8 +909,8 @@ Node *Node::siblingAfter() {
 Node *Node::childAfter(Node *node)
 {
     //debugPlan;
-    Q_ASSERT( m_nodes.contains( node ) );
-    int index = m_nodes.indexOf(node);
+    int index = indexOf(node);
+    Q_ASSERT( index != -1 );
     if (index < m_nodes.count()-1) {
         return m_nodes.at(index+1);
     }
@@ -951,6 +988,12 @@ void Node::saveAppointments(QDomElement &element, long id) const {
     }
 }
 
+void Node::saveAppointments(KoXmlWriter &writer, long id) const {
+    foreach (const Node *n, m_nodes) {
+        n->saveAppointments(writer, id);
+    }
+}
+
 QList<Appointment*> Node::appointments( long id )
 {
     Schedule *s = schedule( id );
@@ -1068,7 +1111,15 @@ Schedule *Node::schedule( long id ) const
 
 Schedule *Node::findSchedule( long id ) const
 {
-    return m_schedules.value( id );
+    Schedule *s = m_schedules.value( id );
+    if ( s == 0 && m_parent ) {
+        // A released schedule is loaded again when it is used
+        const Node *p = projectNode();
+        if ( p->type() == Type_Project && static_cast<const Project*>( p )->restoreReleasedSchedule( id ) ) {
+            s = m_schedules.value( id );
+        }
+    }
+    return s;
 }
 
 Schedule *Node::findSchedule(const QString &name, const Schedule::Type type) {
@@ -1168,8 +1219,38 @@ QString Node::generateWBSCode( QList<int> &indexes, bool sortable ) const {
 
 QString Node::wbsCode(bool sortable) const {
     //debugPlan<<m_name;
-    QList<int> indexes;
-    return generateWBSCode( indexes, sortable );
+    const int generation = wbsCodeGeneration( sortable );
+    if ( sortable ) {
+        if ( m_sortableWbsCodeGeneration != generation ) {
+            QList<int> indexes;
+            m_sortableWbsCode = generateWBSCode( indexes, true );
+            m_sortableWbsCodeGeneration = generation;
+        }
+        return m_sortableWbsCode;
+    }
+    if ( m_wbsCodeGeneration != generation ) {
+        QList<int> indexes;
+        m_wbsCode = generateWBSCode( indexes, false );
+        m_wbsCodeGeneration = generation;
+    }
+    return m_wbsCode;
+}
+
+int Node::wbsCodeGeneration( bool sortable ) const
+{
+    return m_parent ? m_parent->wbsCodeGeneration( sortable ) : 0;
+}
+
+void Node::invalidateWbsCode()
+{
+    if ( m_wbsCodeGeneration == -1 && m_sortableWbsCodeGeneration == -1 && m_nodes.isEmpty() ) {
+        return;
+    }
+    m_wbsCodeGeneration = -1;
+    m_sortableWbsCodeGeneration = -1;
+    foreach ( Node *n, m_nodes ) {
+        n->invalidateWbsCode();
+    }
 }
 
 bool Node::isScheduled( long id ) const
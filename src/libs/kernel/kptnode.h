@@ -38,6 +38,7 @@
 #include <KoXmlReaderForward.h>
 
 class QDomElement;
+class KoXmlWriter;
 
 
 /// The main namespace.
@@ -416,6 +417,8 @@ public:
 
     /// Save appointments for schedule with id
     virtual void saveAppointments(QDomElement &element, long id) const;
+    /// Save appointments for schedule with id to @p writer
+    virtual void saveAppointments(KoXmlWriter &writer, long id) const;
     ///Return the list of appointments for schedule with id.
     QList<Appointment*> appointments( long id = CURRENTSCHEDULE );
     /// Adds appointment to this node only (not to resource)
@@ -460,8 +463,12 @@ public:
     virtual int level() const;
     /// Generate WBS Code
     virtual QString generateWBSCode( QList<int> &indexes, bool sortable = false ) const;
-    /// Returns the Work Breakdown Structure Code
+    /// Returns the Work Breakdown Structure Code.
+    /// The code is cached and only regenerated when this nodes subtree is restructured
+    /// or the projects wbs definition changes.
     QString wbsCode(bool sortable = false) const;
+    /// Invalidate the cached WBS codes of this node and all its children
+    void invalidateWbsCode();
     
     double startupCost() const { return m_startupCost; }
     void setStartupCost(double cost);
@@ -624,7 +631,12 @@ protected:
     // NOTE: Cannot use setCurrentSchedule() due to overload/casting problems
     void setCurrentSchedulePtr(Schedule *schedule) { m_currentSchedule = schedule; }
     virtual void changed(Node *node, int property = -1 );
-    
+
+    /// Returns the generation counter cached WBS codes are validated against
+    virtual int wbsCodeGeneration( bool sortable ) const;
+    /// Update the cached child index of child nodes from @p index and invalidate their WBS codes
+    void childNodesMoved( int index );
+
     QList<Node*> m_nodes;
     QList<Relation*> m_dependChildNodes;
     QList<Relation*> m_dependParentNodes;
@@ -677,6 +689,13 @@ protected:
 private:
     void init();
     bool m_blockChanged;
+
+    // Cached index into the parents list of children, used as a hint by indexOf()
+    mutable int m_childIndex;
+    mutable QString m_wbsCode;
+    mutable QString m_sortableWbsCode;
+    mutable int m_wbsCodeGeneration;
+    mutable int m_sortableWbsCodeGeneration;
 };
 
 ////////////////////////////////   Estimate   ////////////////////////////////
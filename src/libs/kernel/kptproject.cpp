@@ -35,12 +35,14 @@
 #include "kptdebug.h"
 
 #include <KoXmlReader.h>
+#include <KoXmlWriter.h>
 
 #include <krandom.h>
 #include <KFormat>
 #include <KLocalizedString>
 
 #include <QDateTime>
+#include <QDomDocument>
 #include <QLocale>
 
 namespace KPlato
@@ -54,7 +56,8 @@ Project::Project( Node *parent )
         m_schedulerPlugins(),
         m_useSharedResources(false),
         m_sharedResourcesLoaded(false),
-        m_loadProjectsAtStartup(false)
+        m_loadProjectsAtStartup(false),
+        m_batchChange(0)
 {
     //debugPlan<<"("<<this<<")";
     init();
@@ -68,7 +71,8 @@ Project::Project( ConfigBase &config, Node *parent )
         m_schedulerPlugins(),
         m_useSharedResources(false),
         m_sharedResourcesLoaded(false),
-        m_loadProjectsAtStartup(false)
+        m_loadProjectsAtStartup(false),
+        m_batchChange(0)
 {
     debugPlan<<"("<<this<<")";
     init();
@@ -83,7 +87,8 @@ Project::Project( ConfigBase &config, bool useDefaultValues, Node *parent )
         m_schedulerPlugins(),
         m_useSharedResources(false),
         m_sharedResourcesLoaded(false),
-        m_loadProjectsAtStartup(false)
+        m_loadProjectsAtStartup(false),
+        m_batchChange(0)
 {
     debugPlan<<"("<<this<<")";
     init();
@@ -95,6 +100,9 @@ Project::Project( ConfigBase &config, bool useDefaultValues, Node *parent )
 void Project::init()
 {
     m_refCount = 1; // always used by creator
+    m_releasedSchedules = 0;
+    m_wbsCodeGeneration = 0;
+    m_sortableWbsCodeGeneration = 0;
 
     m_constraint = Node::MustStartOn;
     m_standardWorktime = new StandardWorktime();
@@ -264,6 +272,7 @@ void Project::calculate( ScheduleManager &sm )
         sm.setMaxProgress( maxprogress );
         incProgress();
         if ( sm.parentManager() ) {
+            sm.parentManager()->restoreSchedule();
             sm.expected()->startTime = sm.parentManager()->expected()->startTime;
             sm.expected()->earlyStart = sm.parentManager()->expected()->earlyStart;
         }
@@ -278,6 +287,7 @@ void Project::calculate( ScheduleManager &sm )
     }
     emit sigProgress( maxprogress );
     emit sigCalculationFinished( this, &sm );
+    sm.clearEffortCube();
     emit scheduleManagerChanged( &sm );
     emit projectCalculated( &sm );
     emit projectChanged();
@@ -979,6 +989,24 @@ void Project::initiateCalculationLists( MainSchedule &sch )
     }
 }
 
+// Defer the schedules of all schedule managers that are not baselined
+static void deferSchedules( const KoXmlElement &element, XMLLoaderObject &status )
+{
+    KoXmlElement e;
+    forEachElement( e, element ) {
+        if ( e.tagName() != "plan" ) {
+            continue;
+        }
+        if ( e.attribute( "baselined" ).toInt() == 0 ) {
+            KoXmlElement se = e.namedItem( "schedule" ).toElement();
+            if ( ! se.isNull() ) {
+                status.deferSchedule( se.attribute( "id", "-1" ).toLong() );
+            }
+        }
+        deferSchedules( e, status );
+    }
+}
+
 bool Project::load( KoXmlElement &element, XMLLoaderObject &status )
 {
     //debugPlan<<"--->";
@@ -1137,6 +1165,16 @@ bool Project::load( KoXmlElement &element, XMLLoaderObject &status )
 
     status.setProgress( 20 );
 
+    if ( status.loadSchedulesOnDemand() && status.version() > "0.5" ) {
+        // Task schedules are loaded with the tasks, so decide which schedules to defer before that
+        KoXmlElement e;
+        forEachElement( e, element ) {
+            if ( e.tagName() == "schedules" ) {
+                deferSchedules( e, status );
+            }
+        }
+    }
+
     // The main stuff
     n = element.firstChild();
     for ( ; ! n.isNull(); n = n.nextSibling() ) {
@@ -1266,6 +1304,7 @@ bool Project::load( KoXmlElement &element, XMLLoaderObject &status )
             //debugPlan<<"Resource teams<---";
         } else if ( e.tagName() == "wbs-definition" ) {
             m_wbsDefinition.loadXML( e, status );
+            invalidateWbsCodes();
         } else if ( e.tagName() == "locale" ) {
             // handled earlier
         } else if ( e.tagName() == "resource-group" ) {
@@ -1291,8 +1330,163 @@ bool Project::load( KoXmlElement &element, XMLLoaderObject &status )
     return true;
 }
 
+// Write @p element and its sub-tree to @p writer
+static void writeDomElement( KoXmlWriter &writer, const QDomElement &element )
+{
+    bool hasText = false;
+    for ( QDomNode n = element.firstChild(); ! n.isNull(); n = n.nextSibling() ) {
+        if ( n.isText() ) {
+            hasText = true;
+            break;
+        }
+    }
+    // KoXmlWriter keeps the pointer to the tag name until endElement()
+    const QByteArray tag = element.tagName().toUtf8();
+    writer.startElement( tag.constData(), ! hasText );
+    const QDomNamedNodeMap attributes = element.attributes();
+    for ( int i = 0; i < attributes.count(); ++i ) {
+        const QDomAttr a = attributes.item( i ).toAttr();
+        writer.addAttribute( a.name().toUtf8().constData(), a.value() );
+    }
+    for ( QDomNode n = element.firstChild(); ! n.isNull(); n = n.nextSibling() ) {
+        if ( n.isElement() ) {
+            writeDomElement( writer, n.toElement() );
+        } else if ( n.isText() ) {
+            writer.addTextNode( n.toText().data() );
+        }
+    }
+    writer.endElement();
+}
+
+// Write the children of @p element to @p writer and remove them from @p element
+static void flushDomElement( KoXmlWriter &writer, QDomElement &element )
+{
+    while ( element.hasChildNodes() ) {
+        QDomNode n = element.firstChild();
+        if ( n.isElement() ) {
+            writeDomElement( writer, n.toElement() );
+        }
+        element.removeChild( n );
+    }
+}
+
+/**
+ * Gives access to the snapshots of the released schedules while the project is saved,
+ * so they are written without loading the schedules into the project again.
+ * Snapshots made by an older file version are restored during the save, and released again afterwards.
+ */
+class ReleasedSchedules
+{
+public:
+    explicit ReleasedSchedules( const Project *project )
+        : m_project( const_cast<Project*>( project ) )
+    {
+        foreach ( ScheduleManager *sm, m_project->allScheduleManagers() ) {
+            MainSchedule *sch = sm->expected();
+            if ( sch == 0 || ! sch->isReleased() || sch->isDeleted() ) {
+                continue;
+            }
+            QDomDocument doc;
+            if ( ! doc.setContent( qUncompress( sch->snapshot() ) ) ) {
+                errorPlan<<"Failed to read released schedule:"<<sch->name();
+                continue;
+            }
+            QDomElement e = doc.documentElement();
+            if ( e.attribute( "version", PLAN_FILE_SYNTAX_VERSION ) != PLAN_FILE_SYNTAX_VERSION ) {
+                if ( m_project->restoreSchedule( sch ) ) {
+                    m_restored << sch;
+                }
+                continue;
+            }
+            m_appointments.insert( sch->id(), QList<QDomElement>() );
+            for ( QDomElement el = e.firstChildElement(); ! el.isNull(); el = el.nextSiblingElement() ) {
+                if ( el.tagName() == "node" ) {
+                    QDomElement se = el.firstChildElement( "schedule" );
+                    if ( ! se.isNull() ) {
+                        m_nodeSchedules[ el.attribute( "id" ) ] << se;
+                    }
+                } else if ( el.tagName() == "appointment" ) {
+                    m_appointments[ sch->id() ] << el;
+                }
+            }
+        }
+        m_project->m_releasedSchedules = this;
+    }
+    ~ReleasedSchedules()
+    {
+        m_project->m_releasedSchedules = 0;
+        foreach ( MainSchedule *sch, m_restored ) {
+            m_project->releaseSchedule( sch );
+        }
+    }
+
+    /// Returns true if schedule @p id is saved from its snapshot
+    bool contains( long id ) const { return m_appointments.contains( id ); }
+
+    /// Add the released task schedules to the task elements in @p element and their sub-tasks
+    void addNodeSchedules( QDomElement &element ) const
+    {
+        if ( m_nodeSchedules.isEmpty() ) {
+            return;
+        }
+        for ( QDomElement e = element.firstChildElement( "task" ); ! e.isNull(); e = e.nextSiblingElement( "task" ) ) {
+            const QList<QDomElement> schedules = m_nodeSchedules.value( e.attribute( "id" ) );
+            if ( ! schedules.isEmpty() ) {
+                QDomElement schs = e.firstChildElement( "schedules" );
+                if ( schs.isNull() ) {
+                    schs = e.ownerDocument().createElement( "schedules" );
+                    e.appendChild( schs );
+                }
+                foreach ( const QDomElement &se, schedules ) {
+                    schs.appendChild( e.ownerDocument().importNode( se, true ) );
+                }
+            }
+            addNodeSchedules( e );
+        }
+    }
+    void saveAppointments( QDomElement &element, long id ) const
+    {
+        foreach ( const QDomElement &e, m_appointments.value( id ) ) {
+            element.appendChild( element.ownerDocument().importNode( e, true ) );
+        }
+    }
+    void saveAppointments( KoXmlWriter &writer, long id ) const
+    {
+        foreach ( const QDomElement &e, m_appointments.value( id ) ) {
+            writeDomElement( writer, e );
+        }
+    }
+
+private:
+    Project *m_project;
+    QList<MainSchedule*> m_restored;
+    // The elements keep their snapshot document alive
+    QHash<QString, QList<QDomElement> > m_nodeSchedules;
+    QHash<long, QList<QDomElement> > m_appointments;
+};
+
+void Project::saveAppointments( QDomElement &element, long id ) const
+{
+    if ( m_releasedSchedules && m_releasedSchedules->contains( id ) ) {
+        m_releasedSchedules->saveAppointments( element, id );
+        return;
+    }
+    Node::saveAppointments( element, id );
+}
+
+void Project::saveAppointments( KoXmlWriter &writer, long id ) const
+{
+    if ( m_releasedSchedules && m_releasedSchedules->contains( id ) ) {
+        m_releasedSchedules->saveAppointments( writer, id );
+        return;
+    }
+    Node::saveAppointments( writer, id );
+}
+
 void Project::save( QDomElement &element ) const
 {
+    ReleasedSchedules released( this );
+
     QDomElement me = element.ownerDocument().createElement( "project" );
     element.appendChild( me );
 
@@ -1350,6 +1544,7 @@ void Project::save( QDomElement &element ) const
     for ( int i = 0; i < numChildren(); i++ )
         // Save all children
         childNode( i ) ->save( me );
+    released.addNodeSchedules( me );
 
     // Now we can save relations assuming no tasks have relations outside the project
     QListIterator<Node*> nodes( m_nodes );
@@ -1380,8 +1575,114 @@ void Project::save( QDomElement &element ) const
     }
 }
 
+void Project::save( KoXmlWriter &writer ) const
+{
+    ReleasedSchedules released( this );
+
+    writer.startElement( "project" );
+
+    writer.addAttribute( "name", m_name );
+    writer.addAttribute( "leader", m_leader );
+    writer.addAttribute( "id", m_id );
+    writer.addAttribute( "description", m_description );
+    writer.addAttribute( "timezone", m_timeZone.isValid() ? QString::fromLatin1(m_timeZone.id()) : QString() );
+
+    writer.addAttribute( "scheduling", constraintToString() );
+    writer.addAttribute( "start-time", m_constraintStartTime.toString( Qt::ISODate ) );
+    writer.addAttribute( "end-time", m_constraintEndTime.toString( Qt::ISODate ) );
+
+    // Elements that only have a QDomElement api are saved to a small scratch document
+    // and streamed to the writer section by section, so the complete project tree
+    // never exists as a dom at the same time.
+    QDomDocument doc( "project" );
+    QDomElement me = doc.createElement( "project" );
+    doc.appendChild( me );
+
+    m_wbsDefinition.saveXML( me );
+
+    QDomElement loc = me.ownerDocument().createElement( "locale" );
+    me.appendChild( loc );
+    const Locale *l = locale();
+    if (!l->currencySymbolExplicit().isEmpty()) {
+        loc.setAttribute("currency-symbol", l->currencySymbolExplicit());
+    }
+    loc.setAttribute("currency-digits", l->monetaryDecimalPlaces());
+    loc.setAttribute("language", l->currencyLanguage());
+    loc.setAttribute("country", l->currencyCountry());
+
+    QDomElement share = me.ownerDocument().createElement( "shared-resources" );
+    me.appendChild(share);
+    share.setAttribute("use", m_useSharedResources);
+    share.setAttribute("file", m_sharedResourcesFile);
+    share.setAttribute("projects-url", QString(m_sharedProjectsUrl.toEncoded()));
+    share.setAttribute("projects-loadatstartup", m_loadProjectsAtStartup);
+
+    m_accounts.save( me );
+    flushDomElement( writer, me );
+
+    // save calendars
+    foreach ( Calendar *c, calendarIdDict ) {
+        c->save( me );
+    }
+    // save standard worktime
+    if ( m_standardWorktime )
+        m_standardWorktime->save( me );
+    flushDomElement( writer, me );
+
+    // save project resources, must be after calendars
+    foreach ( ResourceGroup *g, m_resourceGroups ) {
+        g->save( me );
+    }
+    // Only save parent relations
+    foreach ( Relation *r, m_dependParentNodes ) {
+        r->save( me );
+    }
+    flushDomElement( writer, me );
+
+    for ( int i = 0; i < numChildren(); i++ ) {
+        // Save all children
+        childNode( i ) ->save( me );
+        released.addNodeSchedules( me );
+        flushDomElement( writer, me );
+    }
+
+    // Now we can save relations assuming no tasks have relations outside the project
+    foreach ( Node *n, m_nodes ) {
+        n->saveRelations( me );
+    }
+    flushDomElement( writer, me );
+
+    if ( !m_managers.isEmpty() ) {
+        writer.startElement( "schedules" );
+        foreach ( ScheduleManager *sm, m_managers ) {
+            sm->saveXML( writer );
+        }
+        writer.endElement();
+    }
+    // save resource teams
+    writer.startElement( "resource-teams" );
+    foreach ( Resource *r, resourceIdDict ) {
+        if ( r->type() != Resource::Type_Team ) {
+            continue;
+        }
+        foreach ( const QString &id, r->teamMemberIds() ) {
+            writer.startElement( "team" );
+            writer.addAttribute( "team-id", r->id() );
+            writer.addAttribute( "member-id", id );
+            writer.endElement();
+        }
+    }
+    writer.endElement();
+
+    writer.endElement();
+}
+
 void Project::saveWorkPackageXML( QDomElement &element, const Node *node, long id ) const
 {
+    MainSchedule *sch = static_cast<MainSchedule*>( findSchedule( id ) );
+    if ( sch && sch->isReleased() ) {
+        const_cast<Project*>( this )->restoreSchedule( sch );
+    }
     QDomElement me = element.ownerDocument().createElement( "project" );
     element.appendChild( me );
 
@@ -1423,6 +1724,155 @@ void Project::setParentSchedule( Schedule *sch )
     }
 }
 
+bool Project::releaseSchedule( MainSchedule *sch )
+{
+    if ( sch == 0 || sch->isReleased() || sch == m_currentSchedule ) {
+        return false;
+    }
+    long id = sch->id();
+    QDomDocument doc( "snapshot" );
+    QDomElement e = doc.createElement( "snapshot" );
+    e.setAttribute( "version", PLAN_FILE_SYNTAX_VERSION );
+    doc.appendChild( e );
+    const QList<Node*> nodes = allNodes();
+    foreach ( Node *n, nodes ) {
+        Schedule *s = n->findSchedule( id );
+        if ( s ) {
+            QDomElement ne = doc.createElement( "node" );
+            ne.setAttribute( "id", n->id() );
+            e.appendChild( ne );
+            static_cast<NodeSchedule*>( s )->saveXML( ne );
+        }
+    }
+    const QList<Resource*> resources = resourceList();
+    foreach ( const Resource *r, resources ) {
+        if ( r->findSchedule( id ) ) {
+            QDomElement re = doc.createElement( "resource" );
+            re.setAttribute( "id", r->id() );
+            e.appendChild( re );
+        }
+    }
+    saveAppointments( e, id );
+
+    // Deleting the node schedules also deletes their appointments
+    foreach ( Node *n, nodes ) {
+        Schedule *s = n->findSchedule( id );
+        if ( s ) {
+            n->takeSchedule( s );
+            delete s;
+        }
+    }
+    foreach ( Resource *r, resources ) {
+        Schedule *s = r->findSchedule( id );
+        if ( s ) {
+            r->deleteSchedule( s );
+        }
+    }
+    sch->setSnapshot( qCompress( doc.toByteArray( -1 ) ) );
+    return true;
+}
+
+void Project::clearEffortCubes()
+{
+    foreach ( ScheduleManager *sm, allScheduleManagers() ) {
+        sm->clearEffortCube();
+    }
+}
+
+bool Project::restoreReleasedSchedule( long id ) const
+{
+    if ( m_releasedSchedules ) {
+        return false;
+    }
+    MainSchedule *sch = static_cast<MainSchedule*>( m_schedules.value( id ) );
+    if ( sch == 0 || ! sch->isReleased() || sch->isDeleted() ) {
+        return false;
+    }
+    return const_cast<Project*>( this )->restoreSchedule( sch );
+}
+
+bool Project::restoreSchedule( MainSchedule *sch )
+{
+    if ( sch == 0 || ! sch->isReleased() ) {
+        return false;
+    }
+    KoXmlDocument doc;
+    if ( ! doc.setContent( qUncompress( sch->snapshot() ) ) ) {
+        errorPlan<<"Failed to restore schedule:"<<sch->name();
+        return false;
+    }
+    sch->setSnapshot( QByteArray() );
+
+    KoXmlElement e = doc.documentElement();
+    XMLLoaderObject status;
+    status.setVersion( e.attribute( "version", PLAN_FILE_SYNTAX_VERSION ) );
+    status.setProject( this );
+    status.setProjectTimeZone( timeZone() );
+
+    KoXmlElement el;
+    // Node and resource schedules must exist before the appointments are loaded
+    forEachElement( el, e ) {
+        if ( el.tagName() == "node" ) {
+            Node *n = findNode( el.attribute( "id" ) );
+            KoXmlElement se = el.namedItem( "schedule" ).toElement();
+            if ( n == 0 || se.isNull() ) {
+                warnPlan<<"Failed to restore node schedule:"<<el.attribute( "id" );
+                continue;
+            }
+            NodeSchedule *ns = new NodeSchedule();
+            ns->loadXML( se, status );
+            ns->setNode( n );
+            n->addSchedule( ns );
+        } else if ( el.tagName() == "resource" ) {
+            Resource *r = resource( el.attribute( "id" ) );
+            if ( r ) {
+                r->createSchedule( sch );
+            }
+        }
+    }
+    setParentSchedule( sch );
+    forEachElement( el, e ) {
+        if ( el.tagName() == "appointment" ) {
+            Appointment *a = new Appointment();
+            if ( ! a->loadXML( el, status, *sch ) ) {
+                errorPlan<<"Failed to restore appointment";
+                delete a;
+            }
+        }
+    }
+    return true;
+}
+
+qint64 Project::scheduleMemoryUsage( const MainSchedule *sch ) const
+{
+    if ( sch == 0 ) {
+        return 0;
+    }
+    if ( sch->isReleased() ) {
+        return sch->snapshot().size();
+    }
+    // An interval is stored in a map node with a shared private holding start, end and load
+    const qint64 intervalSize = sizeof( QDate ) + sizeof( AppointmentInterval ) + 2 * sizeof( DateTime ) + sizeof( double ) + 4 * sizeof( void* );
+    long id = sch->id();
+    qint64 size = 0;
+    foreach ( const Node *n, nodeIdDict ) {
+        const Schedule *s = n->findSchedule( id );
+        if ( s == 0 || s == sch ) {
+            continue;
+        }
+        size += sizeof( NodeSchedule );
+        foreach ( const Appointment *a, s->appointments() ) {
+            size += sizeof( Appointment ) + a->intervals().map().count() * intervalSize;
+        }
+    }
+    foreach ( const Resource *r, resourceIdDict ) {
+        if ( r->findSchedule( id ) ) {
+            size += sizeof( ResourceSchedule );
+        }
+    }
+    return size;
+}
+
 void Project::addResourceGroup( ResourceGroup *group, int index )
 {
     int i = index == -1 ? m_resourceGroups.count() : index;
@@ -1470,6 +1920,7 @@ void Project::addResource( ResourceGroup *group, Resource *resource, int index )
     emit resourceToBeAdded( group, i );
     group->addResource( i, resource, 0 );
     setResourceId( resource );
+    clearEffortCubes();
     emit resourceAdded( resource );
     emit projectChanged();
 }
@@ -1488,6 +1939,7 @@ Resource *Project::takeResource( ResourceGroup *group, Resource *resource )
     if (resource != r) {
         warnPlan << "Could not take resource from group";
     }
+    clearEffortCubes();
     emit resourceRemoved( resource );
     emit projectChanged();
     return r;
@@ -1853,7 +2305,12 @@ bool Project::removeId( const QString &id )
         return m_parent->removeId( id );
     }
     //debugPlan << "id=" << id<< nodeIdDict.contains(id);
-    return nodeIdDict.remove( id );
+    const int fw = sortableWbsCodeFieldWidth();
+    const bool res = nodeIdDict.remove( id );
+    if ( fw != sortableWbsCodeFieldWidth() ) {
+        invalidateWbsCodes( true );
+    }
+    return res;
 }
 
 void Project::reserveId( const QString &id, Node *node )
@@ -1872,7 +2329,11 @@ bool Project::registerNodeId( Node *node )
     Node *rn = findNode( node->id() );
     if ( rn == 0 ) {
         //debugPlan <<"id=" << node->id() << node->name();
+        const int fw = sortableWbsCodeFieldWidth();
         nodeIdDict.insert( node->id(), node );
+        if ( fw != sortableWbsCodeFieldWidth() ) {
+            invalidateWbsCodes( true );
+        }
         return true;
     }
     if ( rn != node ) {
@@ -2478,7 +2939,7 @@ bool Project::legalChildren( const Node *par, const Node *child ) const
     return legal;
 }
 
-WBSDefinition &Project::wbsDefinition()
+const WBSDefinition &Project::wbsDefinition() const
 {
     return m_wbsDefinition;
 }
@@ -2487,6 +2948,7 @@ void Project::setWbsDefinition( const WBSDefinition &def )
 {
     //debugPlan;
     m_wbsDefinition = def;
+    invalidateWbsCodes();
     emit wbsDefinitionChanged();
     emit projectChanged();
 }
@@ -2495,7 +2957,7 @@ QString Project::generateWBSCode( QList<int> &indexes, bool sortable ) const
 {
     QString code = m_wbsDefinition.projectCode();
     if (sortable) {
-        int fw = (nodeIdDict.count() / 10) + 1;
+        int fw = sortableWbsCodeFieldWidth();
         QLatin1Char fc('0');
         foreach ( int index, indexes ) {
             code += ".%1";
@@ -2520,10 +2982,33 @@ QString Project::generateWBSCode( QList<int> &indexes, bool sortable ) const
     return code;
 }
 
+int Project::sortableWbsCodeFieldWidth() const
+{
+    return ( nodeIdDict.count() / 10 ) + 1;
+}
+
+int Project::wbsCodeGeneration( bool sortable ) const
+{
+    return sortable ? m_sortableWbsCodeGeneration : m_wbsCodeGeneration;
+}
+
+void Project::invalidateWbsCodes( bool sortableOnly )
+{
+    // Node caches are compared against the generation, so bumping it is enough
+    if ( ! sortableOnly ) {
+        ++m_wbsCodeGeneration;
+    }
+    ++m_sortableWbsCodeGeneration;
+}
+
 void Project::setCurrentSchedule( long id )
 {
     //debugPlan;
-    setCurrentSchedulePtr( findSchedule( id ) );
+    MainSchedule *sch = static_cast<MainSchedule*>( findSchedule( id ) );
+    if ( sch && sch->isReleased() ) {
+        restoreSchedule( sch );
+    }
+    setCurrentSchedulePtr( sch );
     Node::setCurrentSchedule( id );
     QHash<QString, Resource*> hash = resourceIdDict;
     foreach ( Resource * r, hash ) {
@@ -2751,6 +3236,10 @@ void Project::changed( Node *node, int property )
         Node::changed( node, property ); // reset cache
         if ( property != Node::Type ) {
             // add/remove node is handled elsewhere
+            if ( m_batchChange > 0 ) {
+                m_batchChangedNodes.insert( node );
+                return;
+            }
             emit nodeChanged( node );
             emit projectChanged();
         }
@@ -2759,6 +3248,31 @@ void Project::changed( Node *node, int property )
     Node::changed( node, property );
 }
 
+void Project::beginBatchChange()
+{
+    ++m_batchChange;
+}
+
+void Project::endBatchChange()
+{
+    Q_ASSERT( m_batchChange > 0 );
+    if ( --m_batchChange > 0 || m_batchChangedNodes.isEmpty() ) {
+        return;
+    }
+    // Nodes may have been removed during the batch, so only emit for nodes still in the project
+    QSet<Node*> nodes;
+    nodes.swap( m_batchChangedNodes );
+    if ( nodes.contains( this ) ) {
+        emit nodeChanged( this );
+    }
+    foreach ( Node *n, allNodes() ) {
+        if ( nodes.contains( n ) ) {
+            emit nodeChanged( n );
+        }
+    }
+    emit projectChanged();
+}
+
 void Project::changed( ResourceGroup *group )
 {
     //debugPlan;
@@ -2768,6 +3282,9 @@ void Project::changed( ResourceGroup *group )
 
 void Project::changed( ScheduleManager *sm )
 {
+    if ( sm ) {
+        sm->clearEffortCube();
+    }
     emit scheduleManagerChanged( sm );
     emit projectChanged();
 }
@@ -2775,6 +3292,9 @@ void Project::changed( ScheduleManager *sm )
 void Project::changed( MainSchedule *sch )
 {
     //debugPlan<<sch->id();
+    if ( sch->manager() ) {
+        sch->manager()->clearEffortCube();
+    }
     emit scheduleChanged( sch );
     emit projectChanged();
 }
@@ -2806,6 +3326,7 @@ void Project::sendScheduleRemoved( const MainSchedule *sch )
 
 void Project::changed( Resource *resource )
 {
+    clearEffortCubes();
     emit resourceChanged( resource );
     emit projectChanged();
 }
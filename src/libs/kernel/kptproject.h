@@ -39,6 +39,7 @@
 #include <QMap>
 #include <QList>
 #include <QHash>
+#include <QSet>
 #include <QPointer>
 #include <QTimeZone>
 
@@ -55,6 +56,7 @@ class XMLLoaderObject;
 class Task;
 class SchedulerPlugin;
 class KPlatoXmlLoaderBase;
+class ReleasedSchedules;
 
 /**
  * Project is the main node in a project, it contains child nodes and
@@ -120,6 +122,15 @@ public:
 
     virtual bool load( KoXmlElement &element, XMLLoaderObject &status );
     virtual void save( QDomElement &element ) const;
+    /**
+     * Save the project to @p writer in one streaming pass.
+     * The schedules and appointments, which is most of the data, are written
+     * directly to @p writer, the rest is saved via small temporary documents.
+     */
+    void save( KoXmlWriter &writer ) const;
+    /// Save the appointments of schedule @p id, a released schedule is saved from its snapshot while the project is saved
+    virtual void saveAppointments( QDomElement &element, long id ) const;
+    virtual void saveAppointments( KoXmlWriter &writer, long id ) const;
 
     using Node::saveWorkPackageXML;
     /// Save a workpackage document containing @p node with schedule identity @p id
@@ -373,8 +384,9 @@ public:
     bool setCalendarId( Calendar *calendar );
     /// returns a unique calendar id
     QString uniqueCalendarId() const;
-    /// Return reference to WBS Definition
-    WBSDefinition &wbsDefinition();
+    /// Return reference to WBS Definition.
+    /// Use setWbsDefinition() to modify it, so that cached WBS codes are invalidated.
+    const WBSDefinition &wbsDefinition() const;
     /// Set WBS Definition to @p def
     void setWbsDefinition( const WBSDefinition &def );
     /// Generate WBS Code
@@ -397,6 +409,30 @@ public:
     /// Set parent schedule for my children
     virtual void setParentSchedule( Schedule *sch );
 
+    /**
+     * Move the task and resource schedules of @p sch into a compressed snapshot
+     * and remove them from the project.
+     * The main schedule itself is kept, so its id stays reserved and pointers to it stay valid.
+     * Returns false if @p sch is the current schedule or already released.
+     */
+    bool releaseSchedule( MainSchedule *sch );
+    /**
+     * Recreate the task and resource schedules of @p sch from its snapshot.
+     * The snapshot is made by releaseSchedule(), or when loading with XMLLoaderObject::loadSchedulesOnDemand().
+     */
+    bool restoreSchedule( MainSchedule *sch );
+    /**
+     * Restore the released schedule with @p id unless it is deleted.
+     * Task and resource schedules use this to load a released schedule when it is looked up.
+     * Released schedules are not restored while the project is saved.
+     * Returns true if the schedule was restored.
+     */
+    bool restoreReleasedSchedule( long id ) const;
+    /// Returns the approximate number of bytes used by the task and resource schedules of @p sch
+    qint64 scheduleMemoryUsage( const MainSchedule *sch ) const;
+    /// Clear the effort cubes of all schedule managers, see ScheduleManager::effortCube()
+    void clearEffortCubes();
+
     /// Find the schedule manager that manages the Schedule with @p id
     ScheduleManager *scheduleManager( long id ) const;
     /// Find the schedule manager with @p id
@@ -511,6 +547,18 @@ public:
     void emitDocumentRemoved( Node*, Document*, int index );
     void emitDocumentChanged( Node*, Document*, int index );
 
+    /**
+     * Start a batch of node changes.
+     * Until the matching endBatchChange(), nodeChanged() and projectChanged() are not emitted
+     * when nodes change, instead the changed nodes are collected.
+     * Batches may be nested.
+     */
+    void beginBatchChange();
+    /// End a batch of node changes and emit nodeChanged() once for each node changed in the batch
+    void endBatchChange();
+    /// Returns true if a batch of node changes is in progress
+    bool isBatchChange() const { return m_batchChange > 0; }
+
     bool useSharedResources() const;
     void setUseSharedResources(bool on);
     bool isSharedResourcesLoaded() const;
@@ -652,9 +700,16 @@ protected:
 
 protected:
     friend class KPlatoXmlLoaderBase;
+    friend class ReleasedSchedules;
     using Node::changed;
     virtual void changed(Node *node, int property = -1);
 
+    virtual int wbsCodeGeneration( bool sortable ) const;
+    /// Field width used for sortable WBS codes
+    int sortableWbsCodeFieldWidth() const;
+    /// Invalidate all cached WBS codes
+    void invalidateWbsCodes( bool sortableOnly = false );
+
     Accounts m_accounts;
     QList<ResourceGroup*> m_resourceGroups;
 
@@ -692,6 +747,8 @@ private:
     QTimeZone m_timeZone;
 
     WBSDefinition m_wbsDefinition;
+    int m_wbsCodeGeneration;
+    int m_sortableWbsCodeGeneration;
 
     ConfigBase emptyConfig;
     QPointer<ConfigBase> m_config; // this one is not owned by me, don't delete
@@ -711,6 +768,12 @@ private:
     QString m_sharedResourcesFile;
     QUrl m_sharedProjectsUrl;
     bool m_loadProjectsAtStartup;
+
+    int m_batchChange;
+    QSet<Node*> m_batchChangedNodes;
+
+    /// The snapshots of the released schedules while the project is saved
+    const ReleasedSchedules *m_releasedSchedules;
 };
 
 
@@ -39,6 +39,7 @@
 #include <KLocalizedString>
 
 #include <QLocale>
+#include <QtMath>
 
 
 namespace KPlato
@@ -776,6 +777,10 @@ Schedule *Resource::findSchedule( long id ) const
     if ( m_schedules.contains( id ) ) {
         return m_schedules[ id ];
     }
+    // A released schedule is loaded again when it is used
+    if ( m_project && m_project->restoreReleasedSchedule( id ) && m_schedules.contains( id ) ) {
+        return m_schedules[ id ];
+    }
     if ( id == CURRENTSCHEDULE ) {
         return m_currentSchedule;
     }
@@ -2480,26 +2485,165 @@ int ResourceRequestCollection::numDays(const QList<ResourceRequest*> &lst, const
     return time.daysTo(t2);
 }
 
-Duration ResourceRequestCollection::duration(const QList<ResourceRequest*> &lst, const DateTime &time, const Duration &_effort, Schedule *ns, bool backward) {
-    //debugPlan<<"--->"<<(backward?"(B)":"(F)")<<time.toString()<<": effort:"<<_effort.toString(Duration::Format_Day)<<" ("<<_effort.milliseconds()<<")";
-#if 0
-    if ( ns ) {
-        QStringList nl;
-        foreach ( ResourceRequest *r, lst ) { nl << r->resource()->name(); }
-        ns->logDebug( "Match effort:" + time.toString() + "," + _effort.toString() );
-        ns->logDebug( "Resources: " + ( nl.isEmpty() ? QString( "None" ) : nl.join( ", " ) ) );
+// Sorted breakpoints with the rate (in percent) that applies from the breakpoint until the next one
+typedef QMap<DateTime, double> CapacityProfile;
+
+static CapacityProfile capacityProfile( const AppointmentIntervalList &lst, const DateTime &from, const DateTime &until, double factor )
+{
+    CapacityProfile deltas;
+    foreach ( const AppointmentInterval &i, lst.map() ) {
+        DateTime st = i.startTime() > from ? i.startTime() : from;
+        DateTime et = i.endTime() < until ? i.endTime() : until;
+        if ( st >= et || i.load() <= 0.0 ) {
+            continue;
+        }
+        deltas[ st ] += i.load() * factor;
+        deltas[ et ] -= i.load() * factor;
     }
-#endif
-    QLocale locale;
-    Duration e;
-    if (_effort == Duration::zeroDuration) {
-        return e;
+    CapacityProfile profile;
+    double rate = 0.0;
+    for ( CapacityProfile::const_iterator it = deltas.constBegin(); it != deltas.constEnd(); ++it ) {
+        rate += it.value();
+        if ( rate < 1e-9 ) {
+            rate = 0.0; // avoid rounding errors
+        }
+        profile.insert( it.key(), rate );
+    }
+    return profile;
+}
+
+static double rateAt( const CapacityProfile &profile, const DateTime &time )
+{
+    CapacityProfile::const_iterator it = profile.upperBound( time );
+    if ( it == profile.constBegin() ) {
+        return 0.0;
+    }
+    return ( --it ).value();
+}
+
+// Returns the sum of, or if @p minimum is true, the lowest rate of @p p1 and @p p2 at each breakpoint
+static CapacityProfile combineProfiles( const CapacityProfile &p1, const CapacityProfile &p2, bool minimum )
+{
+    if ( ! minimum && p1.isEmpty() ) {
+        return p2;
     }
+    CapacityProfile result;
+    CapacityProfile points = p1;
+    for ( CapacityProfile::const_iterator it = p2.constBegin(); it != p2.constEnd(); ++it ) {
+        points.insert( it.key(), it.value() );
+    }
+    for ( CapacityProfile::const_iterator it = points.constBegin(); it != points.constEnd(); ++it ) {
+        double r1 = rateAt( p1, it.key() );
+        double r2 = rateAt( p2, it.key() );
+        result.insert( it.key(), minimum ? qMin( r1, r2 ) : r1 + r2 );
+    }
+    return result;
+}
+
+// Walk @p profile from its start (or from its end if @p backward) adding effort to @p e.
+// Returns true and sets @p end to the exact time when @p effort is reached.
+static bool walkProfile( const CapacityProfile &profile, const Duration &effort, bool backward, Duration &e, DateTime &end )
+{
+    if ( profile.count() < 2 ) {
+        return false;
+    }
+    CapacityProfile::const_iterator first = profile.constBegin();
+    CapacityProfile::const_iterator last = profile.constEnd() - 1;
+    for ( CapacityProfile::const_iterator it = backward ? last : first; it != ( backward ? first : last ); backward ? --it : ++it ) {
+        CapacityProfile::const_iterator seg = backward ? it - 1 : it; // the segment starts at seg
+        CapacityProfile::const_iterator next = seg + 1;
+        double rate = seg.value();
+        if ( rate <= 0.0 ) {
+            continue;
+        }
+        Duration available = ( next.key() - seg.key() ) * rate / 100;
+        if ( e + available < effort ) {
+            e += available;
+            continue;
+        }
+        Duration needed( (qint64)qCeil( ( effort - e ).milliseconds() * 100.0 / rate ) );
+        end = backward ? next.key() - needed : seg.key() + needed;
+        e = effort;
+        return true;
+    }
+    return false;
+}
+
+bool ResourceRequestCollection::matchEffort( const QList<ResourceRequest*> &lst, const DateTime &time, const Duration &effort, Schedule *ns, bool backward, DateTime &end, Duration &e )
+{
+    // Limit search to the time the resources are available
+    DateTime limit = time;
+    foreach ( ResourceRequest *r, lst ) {
+        DateTime t = backward ? r->availableFrom() : r->availableUntil();
+        if ( backward ? t < limit : t > limit ) {
+            limit = t;
+        }
+    }
+    end = time;
+    // Build the combined capacity profile of all resources in windows of increasing size,
+    // and walk each window until the effort is matched
+    Duration window = qMax( Duration( 7, 0, 0 ), effort * 5 );
+    DateTime cursor = time;
+    while ( backward ? cursor > limit : cursor < limit ) {
+        DateTime next = backward ? cursor - window : cursor + window;
+        if ( backward ? next < limit : next > limit ) {
+            next = limit;
+        }
+        const DateTime from = backward ? next : cursor;
+        const DateTime until = backward ? cursor : next;
+        CapacityProfile profile;
+        foreach ( ResourceRequest *r, lst ) {
+            Resource *res = r->resource();
+            if ( res->type() == Resource::Type_Team || res->units() == 0 || r->units() == 0 ) {
+                continue;
+            }
+            if ( res->calendar() == 0 ) {
+                if ( ns ) ns->logWarning( i18n( "Resource %1 has no calendar defined", res->name() ) );
+                continue;
+            }
+            r->setCurrentSchedulePtr( ns );
+            Schedule *sch = res->currentSchedule();
+            DateTime af = r->availableFrom();
+            DateTime au = r->availableUntil();
+            DateTime st = af > from ? af : from;
+            DateTime et = au < until ? au : until;
+            if ( st >= et ) {
+                continue;
+            }
+            const AppointmentIntervalList work = res->workIntervals( st, et );
+            CapacityProfile p = capacityProfile( work, st, et, r->units() / 100.0 );
+            if ( sch && ( ! sch->allowOverbooking() || sch->allowOverbookingState() == Schedule::OBS_Deny ) ) {
+                const AppointmentIntervalList free = res->workIntervals( st, et, sch );
+                if ( r->units() < 100 && free.effort( st, et ) < work.effort( st, et ) ) {
+                    // Resource::effort() takes the lowest of the requested and the free effort
+                    // over each step, not at each point in time. With bookings in the window
+                    // the two differ, so use the stepping search to keep the scheduled durations.
+                    e = Duration::zeroDuration;
+                    return matchEffortStepwise( lst, time, effort, ns, backward, end, e );
+                }
+                // The free capacity never exceeds the requested capacity, or there are no bookings,
+                // so the lowest rate at each point gives the same effort as the lowest total
+                p = combineProfiles( p, capacityProfile( free, st, et, 1.0 ), true );
+            }
+            profile = combineProfiles( profile, p, false );
+        }
+        if ( walkProfile( profile, effort, backward, e, end ) ) {
+            return true;
+        }
+        cursor = next;
+        end = cursor;
+        window = window * 2;
+    }
+    return false;
+}
+
+bool ResourceRequestCollection::matchEffortStepwise( const QList<ResourceRequest*> &lst, const DateTime &time, const Duration &_effort, Schedule *ns, bool backward, DateTime &end, Duration &e )
+{
     DateTime logtime = time;
     bool match = false;
     DateTime start = time;
     int inc = backward ? -1 : 1;
-    DateTime end = start;
+    end = start;
     Duration e1;
     int nDays = numDays(lst, time, backward) + 1;
     int day = 0;
@@ -2622,6 +2766,29 @@ Duration ResourceRequestCollection::duration(const QList<ResourceRequest*> &lst,
             //debugPlan<<"duration(ms)["<<i<<"]"<<(backward?"backward":"forward:")<<" time="<<start.time().toString()<<" e="<<e.toString()<<" ("<<e.milliseconds()<<")";
         }
     }
+    return match;
+}
+
+Duration ResourceRequestCollection::duration(const QList<ResourceRequest*> &lst, const DateTime &time, const Duration &_effort, Schedule *ns, bool backward) {
+    //debugPlan<<"--->"<<(backward?"(B)":"(F)")<<time.toString()<<": effort:"<<_effort.toString(Duration::Format_Day)<<" ("<<_effort.milliseconds()<<")";
+    QLocale locale;
+    Duration e;
+    if (_effort == Duration::zeroDuration) {
+        return e;
+    }
+    DateTime end;
+    bool required = false;
+    foreach ( ResourceRequest *r, lst ) {
+        if ( ! r->requiredResources().isEmpty() ) {
+            required = true;
+            break;
+        }
+    }
+    // Required resources only limit the interval a resource can work in,
+    // so they cannot be merged into the capacity profile
+    bool match = required
+            ? matchEffortStepwise( lst, time, _effort, ns, backward, end, e )
+            : matchEffort( lst, time, _effort, ns, backward, end, e );
     if (!match && ns) {
         ns->logError( i18n( "Could not match effort. Want: %1 got: %2", _effort.toString( Duration::Format_Hour ), e.toString( Duration::Format_Hour ) ) );
         foreach (ResourceRequest *r, lst) {
@@ -894,6 +894,22 @@ public:
     int numDays(const QList<ResourceRequest*> &lst, const DateTime &time, bool backward) const;
     Duration duration(const QList<ResourceRequest*> &lst, const DateTime &time, const Duration &_effort, Schedule *ns, bool backward);
 
+protected:
+    /**
+     * Find the time when @p effort is done by the resources in @p lst starting at @p time.
+     * The availability of all resources is merged into one capacity profile,
+     * so the exact time is found by walking the profile once.
+     * Returns true if the effort could be matched, and sets @p end to the time the effort is done.
+     * @p e is set to the effort that could be done.
+     */
+    bool matchEffort( const QList<ResourceRequest*> &lst, const DateTime &time, const Duration &effort, Schedule *ns, bool backward, DateTime &end, Duration &e );
+    /**
+     * Same as matchEffort(), but steps days, hours, minutes, seconds and milliseconds.
+     * Used when resources require other resources, and when a request for less than 100%
+     * of a resource meets existing bookings.
+     */
+    bool matchEffortStepwise( const QList<ResourceRequest*> &lst, const DateTime &time, const Duration &effort, Schedule *ns, bool backward, DateTime &end, Duration &e );
+
 private:
     Task *m_task;
     QList<ResourceGroupRequest*> m_requests;
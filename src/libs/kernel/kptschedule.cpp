@@ -32,6 +32,7 @@
 #include "kptdebug.h"
 
 #include <KoXmlReader.h>
+#include <KoXmlWriter.h>
 
 #include <KLocalizedString>
 
@@ -329,6 +330,13 @@ void Schedule::saveCommonXML( QDomElement &element ) const
     element.setAttribute( "id", QString::number(qlonglong( m_id )) );
 }
 
+void Schedule::saveCommonXML( KoXmlWriter &writer ) const
+{
+    writer.addAttribute( "name", m_name );
+    writer.addAttribute( "type", typeToString() );
+    writer.addAttribute( "id", QString::number(qlonglong( m_id )) );
+}
+
 void Schedule::saveAppointments( QDomElement &element ) const
 {
     //debugPlan;
@@ -338,6 +346,13 @@ void Schedule::saveAppointments( QDomElement &element ) const
     }
 }
 
+void Schedule::saveAppointments( KoXmlWriter &writer ) const
+{
+    foreach ( const Appointment *a, m_appointments ) {
+        a->saveXML( writer );
+    }
+}
+
 void Schedule::insertForwardNode( Node *node )
 {
     if ( m_parent ) {
@@ -1300,6 +1315,10 @@ bool MainSchedule::loadXML( const KoXmlElement &sch, XMLLoaderObject &status )
         }
         KoXmlElement el = n.toElement();
         if ( el.tagName() == "appointment" ) {
+            if ( status.isDeferred( m_id ) ) {
+                status.addDeferredElement( m_id, el );
+                continue;
+            }
             // Load the appointments.
             // Resources and tasks must already be loaded
             Appointment * child = new Appointment();
@@ -1372,6 +1391,35 @@ void MainSchedule::saveXML( QDomElement &element ) const
     }
 }
 
+void MainSchedule::saveXML( KoXmlWriter &writer ) const
+{
+    saveCommonXML( writer );
+
+    writer.addAttribute( "start", startTime.toString( Qt::ISODate ) );
+    writer.addAttribute( "end", endTime.toString( Qt::ISODate ) );
+    writer.addAttribute( "duration", duration.toString() );
+    writer.addAttribute( "scheduling-conflict", QString::number(constraintError) );
+    writer.addAttribute( "scheduling-error", QString::number(schedulingError) );
+    writer.addAttribute( "not-scheduled", QString::number(notScheduled) );
+
+    if ( ! m_pathlists.isEmpty() ) {
+        writer.startElement( "criticalpath-list" );
+        foreach ( const QList<Node*> &l, m_pathlists ) {
+            if ( l.isEmpty() ) {
+                continue;
+            }
+            writer.startElement( "criticalpath" );
+            foreach ( Node *n, l ) {
+                writer.startElement( "node" );
+                writer.addAttribute( "id", n->id() );
+                writer.endElement();
+            }
+            writer.endElement();
+        }
+        writer.endElement();
+    }
+}
+
 DateTime MainSchedule::calculateForward( int use )
 {
     DateTime late;
@@ -1569,6 +1617,22 @@ void ScheduleManager::insertChild( ScheduleManager *sm, int index )
     }
 }
 
+void ScheduleManager::restoreSchedule()
+{
+    if ( m_expected && m_expected->isReleased() ) {
+        m_project.restoreSchedule( m_expected );
+    }
+}
+
+const EffortCube &ScheduleManager::effortCube() const
+{
+    if ( ! m_effortCube.isValid() ) {
+        const_cast<ScheduleManager*>( this )->restoreSchedule();
+        m_effortCube.build( &m_project, scheduleId() );
+    }
+    return m_effortCube;
+}
+
 void ScheduleManager::createSchedules()
 {
     setExpected( m_project.createSchedule( m_name, Schedule::Expected ) );
@@ -1644,6 +1708,9 @@ bool ScheduleManager::isChildBaselined() const
 void ScheduleManager::setBaselined( bool on )
 {
     //debugPlan<<on;
+    if ( on ) {
+        restoreSchedule();
+    }
     m_baselined = on;
     m_project.changed( this );
 }
@@ -1803,6 +1870,7 @@ void ScheduleManager::setDeleted( bool on )
 void ScheduleManager::setExpected( MainSchedule *sch )
 {
     //debugPlan<<m_expected<<","<<sch;
+    m_effortCube.clear();
     if ( m_expected ) {
         m_project.sendScheduleToBeRemoved( m_expected );
         m_expected->setDeleted( true );
@@ -1810,6 +1878,9 @@ void ScheduleManager::setExpected( MainSchedule *sch )
     }
     m_expected = sch;
     if ( sch ) {
+        if ( sch->isReleased() ) {
+            m_project.restoreSchedule( sch );
+        }
         m_project.sendScheduleToBeAdded( this, 0 );
         sch->setManager( this );
         m_expected->setDeleted( false );
@@ -1947,6 +2018,9 @@ bool ScheduleManager::loadXML( KoXmlElement &element, XMLLoaderObject &status )
                 switch ( sch->type() ) {
                     case Schedule::Expected: setExpected( sch ); break;
                 }
+                if ( status.isDeferred( sch->id() ) ) {
+                    sch->setSnapshot( status.takeDeferredSnapshot( sch->id() ) );
+                }
             }
         } else if ( e.tagName() == "plan" ) {
             ScheduleManager *sm = new ScheduleManager( status.project() );
@@ -2021,6 +2095,35 @@ void ScheduleManager::saveXML( QDomElement &element ) const
 
 }
 
+void ScheduleManager::saveXML( KoXmlWriter &writer ) const
+{
+    writer.startElement( "plan" );
+    writer.addAttribute( "name", m_name );
+    writer.addAttribute( "id", m_id );
+    writer.addAttribute( "distribution", QString::number(m_usePert ? 1 : 0) );
+    writer.addAttribute( "overbooking", QString::number(m_allowOverbooking) );
+    writer.addAttribute( "check-external-appointments", QString::number(m_checkExternalAppointments) );
+    writer.addAttribute( "scheduling-direction", QString::number(m_schedulingDirection) );
+    writer.addAttribute( "baselined", QString::number(m_baselined) );
+    writer.addAttribute( "scheduler-plugin-id", m_schedulerPluginId );
+    if ( schedulerPlugin() ) {
+        // atm we only save for current plugin
+        writer.addAttribute( "granularity", QString::number(schedulerPlugin()->granularity()) );
+    }
+    writer.addAttribute( "recalculate", QString::number(m_recalculate) );
+    writer.addAttribute( "recalculate-from", m_recalculateFrom.toString( Qt::ISODate ) );
+    if ( m_expected && ! m_expected->isDeleted() ) {
+        writer.startElement( "schedule" );
+        m_expected->saveXML( writer );
+        m_project.saveAppointments( writer, m_expected->id() );
+        writer.endElement();
+    }
+    foreach ( ScheduleManager *sm, m_children ) {
+        sm->saveXML( writer );
+    }
+    writer.endElement();
+}
+
 void ScheduleManager::saveWorkPackageXML( QDomElement &element, const Node &node ) const
 {
     QDomElement el = element.ownerDocument().createElement( "plan" );
@@ -25,14 +25,17 @@
 #include "kptglobal.h"
 #include "kptcalendar.h"
 #include "kpteffortcostmap.h"
+#include "kpteffortcube.h"
 #include "kptresource.h"
 
+#include <QByteArray>
 #include <QList>
 #include <QMap>
 #include <QString>
 
 //#include "KoXmlReaderForward.h"
 class QDomElement;
+class KoXmlWriter;
 class QStringList;
 
 
@@ -117,7 +120,9 @@ public:
     virtual bool loadXML( const KoXmlElement &element, XMLLoaderObject &status );
     virtual void saveXML( QDomElement &element ) const;
     void saveCommonXML( QDomElement &element ) const;
+    void saveCommonXML( KoXmlWriter &writer ) const;
     void saveAppointments( QDomElement &element ) const;
+    void saveAppointments( KoXmlWriter &writer ) const;
 
     /// Return the effort available in the @p interval
     virtual Duration effort( const DateTimeInterval &interval ) const;
@@ -465,6 +470,8 @@ public:
 
     virtual bool loadXML( const KoXmlElement &element, XMLLoaderObject &status );
     virtual void saveXML( QDomElement &element ) const;
+    /// Save the attributes and children of the current element of @p writer
+    void saveXML( KoXmlWriter &writer ) const;
 
     void setManager( ScheduleManager *sm ) { m_manager = sm; }
     ScheduleManager *manager() const { return m_manager; }
@@ -526,6 +533,12 @@ public:
 
     QStringList logMessages() const;
 
+    /// The compressed task and resource schedules, see Project::releaseSchedule()
+    QByteArray snapshot() const { return m_snapshot; }
+    void setSnapshot( const QByteArray &data ) { m_snapshot = data; }
+    /// Returns true if the task and resource schedules have been moved into the snapshot
+    bool isReleased() const { return ! m_snapshot.isEmpty(); }
+
     QList< QList<Node*> > m_pathlists;
     bool criticalPathListCached;
 
@@ -549,6 +562,7 @@ private:
     
     QVector<Schedule::Log> m_log;
     QMap<int, QString> m_logPhase;
+    QByteArray m_snapshot;
 };
 
 /**
@@ -599,6 +613,8 @@ public:
     void setRecalculateFrom( const DateTime &dt ) { m_recalculateFrom = dt; }
     long parentScheduleId() const { return m_parent == 0 ? NOTSCHEDULED : m_parent->scheduleId(); }
     void createSchedules();
+    /// Load the task schedules and appointments of the expected schedule if they were deferred or released
+    void restoreSchedule();
     
     void setDeleted( bool on );
     
@@ -607,6 +623,15 @@ public:
     void setExpected( MainSchedule *sch );
     MainSchedule *expected() const { return m_expected; }
 
+    /**
+     * Returns the planned effort and cost per resource, task and day of the expected schedule.
+     * The cube is shared by all users of this schedule, it is built when first used
+     * after clearEffortCube().
+     */
+    const EffortCube &effortCube() const;
+    /// Clear the effort cube, it is rebuilt when next used
+    void clearEffortCube() { m_effortCube.clear(); }
+
     QStringList state() const;
 
     void setBaselined( bool on );
@@ -629,6 +654,7 @@ public:
 
     bool loadXML( KoXmlElement &element, XMLLoaderObject &status );
     void saveXML( QDomElement &element ) const;
+    void saveXML( KoXmlWriter &writer ) const;
     
     /// Save a workpackage document
     void saveWorkPackageXML( QDomElement &element, const Node &node ) const;
@@ -716,6 +742,7 @@ protected:
     int m_maxprogress;
     MainSchedule *m_expected;
     QList<ScheduleManager*> m_children;
+    mutable EffortCube m_effortCube;
 
     QString m_schedulerPluginId;
     
@@ -85,6 +85,12 @@ int SchedulerPlugin::capabilities() const
     return AvoidOverbooking | AllowOverbooking | ScheduleForward | ScheduleBackward;
 }
 
+void SchedulerPlugin::calculateEstimateVariants( Project &project, ScheduleManager *sm, const QMap<ScheduleManager*, int> &variants, bool nothread )
+{
+    Q_UNUSED( variants );
+    calculate( project, sm, nothread );
+}
+
 void SchedulerPlugin::stopCalculation( ScheduleManager *sm )
 {
     foreach ( SchedulerThread *j, m_jobs ) {
@@ -27,6 +27,7 @@
 #include <KoXmlReader.h>
 
 #include <QObject>
+#include <QMap>
 #include <QString>
 #include <QMutex>
 #include <QThread>
@@ -82,10 +83,11 @@ public:
         AvoidOverbooking = 1,
         AllowOverbooking = 2,
         ScheduleForward = 4,
-        ScheduleBackward = 8
+        ScheduleBackward = 8,
+        EstimateVariants = 16
     };
     /// Return the schedulers capabilities.
-    /// By default returns all capabilities
+    /// By default returns all capabilities except EstimateVariants
     virtual int capabilities() const;
     /// Stop calculation of the schedule @p sm. Current result may be used.
     void stopCalculation( ScheduleManager *sm );
@@ -99,6 +101,13 @@ public:
     
     /// Calculate the project
     virtual void calculate( Project &project, ScheduleManager *sm, bool nothread = false ) = 0;
+    /**
+     * Calculate the project using the expected estimate for @p sm, and in the same run
+     * the estimate (Estimate::Use) given in @p variants for each of the schedule managers in @p variants.
+     * Only schedulers with the EstimateVariants capability calculate the variants,
+     * the default implementation calculates @p sm only.
+     */
+    virtual void calculateEstimateVariants( Project &project, ScheduleManager *sm, const QMap<ScheduleManager*, int> &variants, bool nothread = false );
 
     /// Return the list of supported granularities
     /// An empty list means granularity is not supported (the default)
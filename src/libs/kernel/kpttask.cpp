@@ -34,6 +34,7 @@
 #include <kptdebug.h>
 
 #include <KoXmlReader.h>
+#include <KoXmlWriter.h>
 
 #include <KLocalizedString>
 
@@ -355,6 +356,11 @@ bool Task::load(KoXmlElement &element, XMLLoaderObject &status ) {
                 }
                 KoXmlElement el = n.toElement();
                 if (el.tagName() == QLatin1String("schedule")) {
+                    long sid = el.attribute(QStringLiteral("id"), QStringLiteral("-1")).toLong();
+                    if (status.isDeferred(sid)) {
+                        status.addDeferredElement(sid, el, m_id);
+                        continue;
+                    }
                     NodeSchedule *sch = new NodeSchedule();
                     if (sch->loadXML(el, status)) {
                         sch->setNode(this);
@@ -452,6 +458,16 @@ void Task::saveAppointments(QDomElement &element, long id) const {
     }
 }
 
+void Task::saveAppointments(KoXmlWriter &writer, long id) const {
+    Schedule *sch = findSchedule(id);
+    if (sch) {
+        sch->saveAppointments(writer);
+    }
+    foreach (const Node *n, m_nodes) {
+        n->saveAppointments(writer, id);
+    }
+}
+
 void Task::saveWorkPackageXML(QDomElement &element, long id )  const
 {
     QDomElement me = element.ownerDocument().createElement(QStringLiteral("task"));
@@ -402,6 +402,8 @@ public:
     virtual void save(QDomElement &element) const;
     /// Save appointments for schedule with id
     virtual void saveAppointments(QDomElement &element, long id) const;
+    /// Save appointments for schedule with id to @p writer
+    virtual void saveAppointments(KoXmlWriter &writer, long id) const;
     
     /// Save a workpackage document with schedule identity @p id
     void saveWorkPackageXML( QDomElement &element, long id ) const;
@@ -0,0 +1,336 @@
+/*  This file is part of the KDE project
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+*/
+
+// clazy:excludeall=qstring-arg
+#include "kptworkpackagemerger.h"
+
+#include "kptcommand.h"
+#include "kptdocuments.h"
+#include "kptglobal.h"
+#include "kptpackage.h"
+#include "kptproject.h"
+#include "kptresource.h"
+#include "kpttask.h"
+#include "kptxmlloaderobject.h"
+#include "kptdebug.h"
+
+#include <KoStore.h>
+#include <KoXmlReader.h>
+
+#include <KLocalizedString>
+#include <KIO/CopyJob>
+
+#include <QTemporaryFile>
+#include <QUrl>
+
+
+namespace KPlato
+{
+
+WorkPackageMerger::WorkPackageMerger( Project &project )
+    : m_project( project ),
+    m_nothingToSave( false )
+{
+}
+
+QString WorkPackageMerger::errorMessage() const
+{
+    return m_message;
+}
+
+bool WorkPackageMerger::nothingToSave() const
+{
+    return m_nothingToSave;
+}
+
+Package *WorkPackageMerger::loadWorkPackage( const QUrl &url )
+{
+    m_message.clear();
+    if ( ! url.isLocalFile() ) {
+        m_message = i18n( "Only local work package files are supported: %1", url.toDisplayString() );
+        return 0;
+    }
+    KoStore *store = KoStore::createStore( url.path(), KoStore::Read, "", KoStore::Auto );
+    if ( store->bad() ) {
+        m_message = i18n( "Not a valid work package file: %1", url.toDisplayString() );
+        delete store;
+        return 0;
+    }
+    if ( ! store->open( "root" ) ) {
+        m_message = i18n( "File does not have a maindoc.xml: %1", url.toDisplayString() );
+        delete store;
+        return 0;
+    }
+    Package *package = 0;
+    KoXmlDocument doc;
+    QString errorMsg; // Error variables for QDomDocument::setContent
+    int errorLine, errorColumn;
+    if ( ! doc.setContent( store->device(), &errorMsg, &errorLine, &errorColumn ) ) {
+        errorPlan << "Parsing error in " << url.url() << "! Aborting!" << endl
+                << " In line: " << errorLine << ", column: " << errorColumn << endl
+                << " Error message: " << errorMsg;
+        m_message = i18n( "Parsing error in %1 at line %2, column %3\nError message: %4", url.toDisplayString(), errorLine, errorColumn, errorMsg );
+    } else {
+        package = loadWorkPackageXML( doc );
+    }
+    store->close();
+    if ( package ) {
+        package->url = url;
+        if ( package->project->id() != m_project.id() || package->toTask == 0 ) {
+            m_message = i18n( "The work package is not for this project: %1", url.toDisplayString() );
+        } else if ( ! package->timeTag.isValid() ) {
+            m_message = i18n( "The work package is not time tagged: %1", url.toDisplayString() );
+        } else if ( package->settings.documents && ! extractFiles( store, package ) ) {
+            m_message = i18n( "Failed to extract the documents of the work package: %1", url.toDisplayString() );
+        }
+        if ( ! m_message.isEmpty() ) {
+            delete package->project;
+            delete package;
+            package = 0;
+        }
+    }
+    delete store;
+    return package;
+}
+
+Package *WorkPackageMerger::loadWorkPackageXML( const KoXmlDocument &document )
+{
+    m_message.clear();
+    KoXmlElement plan = document.documentElement();
+    const QString mime = plan.attribute( "mime", QString() );
+    if ( mime != "application/x-vnd.kde.plan.work" ) {
+        m_message = i18n( "Invalid document. Expected mimetype application/x-vnd.kde.plan.work, got %1", mime );
+        return 0;
+    }
+    XMLLoaderObject loader;
+    loader.setMimetype( mime );
+    loader.setWorkVersion( plan.attribute( "version", "0.0.0" ) );
+    loader.setVersion( plan.attribute( "plan-version", PLAN_FILE_SYNTAX_VERSION ) );
+    loader.startLoad();
+    Project *proj = new Project();
+    Package *package = new Package();
+    package->project = proj;
+    bool ok = true;
+    KoXmlNode n = plan.firstChild();
+    for ( ; ! n.isNull(); n = n.nextSibling() ) {
+        if ( ! n.isElement() ) {
+            continue;
+        }
+        KoXmlElement e = n.toElement();
+        if ( e.tagName() == "project" ) {
+            loader.setProject( proj );
+            ok = proj->load( e, loader );
+            if ( ! ok ) {
+                loader.addMsg( XMLLoaderObject::Errors, "Loading of work package failed" );
+                m_message = i18n( "Loading of work package failed" );
+            }
+        } else if ( e.tagName() == "workpackage" ) {
+            package->timeTag = QDateTime::fromString( e.attribute( "time-tag" ), Qt::ISODate );
+            package->ownerId = e.attribute( "owner-id" );
+            package->ownerName = e.attribute( "owner" );
+            debugPlan<<"workpackage:"<<package->timeTag<<package->ownerId<<package->ownerName;
+            KoXmlElement elem;
+            forEachElement( elem, e ) {
+                if ( elem.tagName() != "settings" ) {
+                    continue;
+                }
+                package->settings.usedEffort = (bool)elem.attribute( "used-effort" ).toInt();
+                package->settings.progress = (bool)elem.attribute( "progress" ).toInt();
+                package->settings.documents = (bool)elem.attribute( "documents" ).toInt();
+            }
+        }
+    }
+    if ( ok && proj->numChildren() > 0 ) {
+        package->task = static_cast<Task*>( proj->childNode( 0 ) );
+        package->toTask = qobject_cast<Task*>( m_project.findNode( package->task->id() ) );
+        WorkPackage &wp = package->task->workPackage();
+        if ( wp.ownerId().isEmpty() ) {
+            wp.setOwnerId( package->ownerId );
+            wp.setOwnerName( package->ownerName );
+        }
+        debugPlan<<"Task set:"<<package->task->name();
+    }
+    loader.stopLoad();
+    if ( ! ok ) {
+        delete proj;
+        delete package;
+        return 0;
+    }
+    return package;
+}
+
+bool WorkPackageMerger::extractFiles( KoStore *store, Package *package )
+{
+    if ( package->task == 0 ) {
+        errorPlan<<"No task!";
+        return false;
+    }
+    foreach ( Document *doc, package->task->documents().documents() ) {
+        if ( ! doc->isValid() || doc->type() != Document::Type_Product || doc->sendAs() != Document::SendAs_Copy ) {
+            continue;
+        }
+        if ( ! extractFile( store, package, doc ) ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool WorkPackageMerger::extractFile( KoStore *store, Package *package, const Document *doc )
+{
+    QTemporaryFile tmpfile;
+    if ( ! tmpfile.open() ) {
+        errorPlan<<"Failed to open temporary file";
+        return false;
+    }
+    if ( ! store->extractFile( doc->url().fileName(), tmpfile.fileName() ) ) {
+        errorPlan<<"Failed to extract file:"<<doc->url().fileName()<<"to:"<<tmpfile.fileName();
+        return false;
+    }
+    package->documents.insert( tmpfile.fileName(), doc->url() );
+    tmpfile.setAutoRemove( false );
+    debugPlan<<"extracted:"<<doc->url().fileName()<<"->"<<tmpfile.fileName();
+    return true;
+}
+
+bool WorkPackageMerger::isMerged( const Package *package ) const
+{
+    if ( package->toTask == 0 || package->task == 0 ) {
+        return false;
+    }
+    // mergeWorkPackage() falls back to the time tag if the package has no transmition time
+    DateTime time = package->task->workPackage().transmitionTime();
+    if ( ! time.isValid() ) {
+        time = DateTime( package->timeTag );
+    }
+    foreach ( const WorkPackage *wp, package->toTask->workPackageLog() ) {
+        if ( wp->transmitionStatus() == WorkPackage::TS_Receive && wp->transmitionTime() == time ) {
+            return true;
+        }
+    }
+    return false;
+}
+
+MacroCommand *WorkPackageMerger::mergeWorkPackage( const Package *package )
+{
+    m_message.clear();
+    const Project &proj = *(package->project);
+    if ( proj.id() != m_project.id() || ! proj.childNode( 0 ) || ! package->task || ! package->toTask ) {
+        m_message = i18n( "The work package is not for this project" );
+        return 0;
+    }
+    return mergeWorkPackage( package->toTask, package->task, package );
+}
+
+MacroCommand *WorkPackageMerger::mergeWorkPackage( Task *to, const Task *from, const Package *package )
+{
+    m_message.clear();
+    m_nothingToSave = false;
+    Resource *resource = m_project.findResource( package->ownerId );
+    if ( resource == 0 ) {
+        m_message = i18n( "The package owner '%1' is not a resource in this project. You must handle this manually.", package->ownerName );
+        return 0;
+    }
+
+    MacroCommand *cmd = new MacroCommand( kundo2_noi18n("Merge workpackage") );
+    Completion &org = to->completion();
+    const Completion &curr = from->completion();
+
+    if ( package->settings.progress ) {
+        if ( org.isStarted() != curr.isStarted() ) {
+            cmd->addCommand( new ModifyCompletionStartedCmd(org, curr.isStarted() ) );
+        }
+        if ( org.isFinished() != curr.isFinished() ) {
+            cmd->addCommand( new ModifyCompletionFinishedCmd( org, curr.isFinished() ) );
+        }
+        if ( org.startTime() != curr.startTime() ) {
+            cmd->addCommand( new ModifyCompletionStartTimeCmd( org, curr.startTime() ) );
+        }
+        if ( org.finishTime() != curr.finishTime() ) {
+            cmd->addCommand( new ModifyCompletionFinishTimeCmd( org, curr.finishTime() ) );
+        }
+        // TODO: review how/if to merge data from different resources
+        // remove entries not in the package, add new entries and modify changed entries.
+        // Both lists are sorted on date, so they are compared in one pass.
+        Completion::EntryList::ConstIterator orgIt = org.entries().constBegin();
+        const Completion::EntryList::ConstIterator orgEnd = org.entries().constEnd();
+        Completion::EntryList::ConstIterator currIt = curr.entries().constBegin();
+        const Completion::EntryList::ConstIterator currEnd = curr.entries().constEnd();
+        while ( orgIt != orgEnd || currIt != currEnd ) {
+            if ( currIt == currEnd || ( orgIt != orgEnd && orgIt.key() < currIt.key() ) ) {
+                debugPlan<<"remove entry "<<orgIt.key();
+                cmd->addCommand( new RemoveCompletionEntryCmd( org, orgIt.key() ) );
+                ++orgIt;
+                continue;
+            }
+            if ( orgIt != orgEnd && orgIt.key() == currIt.key() ) {
+                const bool equal = *orgIt.value() == *currIt.value();
+                ++orgIt;
+                if ( equal ) {
+                    ++currIt;
+                    continue;
+                }
+            }
+            Completion::Entry *e = new Completion::Entry( *currIt.value() );
+            cmd->addCommand( new ModifyCompletionEntryCmd( org, currIt.key(), e ) );
+            ++currIt;
+        }
+    }
+    if ( package->settings.usedEffort ) {
+        Completion::UsedEffort *ue = new Completion::UsedEffort();
+        Completion::Entry prev;
+        Completion::EntryList::ConstIterator entriesIt = curr.entries().constBegin();
+        const Completion::EntryList::ConstIterator entriesEnd = curr.entries().constEnd();
+        for (; entriesIt != entriesEnd; ++entriesIt) {
+            const QDate &d = entriesIt.key();
+            const Completion::Entry &e = *entriesIt.value();
+            // set used effort from date entry and remove used effort from date entry
+            Completion::UsedEffort::ActualEffort effort( e.totalPerformed - prev.totalPerformed );
+            ue->setEffort( d, effort );
+            prev = e;
+        }
+        cmd->addCommand( new AddCompletionUsedEffortCmd( org, resource, ue ) );
+    }
+    bool docsaved = false;
+    if ( package->settings.documents ) {
+        //TODO: handle remote files
+        QMap<QString, QUrl>::const_iterator it = package->documents.constBegin();
+        QMap<QString, QUrl>::const_iterator end = package->documents.constEnd();
+        for ( ; it != end; ++it ) {
+            const QUrl src = QUrl::fromLocalFile(it.key());
+            KIO::CopyJob *job = KIO::move( src, it.value(), KIO::Overwrite );
+            if ( job->exec() ) {
+                docsaved = true;
+                //TODO: async
+                debugPlan<<"Moved file:"<<src<<it.value();
+            }
+        }
+    }
+    m_nothingToSave = ! docsaved && cmd->isEmpty();
+    // add a copy to our tasks list of transmitted packages
+    WorkPackage *wp = new WorkPackage( from->workPackage() );
+    wp->setParentTask( to );
+    if ( ! wp->transmitionTime().isValid() ) {
+        wp->setTransmitionTime( package->timeTag );
+    }
+    wp->setTransmitionStatus( WorkPackage::TS_Receive );
+    cmd->addCommand( new WorkPackageAddCmd( &m_project, to, wp ) );
+    return cmd;
+}
+
+} //namespace KPlato
@@ -0,0 +1,92 @@
+/*  This file is part of the KDE project
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Library General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Library General Public License for more details.
+
+    You should have received a copy of the GNU Library General Public License
+    along with this library; see the file COPYING.LIB.  If not, write to
+    the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+    Boston, MA 02110-1301, USA.
+*/
+
+#ifndef KPTWORKPACKAGEMERGER_H
+#define KPTWORKPACKAGEMERGER_H
+
+#include "plankernel_export.h"
+
+#include <KoXmlReaderForward.h>
+
+#include <QString>
+
+class QUrl;
+class KoStore;
+
+namespace KPlato
+{
+
+class MacroCommand;
+class Package;
+class Project;
+class Task;
+class Document;
+
+/**
+ * Loads work packages and creates the commands that merge them into a project.
+ *
+ * No user interaction is involved, errors are reported by errorMessage(),
+ * so it is used both by the application and by the batch tool.
+ */
+class PLANKERNEL_EXPORT WorkPackageMerger
+{
+public:
+    explicit WorkPackageMerger( Project &project );
+
+    /**
+     * Load the work package file @p url.
+     * Files attached to the package are extracted to temporary files.
+     * Returns 0 and sets errorMessage() if the file is not a work package for this project.
+     */
+    Package *loadWorkPackage( const QUrl &url );
+    /**
+     * Load a work package in the plan.work format from @p document.
+     * The package project is loaded even if it is not this project.
+     * Returns 0 and sets errorMessage() on failure.
+     */
+    Package *loadWorkPackageXML( const KoXmlDocument &document );
+    /// Extract the files attached to the task in @p package from @p store
+    bool extractFiles( KoStore *store, Package *package );
+
+    /**
+     * Create a command that merges @p from in @p package into the task @p to.
+     * Attached documents are moved into place immediately.
+     * Returns 0 and sets errorMessage() if the package can not be merged.
+     */
+    MacroCommand *mergeWorkPackage( Task *to, const Task *from, const Package *package );
+    /// Create a command that merges @p package into its task, see mergeWorkPackage()
+    MacroCommand *mergeWorkPackage( const Package *package );
+    /// True if @p package is already registered in the work package log of its task
+    bool isMerged( const Package *package ) const;
+    /// True if the last merged package had neither progress data nor documents
+    bool nothingToSave() const;
+
+    QString errorMessage() const;
+
+private:
+    bool extractFile( KoStore *store, Package *package, const Document *doc );
+
+private:
+    Project &m_project;
+    QString m_message;
+    bool m_nothingToSave;
+};
+
+} //namespace KPlato
+
+#endif
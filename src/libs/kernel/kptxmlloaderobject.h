@@ -26,11 +26,14 @@
 #include "kptdatetime.h"
 
 #include <KoUpdater.h>
+#include <KoXmlReader.h>
 
 #include <QDateTime>
 #include <QString>
 #include <QStringList>
 #include <QPointer>
+#include <QHash>
+#include <QDomDocument>
 
 namespace KPlato 
 {
@@ -44,7 +47,8 @@ public:
       m_warnings(0),
       m_logLevel(Diagnostics),
       m_log(),
-      m_baseCalendar( 0 )
+      m_baseCalendar( 0 ),
+      m_loadSchedulesOnDemand( false )
     {}
     ~XMLLoaderObject() {}
     
@@ -115,6 +119,39 @@ public:
     void setUpdater( KoUpdater *updater ) { m_updater = updater; }
     void setProgress( int value ) { if ( m_updater ) m_updater->setProgress( value ); }
 
+    /// Keep task schedules and appointments of schedules that are not baselined as snapshots,
+    /// they are loaded when the schedule is used, see Project::restoreSchedule()
+    void setLoadSchedulesOnDemand( bool on ) { m_loadSchedulesOnDemand = on; }
+    bool loadSchedulesOnDemand() const { return m_loadSchedulesOnDemand; }
+
+    /// Collect the task schedules and appointments of schedule @p id into a snapshot instead of loading them
+    void deferSchedule( long id ) { m_deferredSchedules.insert( id, QDomDocument( QStringLiteral( "snapshot" ) ) ); }
+    bool isDeferred( long id ) const { return m_deferredSchedules.contains( id ); }
+    /// Add @p element to the snapshot of schedule @p id, as a task schedule if @p nodeId is not empty
+    void addDeferredElement( long id, const KoXmlElement &element, const QString &nodeId = QString() ) {
+        QDomDocument &doc = m_deferredSchedules[ id ];
+        if ( doc.documentElement().isNull() ) {
+            QDomElement e = doc.createElement( QStringLiteral( "snapshot" ) );
+            e.setAttribute( QStringLiteral( "version" ), m_version );
+            doc.appendChild( e );
+        }
+        QDomElement parent = doc.documentElement();
+        if ( ! nodeId.isEmpty() ) {
+            QDomElement e = doc.createElement( QStringLiteral( "node" ) );
+            e.setAttribute( QStringLiteral( "id" ), nodeId );
+            parent.appendChild( e );
+            parent = e;
+        }
+        QDomDocument tmp;
+        KoXml::asQDomElement( tmp, element );
+        parent.appendChild( doc.importNode( tmp.documentElement(), true ) );
+    }
+    /// Returns the compressed snapshot of schedule @p id, or an empty array if nothing was deferred
+    QByteArray takeDeferredSnapshot( long id ) {
+        QDomDocument doc = m_deferredSchedules.take( id );
+        return doc.documentElement().isNull() ? QByteArray() : qCompress( doc.toByteArray( -1 ) );
+    }
+
 protected:
     Project *m_project;
     int m_errors;
@@ -132,6 +169,9 @@ protected:
     Calendar *m_baseCalendar; // help to handle version < 0.6
 
     QPointer<KoUpdater> m_updater;
+
+    bool m_loadSchedulesOnDemand;
+    QHash<long, QDomDocument> m_deferredSchedules;
 };
 
 } //namespace KPlato
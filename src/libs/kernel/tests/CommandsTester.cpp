@@ -25,8 +25,10 @@
 #include <kptcalendar.h>
 #include <kptproject.h>
 #include <kptresource.h>
+#include <kpttask.h>
 
 #include <QTest>
+#include <QSignalSpy>
 
 namespace KPlato {
 
@@ -530,6 +532,55 @@ void CommandsTester::testProjectModifyDefaultCalendarCmd()
     delete calendar2;
     delete cmd1;
 }
+
+void CommandsTester::testBatchMacroCommand()
+{
+    Task *task = m_project->createTask();
+    m_project->addTask( task, m_project );
+    Completion &completion = task->completion();
+    QSignalSpy spy( m_project, &Project::nodeChanged );
+
+    BatchMacroCommand *cmd1 = new BatchMacroCommand( *m_project );
+    cmd1->addCommand( new ModifyCompletionStartedCmd( completion, true ) );
+    cmd1->addCommand( new AddCompletionEntryCmd( completion, QDate( 2011, 3, 26 ), new Completion::Entry( 10, Duration( 1.0, Duration::Unit_d ), Duration( 1.0, Duration::Unit_d ) ) ) );
+    cmd1->addCommand( new AddCompletionEntryCmd( completion, QDate( 2011, 3, 27 ), new Completion::Entry( 20, Duration( 1.0, Duration::Unit_d ), Duration( 2.0, Duration::Unit_d ) ) ) );
+    cmd1->execute();
+    QVERIFY( completion.isStarted() );
+    QCOMPARE( completion.entries().count(), 2 );
+    // one notification for all the changes
+    QCOMPARE( spy.count(), 1 );
+    QCOMPARE( spy.at( 0 ).at( 0 ).value<Node*>(), task );
+
+    cmd1->unexecute();
+    QVERIFY( ! completion.isStarted() );
+    QCOMPARE( completion.entries().count(), 0 );
+    QCOMPARE( spy.count(), 2 );
+
+    // commands executed while the batch is built are not executed again
+    spy.clear();
+    BatchMacroCommand *cmd2 = new BatchMacroCommand( *m_project );
+    m_project->beginBatchChange();
+    MacroCommand *c = new MacroCommand();
+    c->addCommand( new ModifyCompletionStartedCmd( completion, true ) );
+    c->addCommand( new AddCompletionEntryCmd( completion, QDate( 2011, 3, 26 ), new Completion::Entry( 10, Duration( 1.0, Duration::Unit_d ), Duration( 1.0, Duration::Unit_d ) ) ) );
+    c->redo();
+    cmd2->addExecutedCommand( c );
+    QCOMPARE( spy.count(), 0 );
+    m_project->endBatchChange();
+    QCOMPARE( spy.count(), 1 );
+    cmd2->execute();
+    QCOMPARE( completion.entries().count(), 1 );
+    cmd2->unexecute();
+    QCOMPARE( completion.entries().count(), 0 );
+    cmd2->execute();
+    QCOMPARE( completion.entries().count(), 1 );
+    QCOMPARE( spy.count(), 3 );
+
+    delete cmd1;
+    delete cmd2;
+    m_project->takeTask( task );
+    delete task;
+}
 } // namespace KPlato
 
 QTEST_GUILESS_MAIN( KPlato::CommandsTester)
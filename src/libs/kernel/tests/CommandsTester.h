@@ -52,6 +52,8 @@ private Q_SLOTS:
     void testCalendarModifyDateCmd();
     void testProjectModifyDefaultCalendarCmd();
 
+    void testBatchMacroCommand();
+
 private:
     Project *m_project;
 };
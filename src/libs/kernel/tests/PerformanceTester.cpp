@@ -23,6 +23,10 @@
 #include "kptduration.h"
 #include "kpteffortcostmap.h"
 #include "kptcommand.h"
+#include "kptevmsnapshot.h"
+#include "kpteffortcube.h"
+#include "kptappointment.h"
+#include "kptschedule.h"
 
 #include "debug.cpp"
 
@@ -1119,6 +1123,86 @@ void PerformanceTester::acwpPrDayProject()
     QCOMPARE( eca.costOnDate( d ), 12.25 );
 }
 
+void PerformanceTester::evmSnapshot()
+{
+    long id = p1->scheduleManagers().first()->scheduleId();
+    QDate d = t1->startTime().date().addDays( 1 );
+    t1->setStartupCost( 0.5 );
+    ModifyCompletionPercentFinishedCmd *cmd = new ModifyCompletionPercentFinishedCmd( t1->completion(), d, 20 );
+    cmd->execute(); delete cmd;
+    cmd = new ModifyCompletionPercentFinishedCmd( t1->completion(), d.addDays( 1 ), 30 );
+    cmd->execute(); delete cmd;
+
+    EvmSnapshot evm;
+    QVERIFY( ! evm.isValid( id, d ) );
+    evm.calculate( p1, id, d );
+    QVERIFY( evm.isValid( id, d ) );
+    QVERIFY( ! evm.isValid( id, d.addDays( 1 ) ) );
+
+    QList<Node*> nodes;
+    nodes << p1 << s1 << t1 << s2 << m1;
+    foreach ( const Node *n, nodes ) {
+        EvmSnapshot::Values v = evm.values( n );
+        QCOMPARE( v.plannedCostTo, n->plannedCostTo( d, id ) );
+        QCOMPARE( v.actualCostTo.cost(), n->actualCostTo( id, d ).cost() );
+        QCOMPARE( v.bcws, n->bcws( d, id ) );
+        QCOMPARE( v.bcwp, n->bcwp( id ) );
+        QCOMPARE( v.acwp.cost(), n->acwp( d, id ).cost() );
+        QCOMPARE( v.spi, n->schedulePerformanceIndex( d, id ) );
+    }
+    evm.clear();
+    QVERIFY( ! evm.isValid( id, d ) );
+}
+
+void PerformanceTester::effortCube()
+{
+    ScheduleManager *sm = p1->scheduleManagers().first();
+    long id = sm->scheduleId();
+
+    const EffortCube &cube = sm->effortCube();
+    QVERIFY( cube.isValid() );
+    QCOMPARE( cube.id(), id );
+
+    QList<Resource*> resources;
+    resources << r1 << r2 << r3;
+    foreach ( const Resource *r, resources ) {
+        EffortCostMap total;
+        QList<const Node*> nodes;
+        foreach ( const Appointment *a, r->appointments( id ) ) {
+            const Node *n = a->node()->node();
+            nodes << n;
+            EffortCostMap ec = a->plannedPrDay( a->startTime().date(), a->endTime().date() );
+            total += ec;
+            QCOMPARE( cube.effortCost( r, n ).effort(), ec.totalEffort() );
+            QCOMPARE( cube.effortCost( r, n ).cost(), ec.totalCost() );
+            for ( QDate d = ec.startDate(); d <= ec.endDate(); d = d.addDays( 1 ) ) {
+                QCOMPARE( cube.effortCost( r, n, d ).effort(), ec.effortOnDate( d ) );
+                QCOMPARE( cube.effortCost( r, n, d ).cost(), ec.costOnDate( d ) );
+            }
+            QCOMPARE( cube.effortCostPrDay( r, n ).totalEffort(), ec.totalEffort() );
+        }
+        QCOMPARE( cube.nodes( r ).count(), nodes.count() );
+        QCOMPARE( cube.effortCost( r ).effort(), total.totalEffort() );
+        QCOMPARE( cube.effortCost( r ).cost(), total.totalCost() );
+        for ( QDate d = total.startDate(); d <= total.endDate(); d = d.addDays( 1 ) ) {
+            QCOMPARE( cube.effortCost( r, d ).effort(), total.effortOnDate( d ) );
+        }
+        QCOMPARE( cube.effortCostPrDay( r ).totalEffort(), total.totalEffort() );
+    }
+    QVERIFY( cube.effortCost( r1 ).effort() > Duration::zeroDuration );
+    QCOMPARE( cube.startDate(), t1->startTime().date() );
+    // nothing outside the schedule
+    QCOMPARE( cube.effortCost( r1, t1->startTime().date().addDays( -1 ) ).effort(), Duration::zeroDuration );
+    QCOMPARE( cube.effortCost( r1, s1 ).effort(), Duration::zeroDuration );
+
+    // cleared when the schedule is recalculated, and re-built when used
+    Duration effort = cube.effortCost( r1 ).effort();
+    p1->calculate( *sm );
+    QVERIFY( ! cube.isValid() );
+    QCOMPARE( sm->effortCube().effortCost( r1 ).effort(), effort );
+    QVERIFY( cube.isValid() );
+}
+
 } //namespace KPlato
 
 QTEST_GUILESS_MAIN( KPlato::PerformanceTester )
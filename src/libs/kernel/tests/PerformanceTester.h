@@ -51,6 +51,9 @@ private Q_SLOTS:
     void bcwpPrDayProject();
     void acwpPrDayProject();
 
+    void evmSnapshot();
+    void effortCube();
+
 private:
     Project *p1;
     Resource *r1;
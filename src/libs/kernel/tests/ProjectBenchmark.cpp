@@ -0,0 +1,232 @@
+/* This file is part of the KDE project
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+// clazy:excludeall=qstring-arg
+#include "ProjectBenchmark.h"
+#include "ProjectGenerator.h"
+
+#include "kptglobal.h"
+#include "kptappointment.h"
+#include "kpteffortcostmap.h"
+#include "kptxmlloaderobject.h"
+
+#include <KoStore.h>
+#include <KoXmlReader.h>
+
+#include <QTest>
+#include <QBuffer>
+#include <QDomDocument>
+#include <QScopedPointer>
+
+namespace KPlato
+{
+
+static QDomDocument saveProject( const Project *project )
+{
+    QDomDocument doc( "plan" );
+    QDomElement e = doc.createElement( "plan" );
+    e.setAttribute( "version", PLAN_FILE_SYNTAX_VERSION );
+    doc.appendChild( e );
+    project->save( e );
+    return doc;
+}
+
+static bool loadProject( Project *project, const QByteArray &data )
+{
+    KoXmlDocument doc;
+    if ( ! doc.setContent( data ) ) {
+        return false;
+    }
+    XMLLoaderObject status;
+    status.setProject( project );
+    status.setVersion( PLAN_FILE_SYNTAX_VERSION );
+    KoXmlElement e = doc.documentElement().firstChildElement();
+    return project->load( e, status );
+}
+
+void ProjectBenchmark::calculate_data()
+{
+    ProjectGenerator::addBenchmarkData();
+}
+
+void ProjectBenchmark::calculate()
+{
+    QFETCH( int, tasks );
+    QFETCH( int, resources );
+
+    QScopedPointer<Project> project( ProjectGenerator::createProject( tasks, resources ) );
+    ScheduleManager *sm = ProjectGenerator::createScheduleManager( project.data(), "Benchmark" );
+
+    QBENCHMARK {
+        project->calculate( *sm );
+    }
+    QVERIFY( project->endTime().isValid() );
+}
+
+void ProjectBenchmark::calendarEffort_data()
+{
+    QTest::addColumn<int>( "years" );
+
+    QTest::newRow( "1 year" ) << 1;
+    QTest::newRow( "5 years" ) << 5;
+    QTest::newRow( "10 years" ) << 10;
+}
+
+void ProjectBenchmark::calendarEffort()
+{
+    QFETCH( int, years );
+
+    QScopedPointer<Project> project( ProjectGenerator::createProject( 0, 0, years ) );
+    Calendar *calendar = project->defaultCalendar();
+    QVERIFY( calendar );
+    DateTime start = project->constraintStartTime();
+    DateTime end = start.addDays( years * 365 );
+
+    Duration effort;
+    QBENCHMARK {
+        effort = calendar->effort( start, end );
+    }
+    QVERIFY( effort > Duration::zeroDuration );
+}
+
+void ProjectBenchmark::calendarWorkIntervals_data()
+{
+    calendarEffort_data();
+}
+
+void ProjectBenchmark::calendarWorkIntervals()
+{
+    QFETCH( int, years );
+
+    QScopedPointer<Project> project( ProjectGenerator::createProject( 0, 0, years ) );
+    Calendar *calendar = project->defaultCalendar();
+    QVERIFY( calendar );
+    DateTime start = project->constraintStartTime();
+    DateTime end = start.addDays( years * 365 );
+
+    int count = 0;
+    QBENCHMARK {
+        count = calendar->workIntervals( start, end, 100. ).map().count();
+    }
+    QVERIFY( count > 0 );
+}
+
+void ProjectBenchmark::effortCostMap_data()
+{
+    ProjectGenerator::addBenchmarkData();
+}
+
+void ProjectBenchmark::effortCostMap()
+{
+    QFETCH( int, tasks );
+    QFETCH( int, resources );
+
+    QScopedPointer<Project> project( ProjectGenerator::createProject( tasks, resources ) );
+    ScheduleManager *sm = ProjectGenerator::createScheduleManager( project.data(), "Benchmark" );
+    project->calculate( *sm );
+    long id = sm->scheduleId();
+
+    EffortCostMap ecm;
+    QBENCHMARK {
+        ecm = project->bcwsPrDay( id );
+    }
+    QVERIFY( ecm.totalEffort() > Duration::zeroDuration );
+}
+
+void ProjectBenchmark::saveXml_data()
+{
+    ProjectGenerator::addBenchmarkData();
+}
+
+void ProjectBenchmark::saveXml()
+{
+    QFETCH( int, tasks );
+    QFETCH( int, resources );
+
+    QScopedPointer<Project> project( ProjectGenerator::createProject( tasks, resources ) );
+    ScheduleManager *sm = ProjectGenerator::createScheduleManager( project.data(), "Benchmark" );
+    project->calculate( *sm );
+
+    QByteArray data;
+    QBENCHMARK {
+        data = saveProject( project.data() ).toByteArray();
+    }
+    QVERIFY( ! data.isEmpty() );
+}
+
+void ProjectBenchmark::loadXml_data()
+{
+    ProjectGenerator::addBenchmarkData();
+}
+
+void ProjectBenchmark::loadXml()
+{
+    QFETCH( int, tasks );
+    QFETCH( int, resources );
+
+    QScopedPointer<Project> project( ProjectGenerator::createProject( tasks, resources ) );
+    ScheduleManager *sm = ProjectGenerator::createScheduleManager( project.data(), "Benchmark" );
+    project->calculate( *sm );
+    QByteArray data = saveProject( project.data() ).toByteArray();
+
+    QBENCHMARK {
+        Project p;
+        QVERIFY( loadProject( &p, data ) );
+    }
+}
+
+void ProjectBenchmark::store_data()
+{
+    ProjectGenerator::addBenchmarkData();
+}
+
+void ProjectBenchmark::store()
+{
+    QFETCH( int, tasks );
+    QFETCH( int, resources );
+
+    QScopedPointer<Project> project( ProjectGenerator::createProject( tasks, resources ) );
+    ScheduleManager *sm = ProjectGenerator::createScheduleManager( project.data(), "Benchmark" );
+    project->calculate( *sm );
+
+    // Save to and load from a zip store, as when saving a .plan file
+    QBENCHMARK {
+        QBuffer buffer;
+        buffer.open( QIODevice::WriteOnly );
+        QScopedPointer<KoStore> out( KoStore::createStore( &buffer, KoStore::Write, "application/x-vnd.kde.plan", KoStore::Zip ) );
+        QVERIFY( out->open( "root" ) );
+        out->write( saveProject( project.data() ).toByteArray() );
+        QVERIFY( out->close() );
+        QVERIFY( out->finalize() );
+        out.reset();
+        buffer.close();
+
+        buffer.open( QIODevice::ReadOnly );
+        QScopedPointer<KoStore> in( KoStore::createStore( &buffer, KoStore::Read, "", KoStore::Zip ) );
+        QVERIFY( in->open( "root" ) );
+        QByteArray data = in->read( in->size() );
+        QVERIFY( in->close() );
+
+        Project p;
+        QVERIFY( loadProject( &p, data ) );
+    }
+}
+
+} //namespace KPlato
+
+QTEST_GUILESS_MAIN( KPlato::ProjectBenchmark )
@@ -0,0 +1,154 @@
+/* This file is part of the KDE project
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef KPlato_ProjectGenerator_h
+#define KPlato_ProjectGenerator_h
+
+#include "kptproject.h"
+#include "kptcalendar.h"
+#include "kptresource.h"
+#include "kpttask.h"
+#include "kptrelation.h"
+#include "kptschedule.h"
+
+#include <QTest>
+
+namespace KPlato
+{
+
+/**
+ * Generates projects of configurable size for the benchmarks.
+ *
+ * The project gets a default calendar with an 8 hour working day monday to friday
+ * and a set of holidays for each year the project may span.
+ * Tasks are created in summary tasks with 10 children each, the children are
+ * linked finish-start in pairs so that there are both parallel and serial paths.
+ * Each leaf task requests one of the resources in a round robin fashion.
+ */
+class ProjectGenerator
+{
+public:
+    /// Add the test data rows for projects with up to @p maxTasks tasks
+    static void addBenchmarkData( int maxTasks = 10000 ) {
+        QTest::addColumn<int>( "tasks" );
+        QTest::addColumn<int>( "resources" );
+
+        for ( int tasks = 100; tasks <= maxTasks; tasks *= 10 ) {
+            QTest::newRow( QString( "%1 tasks, %2 resources" ).arg( tasks ).arg( tasks / 10 ).toLatin1() ) << tasks << tasks / 10;
+        }
+    }
+
+    static Calendar *createCalendar( Project *project, int years ) {
+        Calendar *c = new Calendar( "Benchmark" );
+        c->setDefault( true );
+        QTime t1( 8, 0, 0 );
+        QTime t2( 16, 0, 0 );
+        int length = t1.msecsTo( t2 );
+        for ( int i = 1; i <= 7; ++i ) {
+            CalendarDay *d = c->weekday( i );
+            if ( i > 5 ) {
+                d->setState( CalendarDay::NonWorking );
+                continue;
+            }
+            d->setState( CalendarDay::Working );
+            d->addInterval( t1, length );
+        }
+        int year = project->constraintStartTime().date().year();
+        for ( int y = year; y <= year + years; ++y ) {
+            const QList<QDate> holidays = QList<QDate>()
+                << QDate( y, 1, 1 ) << QDate( y, 5, 1 ) << QDate( y, 5, 17 )
+                << QDate( y, 12, 24 ) << QDate( y, 12, 25 ) << QDate( y, 12, 26 ) << QDate( y, 12, 31 );
+            foreach ( const QDate &date, holidays ) {
+                c->addDay( new CalendarDay( date, CalendarDay::NonWorking ) );
+            }
+        }
+        project->addCalendar( c );
+        return c;
+    }
+
+    static QList<Resource*> createResources( Project *project, int count ) {
+        QList<Resource*> lst;
+        ResourceGroup *g = 0;
+        for ( int i = 0; i < count; ++i ) {
+            if ( i % 10 == 0 ) {
+                g = new ResourceGroup();
+                g->setName( QString( "G%1" ).arg( i / 10 + 1 ) );
+                project->addResourceGroup( g );
+            }
+            Resource *r = new Resource();
+            r->setName( QString( "R%1" ).arg( i + 1 ) );
+            r->setNormalRate( 100.0 );
+            project->addResource( g, r );
+            lst << r;
+        }
+        return lst;
+    }
+
+    /// Create a project with @p tasks leaf tasks and @p resources resources, spanning up to @p years years
+    static Project *createProject( int tasks, int resources, int years = 10 ) {
+        Project *project = new Project();
+        project->setName( QString( "Benchmark %1/%2" ).arg( tasks ).arg( resources ) );
+        project->setId( project->uniqueNodeId() );
+        project->registerNodeId( project );
+        DateTime start( QDate( 2017, 1, 2 ), QTime( 8, 0, 0 ) );
+        project->setConstraintStartTime( start );
+        project->setConstraintEndTime( start.addDays( years * 365 ) );
+
+        createCalendar( project, years );
+        QList<Resource*> rlst = createResources( project, resources );
+
+        Task *summary = 0;
+        Task *previous = 0;
+        for ( int i = 0; i < tasks; ++i ) {
+            if ( i % 10 == 0 ) {
+                summary = project->createTask();
+                summary->setName( QString( "S%1" ).arg( i / 10 + 1 ) );
+                project->addTask( summary, project );
+                previous = 0;
+            }
+            Task *t = project->createTask();
+            t->setName( QString( "T%1" ).arg( i + 1 ) );
+            t->estimate()->setType( Estimate::Type_Effort );
+            t->estimate()->setUnit( Duration::Unit_d );
+            t->estimate()->setExpectedEstimate( 1.0 + i % 5 );
+            project->addSubTask( t, summary );
+            if ( ! rlst.isEmpty() ) {
+                Resource *r = rlst.at( i % rlst.count() );
+                ResourceGroupRequest *gr = new ResourceGroupRequest( r->parentGroup() );
+                t->addRequest( gr );
+                gr->addResourceRequest( new ResourceRequest( r, 100 ) );
+            }
+            if ( previous && i % 2 == 1 ) {
+                project->addRelation( new Relation( previous, t ), false );
+            }
+            previous = t;
+        }
+        return project;
+    }
+
+    static ScheduleManager *createScheduleManager( Project *project, const QString &name ) {
+        ScheduleManager *sm = project->createScheduleManager( name );
+        project->addScheduleManager( sm );
+        sm->createSchedules();
+        return sm;
+    }
+};
+
+} //namespace KPlato
+
+#endif
@@ -27,8 +27,15 @@
 #include "kptnode.h"
 #include "kpttask.h"
 #include "kptschedule.h"
+#include "kptappointment.h"
+#include "kptxmlloaderobject.h"
+#include "ProjectGenerator.h"
+
+#include <KoXmlWriter.h>
 
 #include <QTest>
+#include <QBuffer>
+#include <QDomDocument>
 
 #include "debug.cpp"
 
@@ -125,6 +132,57 @@ void ProjectTester::testTaskDeleteCmd()
     m_task = 0;
 }
 
+void ProjectTester::testWbsCode()
+{
+    Project p;
+    p.setId( p.uniqueNodeId() );
+    p.registerNodeId( &p );
+
+    Task *t1 = p.createTask();
+    QVERIFY( p.addTask( t1, &p ) );
+    Task *t2 = p.createTask();
+    QVERIFY( p.addTask( t2, &p ) );
+    Task *t3 = p.createTask();
+    QVERIFY( p.addSubTask( t3, t2 ) );
+    QCOMPARE( t1->wbsCode(), QString( "1" ) );
+    QCOMPARE( t2->wbsCode(), QString( "2" ) );
+    QCOMPARE( t3->wbsCode(), QString( "2.1" ) );
+
+    // insert before t1, all codes must follow
+    Task *t4 = p.createTask();
+    QVERIFY( p.addSubTask( t4, 0, &p ) );
+    QCOMPARE( t4->wbsCode(), QString( "1" ) );
+    QCOMPARE( t1->wbsCode(), QString( "2" ) );
+    QCOMPARE( t2->wbsCode(), QString( "3" ) );
+    QCOMPARE( t3->wbsCode(), QString( "3.1" ) );
+
+    QVERIFY( p.indentTask( t1 ) );
+    QCOMPARE( t1->wbsCode(), QString( "1.1" ) );
+    QCOMPARE( t2->wbsCode(), QString( "2" ) );
+    QCOMPARE( t3->wbsCode(), QString( "2.1" ) );
+
+    QVERIFY( p.unindentTask( t1 ) );
+    QCOMPARE( t1->wbsCode(), QString( "2" ) );
+    QCOMPARE( t2->wbsCode(), QString( "3" ) );
+
+    QVERIFY( p.moveTask( t2, &p, 0 ) );
+    QCOMPARE( t2->wbsCode(), QString( "1" ) );
+    QCOMPARE( t3->wbsCode(), QString( "1.1" ) );
+    QCOMPARE( t4->wbsCode(), QString( "2" ) );
+
+    p.takeTask( t4 );
+    QCOMPARE( t1->wbsCode(), QString( "2" ) );
+    QCOMPARE( t4->wbsCode(), QString() );
+    delete t4;
+
+    WBSDefinition def = p.wbsDefinition();
+    def.setProjectCode( "P" );
+    def.setProjectSeparator( "-" );
+    p.setWbsDefinition( def );
+    QCOMPARE( t3->wbsCode(), QString( "P-1.1" ) );
+    QCOMPARE( t3->wbsCode( true ), QString( "P.0.0" ) );
+}
+
 void ProjectTester::schedule()
 {
     QDate today = QDate::fromString( "2012-02-01", Qt::ISODate );
@@ -3248,6 +3306,256 @@ void ProjectTester::scheduleTimeZone()
     unsetenv("TZ");
 }
 
+// Compare element names, attributes and content, attribute order is not significant
+static bool compareElements( const QDomElement &e1, const QDomElement &e2 )
+{
+    if ( e1.tagName() != e2.tagName() ) {
+        qDebug()<<"Tag name differs:"<<e1.tagName()<<e2.tagName();
+        return false;
+    }
+    const QDomNamedNodeMap a1 = e1.attributes();
+    const QDomNamedNodeMap a2 = e2.attributes();
+    if ( a1.count() != a2.count() ) {
+        qDebug()<<e1.tagName()<<"Number of attributes differs:"<<a1.count()<<a2.count();
+        return false;
+    }
+    for ( int i = 0; i < a1.count(); ++i ) {
+        const QDomAttr a = a1.item( i ).toAttr();
+        if ( ! e2.hasAttribute( a.name() ) || e2.attribute( a.name() ) != a.value() ) {
+            qDebug()<<e1.tagName()<<"Attribute differs:"<<a.name()<<a.value()<<e2.attribute( a.name() );
+            return false;
+        }
+    }
+    if ( e1.text() != e2.text() ) {
+        qDebug()<<e1.tagName()<<"Text differs:"<<e1.text()<<e2.text();
+        return false;
+    }
+    QDomElement c1 = e1.firstChildElement();
+    QDomElement c2 = e2.firstChildElement();
+    for ( ; ! c1.isNull() && ! c2.isNull(); c1 = c1.nextSiblingElement(), c2 = c2.nextSiblingElement() ) {
+        if ( ! compareElements( c1, c2 ) ) {
+            return false;
+        }
+    }
+    if ( ! c1.isNull() || ! c2.isNull() ) {
+        qDebug()<<e1.tagName()<<"Number of children differs";
+        return false;
+    }
+    return true;
+}
+
+void ProjectTester::streamingSave()
+{
+    // A project with tasks, resources, relations and calculated schedules
+    Project *project = ProjectGenerator::createProject( 20, 2, 1 );
+    ScheduleManager *sm = ProjectGenerator::createScheduleManager( project, "S1" );
+    project->calculate( *sm );
+    QVERIFY( sm->isScheduled() );
+    ScheduleManager *sm2 = ProjectGenerator::createScheduleManager( project, "S2" );
+    project->calculate( *sm2 );
+    QVERIFY( sm2->isScheduled() );
+
+    QDomDocument domDoc( "plan" );
+    QDomElement domPlan = domDoc.createElement( "plan" );
+    domDoc.appendChild( domPlan );
+    project->save( domPlan );
+
+    QBuffer buffer;
+    buffer.open( QIODevice::WriteOnly );
+    KoXmlWriter writer( &buffer );
+    writer.startDocument( "plan" );
+    writer.startElement( "plan" );
+    project->save( writer );
+    writer.endElement();
+    writer.endDocument();
+    buffer.close();
+
+    QDomDocument streamDoc;
+    QString error;
+    QVERIFY2( streamDoc.setContent( buffer.data(), &error ), error.toLatin1() );
+
+    QVERIFY( compareElements( domDoc.documentElement(), streamDoc.documentElement() ) );
+
+    delete project;
+}
+
+void ProjectTester::streamingSaveMultiLine()
+{
+    Project *project = ProjectGenerator::createProject( 2, 1, 1 );
+    const QString text = QStringLiteral( "First line\nSecond\tline\r\nThird line" );
+    project->setDescription( text );
+    Task *task = project->allTasks().first();
+    task->setDescription( text );
+
+    QBuffer buffer;
+    buffer.open( QIODevice::WriteOnly );
+    KoXmlWriter writer( &buffer );
+    writer.startDocument( "plan" );
+    writer.startElement( "plan" );
+    project->save( writer );
+    writer.endElement();
+    writer.endDocument();
+    buffer.close();
+
+    // Line breaks and tabs in attributes must survive attribute value normalization
+    KoXmlDocument xdoc;
+    QVERIFY( xdoc.setContent( buffer.data() ) );
+    Project p2;
+    XMLLoaderObject status;
+    status.setProject( &p2 );
+    status.setVersion( PLAN_FILE_SYNTAX_VERSION );
+    QVERIFY( p2.load( xdoc.documentElement().namedItem( "project" ).toElement(), status ) );
+    QCOMPARE( p2.description(), text );
+    Node *t2 = p2.findNode( task->id() );
+    QVERIFY( t2 );
+    QCOMPARE( t2->description(), text );
+
+    delete project;
+}
+
+void ProjectTester::releaseSchedule()
+{
+    Project *project = ProjectGenerator::createProject( 20, 2, 1 );
+    ScheduleManager *sm = ProjectGenerator::createScheduleManager( project, "S1" );
+    project->calculate( *sm );
+    MainSchedule *sch = sm->expected();
+    QVERIFY( sch );
+    long id = sch->id();
+
+    Task *task = 0;
+    foreach ( Task *t, project->allTasks() ) {
+        if ( t->type() == Node::Type_Task && t->findSchedule( id ) && ! t->findSchedule( id )->appointments().isEmpty() ) {
+            task = t;
+            break;
+        }
+    }
+    QVERIFY( task );
+    Resource *resource = task->findSchedule( id )->appointments().first()->resource()->resource();
+    const DateTime start = task->startTime( id );
+    const DateTime end = task->endTime( id );
+    const Duration effort = resource->plannedEffortCostPrDay( start.date(), end.date(), id ).totalEffort();
+    QVERIFY( effort > 0 );
+    const int appointments = task->findSchedule( id )->appointments().count();
+
+    // A schedule in use cannot be released
+    QVERIFY( ! project->releaseSchedule( sch ) );
+
+    // Replace the schedule, the old one is kept as deleted as when the calculation is undoable
+    sm->createSchedules();
+    QVERIFY( sch->isDeleted() );
+    QVERIFY( project->scheduleMemoryUsage( sch ) > 0 );
+
+    QVERIFY( project->releaseSchedule( sch ) );
+    QVERIFY( sch->isReleased() );
+    QVERIFY( task->findSchedule( id ) == 0 );
+    QVERIFY( resource->findSchedule( id ) == 0 );
+    QCOMPARE( project->scheduleMemoryUsage( sch ), (qint64)sch->snapshot().size() );
+    QVERIFY( project->schedule( id ) == sch );
+
+    // Setting it back restores task and resource schedules
+    sm->setExpected( sch );
+    QVERIFY( ! sch->isReleased() );
+    QVERIFY( ! sch->isDeleted() );
+    QVERIFY( task->findSchedule( id ) );
+    QCOMPARE( task->startTime( id ), start );
+    QCOMPARE( task->endTime( id ), end );
+    QCOMPARE( task->findSchedule( id )->appointments().count(), appointments );
+    QCOMPARE( resource->plannedEffortCostPrDay( start.date(), end.date(), id ).totalEffort(), effort );
+
+    delete project;
+}
+
+void ProjectTester::loadSchedulesOnDemand()
+{
+    Project *project = ProjectGenerator::createProject( 20, 2, 1 );
+    ScheduleManager *sm1 = ProjectGenerator::createScheduleManager( project, "S1" );
+    project->calculate( *sm1 );
+    sm1->setBaselined( true );
+    ScheduleManager *sm2 = ProjectGenerator::createScheduleManager( project, "S2" );
+    project->calculate( *sm2 );
+    const long id1 = sm1->expected()->id();
+    const long id2 = sm2->expected()->id();
+    Task *task = project->allTasks().last();
+    const DateTime start = task->startTime( id2 );
+
+    QDomDocument doc( "plan" );
+    QDomElement plan = doc.createElement( "plan" );
+    doc.appendChild( plan );
+    project->save( plan );
+    delete project;
+
+    KoXmlDocument xdoc;
+    QVERIFY( xdoc.setContent( doc.toString() ) );
+    KoXmlElement pe = xdoc.documentElement().namedItem( "project" ).toElement();
+    QVERIFY( ! pe.isNull() );
+
+    project = new Project();
+    XMLLoaderObject status;
+    status.setProject( project );
+    status.setVersion( PLAN_FILE_SYNTAX_VERSION );
+    status.setLoadSchedulesOnDemand( true );
+    QVERIFY( project->load( pe, status ) );
+
+    task = static_cast<Task*>( project->findNode( task->id() ) );
+    QVERIFY( task );
+    sm1 = project->scheduleManager( id1 );
+    sm2 = project->scheduleManager( id2 );
+    QVERIFY( sm1 && sm2 );
+
+    // The baselined schedule is loaded, the other is a stub
+    QVERIFY( ! sm1->expected()->isReleased() );
+    QVERIFY( task->findSchedule( id1 ) );
+    QVERIFY( sm2->expected()->isReleased() );
+    QVERIFY( ! task->schedules().contains( id2 ) );
+    QCOMPARE( sm2->expected()->name(), QString( "S2" ) );
+
+    // A stub is still saved in full, without loading it
+    QDomDocument doc2( "plan" );
+    QDomElement plan2 = doc2.createElement( "plan" );
+    doc2.appendChild( plan2 );
+    project->save( plan2 );
+    QVERIFY( sm2->expected()->isReleased() );
+
+    QBuffer buffer;
+    buffer.open( QIODevice::WriteOnly );
+    KoXmlWriter writer( &buffer );
+    writer.startDocument( "plan" );
+    writer.startElement( "plan" );
+    project->save( writer );
+    writer.endElement();
+    writer.endDocument();
+    buffer.close();
+    QVERIFY( sm2->expected()->isReleased() );
+
+    foreach ( const QByteArray &data, QList<QByteArray>() << doc2.toByteArray() << buffer.data() ) {
+        KoXmlDocument xdoc2;
+        QVERIFY( xdoc2.setContent( data ) );
+        Project p2;
+        XMLLoaderObject status2;
+        status2.setProject( &p2 );
+        status2.setVersion( PLAN_FILE_SYNTAX_VERSION );
+        QVERIFY( p2.load( xdoc2.documentElement().namedItem( "project" ).toElement(), status2 ) );
+        Node *t2 = p2.findNode( task->id() );
+        QVERIFY( t2 );
+        QCOMPARE( t2->startTime( id2 ), start );
+        QVERIFY( ! t2->appointments( id2 ).isEmpty() );
+    }
+
+    // and loaded when it is used
+    QCOMPARE( task->startTime( id2 ), start );
+    QVERIFY( ! sm2->expected()->isReleased() );
+    QVERIFY( task->schedules().contains( id2 ) );
+    QVERIFY( ! task->appointments( id2 ).isEmpty() );
+
+    // or when it is made current
+    QVERIFY( project->releaseSchedule( sm2->expected() ) );
+    project->setCurrentSchedule( id2 );
+    QVERIFY( ! sm2->expected()->isReleased() );
+    QCOMPARE( task->startTime( id2 ), start );
+
+    delete project;
+}
+
 } //namespace KPlato
 
 QTEST_GUILESS_MAIN( KPlato::ProjectTester )
@@ -42,6 +42,7 @@ private Q_SLOTS:
     void testTakeTask();
     void testTaskAddCmd();
     void testTaskDeleteCmd();
+    void testWbsCode();
 
     void schedule();
     void scheduleFullday();
@@ -73,6 +74,12 @@ private Q_SLOTS:
     void startStart();
 
     void scheduleTimeZone();
+
+    void streamingSave();
+    void streamingSaveMultiLine();
+
+    void releaseSchedule();
+    void loadSchedulesOnDemand();
     
 private:
     Project *m_project;
@@ -603,6 +603,58 @@ void ResourceTester::required()
     }
 }
 
+void ResourceTester::requestDuration()
+{
+    Project p;
+    p.setId( p.uniqueNodeId() );
+    p.registerNodeId( &p );
+    DateTime start( QDate( 2017, 1, 2 ), QTime( 8, 0, 0 ) );
+    p.setConstraintStartTime( start.addDays( -1 ) );
+    p.setConstraintEndTime( start.addDays( 30 ) );
+
+    Calendar *c = new Calendar( "Test" );
+    c->setDefault( true );
+    QTime t1( 8, 0, 0 );
+    QTime t2( 16, 0, 0 );
+    for ( int i = 1; i <= 7; ++i ) {
+        CalendarDay *d = c->weekday( i );
+        d->setState( CalendarDay::Working );
+        d->addInterval( t1, t1.msecsTo( t2 ) );
+    }
+    p.addCalendar( c );
+
+    ResourceGroup *g = new ResourceGroup();
+    p.addResourceGroup( g );
+    Resource *r1 = new Resource();
+    p.addResource( g, r1 );
+    Resource *r2 = new Resource();
+    p.addResource( g, r2 );
+
+    Task *t = p.createTask();
+    p.addTask( t, &p );
+    ResourceGroupRequest *gr = new ResourceGroupRequest( g );
+    t->addRequest( gr );
+    ResourceRequest *rr1 = new ResourceRequest( r1, 100 );
+    gr->addResourceRequest( rr1 );
+    ResourceRequest *rr2 = new ResourceRequest( r2, 100 );
+    gr->addResourceRequest( rr2 );
+
+    ResourceRequestCollection &requests = t->requests();
+    // two resources working full time
+    QCOMPARE( requests.duration( start, Duration( 0, 12, 0 ), 0 ), Duration( 0, 6, 0 ) );
+    QCOMPARE( requests.duration( start, Duration( 0, 13, 0 ), 0 ), Duration( 0, 6, 30 ) );
+    // backward from end of working day
+    QCOMPARE( requests.duration( DateTime( start.date(), t2 ), Duration( 0, 12, 0 ), 0, true ), Duration( 0, 6, 0 ) );
+    // into the next day: 16 hours the first day, 4 the next
+    QCOMPARE( requests.duration( start, Duration( 0, 20, 0 ), 0 ), Duration( 1, 2, 0 ) );
+    QCOMPARE( requests.duration( DateTime( start.date().addDays( 1 ), t2 ), Duration( 0, 20, 0 ), 0, true ), Duration( 1, 2, 0 ) );
+
+    // one resource half time
+    rr2->setUnits( 50 );
+    QCOMPARE( requests.duration( start, Duration( 0, 12, 0 ), 0 ), Duration( 0, 8, 0 ) );
+    QCOMPARE( requests.duration( start, Duration( 0, 3, 0 ), 0 ), Duration( 0, 2, 0 ) );
+}
+
 } //namespace KPlato
 
 QTEST_GUILESS_MAIN( KPlato::ResourceTester )
@@ -33,6 +33,7 @@ private Q_SLOTS:
     void testSingleDay();
     void team();
     void required();
+    void requestDuration();
 };
 
 } //namespace KPlato
@@ -0,0 +1,162 @@
+/* This file is part of the KDE project
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+// clazy:excludeall=qstring-arg
+#include "WorkPackageMergerTester.h"
+
+#include "kptworkpackagemerger.h"
+#include "kptpackage.h"
+#include "kptcommand.h"
+#include "kptproject.h"
+#include "kptresource.h"
+#include "kpttask.h"
+#include "kptglobal.h"
+
+#include "ProjectGenerator.h"
+
+#include <KoXmlReader.h>
+
+#include <QDomDocument>
+#include <QTest>
+
+namespace KPlato
+{
+
+void WorkPackageMergerTester::init()
+{
+    m_project = ProjectGenerator::createProject( 2, 1, 1 );
+    m_manager = ProjectGenerator::createScheduleManager( m_project, "Test" );
+    m_project->calculate( *m_manager );
+    QVERIFY( m_manager->isScheduled() );
+    m_task = static_cast<Task*>( m_project->childNode( 0 )->childNode( 0 ) );
+}
+
+void WorkPackageMergerTester::cleanup()
+{
+    delete m_project;
+}
+
+Package *WorkPackageMergerTester::createPackage( WorkPackageMerger &merger, const Task *task, const Resource *owner, const QDateTime &timeTag )
+{
+    // Same format as MainDocument::saveWorkPackageXML()
+    QDomDocument document( "plan" );
+    QDomElement doc = document.createElement( "planwork" );
+    doc.setAttribute( "editor", "Plan" );
+    doc.setAttribute( "mime", "application/x-vnd.kde.plan.work" );
+    doc.setAttribute( "version", PLANWORK_FILE_SYNTAX_VERSION );
+    doc.setAttribute( "plan-version", PLAN_FILE_SYNTAX_VERSION );
+    document.appendChild( doc );
+
+    QDomElement wp = document.createElement( "workpackage" );
+    wp.setAttribute( "owner", owner->name() );
+    wp.setAttribute( "owner-id", owner->id() );
+    wp.setAttribute( "time-tag", timeTag.toString( Qt::ISODate ) );
+    QDomElement settings = document.createElement( "settings" );
+    settings.setAttribute( "used-effort", 0 );
+    settings.setAttribute( "progress", 1 );
+    settings.setAttribute( "documents", 0 );
+    wp.appendChild( settings );
+    doc.appendChild( wp );
+
+    m_project->saveWorkPackageXML( doc, task, m_manager->scheduleId() );
+
+    KoXmlDocument xml;
+    if ( ! xml.setContent( document.toString() ) ) {
+        return 0;
+    }
+    return merger.loadWorkPackageXML( xml );
+}
+
+void WorkPackageMergerTester::deletePackage( Package *package )
+{
+    if ( package ) {
+        delete package->project;
+        delete package;
+    }
+}
+
+void WorkPackageMergerTester::merge()
+{
+    Resource *owner = m_project->resourceList().first();
+    const QDateTime timeTag( QDate( 2017, 1, 3 ), QTime( 12, 0, 0 ) );
+    WorkPackageMerger merger( *m_project );
+
+    Package *package = createPackage( merger, m_task, owner, timeTag );
+    QVERIFY2( package, merger.errorMessage().toLocal8Bit() );
+    QCOMPARE( package->toTask, m_task );
+    QCOMPARE( package->ownerId, owner->id() );
+    QCOMPARE( package->timeTag, timeTag );
+    QVERIFY( package->settings.progress );
+    QVERIFY( ! merger.isMerged( package ) );
+
+    // The progress reported by the owner
+    Completion &completion = package->task->completion();
+    const DateTime started( QDate( 2017, 1, 2 ), QTime( 8, 0, 0 ) );
+    completion.setStarted( true );
+    completion.setStartTime( started );
+    completion.addEntry( started.date(), new Completion::Entry( 50, Duration::zeroDuration, Duration::zeroDuration ) );
+
+    MacroCommand *cmd = merger.mergeWorkPackage( package );
+    QVERIFY2( cmd, merger.errorMessage().toLocal8Bit() );
+    QVERIFY( ! merger.nothingToSave() );
+    cmd->redo();
+
+    QVERIFY( m_task->completion().isStarted() );
+    QCOMPARE( m_task->completion().startTime(), started );
+    QCOMPARE( m_task->completion().percentFinished(), 50 );
+    QCOMPARE( m_task->workPackageLog().count(), 1 );
+    QVERIFY( merger.isMerged( package ) );
+    deletePackage( package );
+
+    // The same package again is already merged and would be skipped
+    package = createPackage( merger, m_task, owner, timeTag );
+    QVERIFY( package );
+    QVERIFY( merger.isMerged( package ) );
+    deletePackage( package );
+
+    // A newer package from the same owner is not
+    package = createPackage( merger, m_task, owner, timeTag.addSecs( 3600 ) );
+    QVERIFY( package );
+    QVERIFY( ! merger.isMerged( package ) );
+    deletePackage( package );
+
+    // the merged work package is owned by the task
+    delete cmd;
+}
+
+void WorkPackageMergerTester::ownerNotResource()
+{
+    Resource stranger;
+    stranger.setId( "stranger-id" );
+    stranger.setName( "Stranger" );
+    WorkPackageMerger merger( *m_project );
+
+    Package *package = createPackage( merger, m_task, &stranger, QDateTime( QDate( 2017, 1, 3 ), QTime( 12, 0, 0 ) ) );
+    QVERIFY2( package, merger.errorMessage().toLocal8Bit() );
+    QCOMPARE( package->toTask, m_task );
+
+    MacroCommand *cmd = merger.mergeWorkPackage( package );
+    QVERIFY( cmd == 0 );
+    QVERIFY( merger.errorMessage().contains( "Stranger" ) );
+    QVERIFY( ! merger.isMerged( package ) );
+    QVERIFY( m_task->workPackageLog().isEmpty() );
+    deletePackage( package );
+}
+
+} //namespace KPlato
+
+QTEST_GUILESS_MAIN( KPlato::WorkPackageMergerTester )
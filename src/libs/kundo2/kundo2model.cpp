@@ -59,6 +59,9 @@
 // clazy:excludeall=qstring-arg
 #include "kundo2model.h"
 #include <klocalizedstring.h>
+
+#include <QLocale>
+
 KUndo2Model::KUndo2Model(QObject *parent)
     : QAbstractItemModel(parent)
 {
@@ -189,6 +192,20 @@ QVariant KUndo2Model::data(const QModelIndex &index, int role) const
     } else if (role == Qt::DecorationRole) {
         if (index.row() == m_stack->cleanIndex() && !m_clean_icon.isNull())
             return m_clean_icon;
+    } else if (role == Qt::ToolTipRole) {
+        QLocale locale;
+        if (index.row() == 0) {
+            if (m_stack->memoryLimit() > 0) {
+                return i18nc("@info:tooltip", "Undo memory: %1 MiB of %2 MiB",
+                             locale.toString(m_stack->memoryUsage() / 1048576.0, 'f', 1),
+                             locale.toString(m_stack->memoryLimit() / 1048576.0, 'f', 1));
+            }
+            return i18nc("@info:tooltip", "Undo memory: %1 MiB", locale.toString(m_stack->memoryUsage() / 1048576.0, 'f', 1));
+        }
+        const KUndo2Command *cmd = m_stack->command(index.row() - 1);
+        if (cmd && cmd->memoryUsage() > 0) {
+            return i18nc("@info:tooltip", "Memory: %1 MiB", locale.toString(cmd->memoryUsage() / 1048576.0, 'f', 1));
+        }
     }
 
     return QVariant();
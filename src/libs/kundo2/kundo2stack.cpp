@@ -332,6 +332,45 @@ const KUndo2Command *KUndo2Command::child(int index) const
     return d->child_list.at(index);
 }
 
+/*!
+    Returns the number of bytes this command keeps alive to be able to undo or redo,
+    not counting the memory used by the document itself.
+
+    The default implementation returns the sum of the child commands.
+    Commands that retain large amounts of data should reimplement this.
+
+    \sa releaseMemory(), KUndo2QStack::setMemoryLimit()
+*/
+
+qint64 KUndo2Command::memoryUsage() const
+{
+    qint64 size = 0;
+    foreach (const KUndo2Command *cmd, d->child_list) {
+        size += cmd->memoryUsage();
+    }
+    return size;
+}
+
+/*!
+    Called by the stack when it exceeds its memory limit.
+    The command should move the data it retains into a more compact form,
+    and restore it when it is undone or redone.
+    Returns true if any memory was released.
+
+    The default implementation asks the child commands.
+
+    \sa memoryUsage(), KUndo2QStack::setMemoryLimit()
+*/
+
+bool KUndo2Command::releaseMemory()
+{
+    bool released = false;
+    foreach (KUndo2Command *cmd, d->child_list) {
+        released = cmd->releaseMemory() || released;
+    }
+    return released;
+}
+
 bool KUndo2Command::hasParent()
 {
     return m_hasParent;
@@ -552,6 +591,41 @@ void KUndo2QStack::setIndex(int idx, bool clean)
     bool is_clean = m_index == m_clean_index;
     if (is_clean != was_clean)
         emit cleanChanged(is_clean);
+
+    checkMemoryLimit();
+}
+
+/*!
+    Asks the commands furthest away from the current index to release memory
+    until the stack is within its memory limit.
+    The commands next in line for undo and redo are left alone.
+*/
+
+void KUndo2QStack::checkMemoryLimit()
+{
+    qint64 usage = memoryUsage();
+    if (m_memory_limit > 0 && usage > m_memory_limit) {
+        QList<KUndo2Command*> candidates;
+        for (int i = 0; i < m_index - 1; ++i) {
+            candidates << m_command_list.at(i);
+        }
+        for (int i = m_command_list.count() - 1; i > m_index; --i) {
+            candidates << m_command_list.at(i);
+        }
+        foreach (KUndo2Command *cmd, candidates) {
+            qint64 before = cmd->memoryUsage();
+            if (before > 0 && cmd->releaseMemory()) {
+                usage -= before - cmd->memoryUsage();
+                if (usage <= m_memory_limit) {
+                    break;
+                }
+            }
+        }
+    }
+    if (usage != m_memory_usage) {
+        m_memory_usage = usage;
+        emit memoryUsageChanged(usage);
+    }
 }
 
 void KUndo2QStack::purgeRedoState()
@@ -618,7 +692,7 @@ bool KUndo2QStack::checkUndoLimit()
 */
 
 KUndo2QStack::KUndo2QStack(QObject *parent)
-    : QObject(parent), m_index(0), m_clean_index(0), m_group(0), m_undo_limit(0), m_useCumulativeUndoRedo(false), m_lastMergedSetCount(0), m_lastMergedIndex(0)
+    : QObject(parent), m_index(0), m_clean_index(0), m_group(0), m_undo_limit(0), m_memory_limit(0), m_memory_usage(0), m_useCumulativeUndoRedo(false), m_lastMergedSetCount(0), m_lastMergedIndex(0)
 {
     setTimeT1(5);
     setTimeT2(1);
@@ -682,6 +756,8 @@ void KUndo2QStack::clear()
 
     if (!was_clean)
         emit cleanChanged(true);
+
+    checkMemoryLimit();
 }
 
 /*!
@@ -1258,6 +1334,40 @@ void KUndo2QStack::setUndoLimit(int limit)
     emit undoLimitChanged(m_undo_limit);
 }
 
+/*!
+    Sets the maximum number of bytes the commands on the stack may retain to \a bytes.
+
+    When the commands use more memory, the commands furthest away from the current
+    index are asked to release memory, see KUndo2Command::releaseMemory().
+    The default value is 0, which means that there is no limit.
+*/
+
+void KUndo2QStack::setMemoryLimit(qint64 bytes)
+{
+    m_memory_limit = bytes;
+    checkMemoryLimit();
+}
+
+qint64 KUndo2QStack::memoryLimit() const
+{
+    return m_memory_limit;
+}
+
+/*!
+    Returns the number of bytes retained by the commands on the stack.
+
+    \sa KUndo2Command::memoryUsage()
+*/
+
+qint64 KUndo2QStack::memoryUsage() const
+{
+    qint64 size = 0;
+    foreach (const KUndo2Command *cmd, m_command_list) {
+        size += cmd->memoryUsage();
+    }
+    return size;
+}
+
 int KUndo2QStack::undoLimit() const
 {
     return m_undo_limit;
@@ -118,6 +118,9 @@ public:
     virtual void undoMergedCommands();
     virtual void redoMergedCommands();
 
+    virtual qint64 memoryUsage() const;
+    virtual bool releaseMemory();
+
     /**
      * \return user-defined object associated with the command
      *
@@ -155,6 +158,7 @@ class KUNDO2_EXPORT KUndo2QStack : public QObject
 //    Q_DECLARE_PRIVATE(KUndo2QStack)
     Q_PROPERTY(bool active READ isActive WRITE setActive NOTIFY activeChanged)
     Q_PROPERTY(int undoLimit READ undoLimit WRITE setUndoLimit NOTIFY undoLimitChanged)
+    Q_PROPERTY(qint64 memoryLimit READ memoryLimit WRITE setMemoryLimit)
 
 public:
     explicit KUndo2QStack(QObject *parent = 0);
@@ -188,6 +192,10 @@ public:
     void setUndoLimit(int limit);
     int undoLimit() const;
 
+    void setMemoryLimit(qint64 bytes);
+    qint64 memoryLimit() const;
+    qint64 memoryUsage() const;
+
     const KUndo2Command *command(int index) const;
 
     void setUseCumulativeUndoRedo(bool value);
@@ -218,6 +226,7 @@ Q_SIGNALS:
     void redoTextChanged(const QString &redoActionText);
     void activeChanged(bool);
     void undoLimitChanged(int);
+    void memoryUsageChanged(qint64 bytes);
 
 protected:
     virtual void notifySetIndexChangedOneCommand();
@@ -230,6 +239,8 @@ private:
     int m_clean_index;
     KUndo2Group *m_group;
     int m_undo_limit;
+    qint64 m_memory_limit;
+    qint64 m_memory_usage;
     bool m_useCumulativeUndoRedo;
     double m_timeT1;
     double m_timeT2;
@@ -240,6 +251,7 @@ private:
     // also from QUndoStackPrivate
     void setIndex(int idx, bool clean);
     bool checkUndoLimit();
+    void checkMemoryLimit();
 
     Q_DISABLE_COPY(KUndo2QStack)
     friend class KUndo2Group;
@@ -69,7 +69,17 @@
 #include <QDir>
 #include <QFileInfo>
 #include <QPainter>
+#include <QImage>
 #include <QTimer>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QPointer>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QSemaphore>
+#include <QQueue>
+#include <QScopedPointer>
 #ifndef QT_NO_DBUS
 #include <KJobWidgets>
 #include <QDBusConnection>
@@ -129,6 +139,218 @@ public:
 
     }
 };
+
+/**
+ * Writes an autosave file in a worker thread.
+ * The document is serialized into an in-memory store on the gui thread,
+ * the job only writes the finished archive to disk.
+ * The file is written atomically, so an existing autosave file is
+ * only replaced if the new one is complete.
+ */
+class AutoSaveJob : public QRunnable {
+public:
+    AutoSaveJob(KoDocument *document, const QString &fileName, const QByteArray &data)
+        : m_document(document)
+        , m_fileName(fileName)
+        , m_data(data)
+    {
+    }
+
+    void run() {
+        QString error;
+        bool ok = false;
+        setProgress(60);
+        QSaveFile file(m_fileName);
+        if (!file.open(QIODevice::WriteOnly)) {
+            error = i18n("Could not create the file for saving");
+        } else if (file.write(m_data) != m_data.size()) {
+            error = i18n("Not able to write '%1'. Partition full?", m_fileName);
+            file.cancelWriting();
+        } else {
+            ok = file.commit();
+        }
+        m_data.clear();
+        setProgress(100);
+        QMetaObject::invokeMethod(m_document, "slotAutoSaveFinished", Qt::QueuedConnection, Q_ARG(bool, ok), Q_ARG(QString, error));
+    }
+
+private:
+    void setProgress(int value) {
+        QMetaObject::invokeMethod(m_document, "sigProgress", Qt::QueuedConnection, Q_ARG(int, value));
+    }
+
+private:
+    KoDocument *m_document;
+    QString m_fileName;
+    QByteArray m_data;
+};
+
+/**
+ * Encodes the preview image to png in a worker thread.
+ */
+class PreviewJob : public QRunnable {
+public:
+    PreviewJob(KoDocument *document, int revision, const QImage &image)
+        : m_document(document)
+        , m_revision(revision)
+        , m_image(image)
+    {
+    }
+
+    void run() {
+        QByteArray png;
+        QBuffer buffer(&png);
+        buffer.open(QIODevice::WriteOnly);
+        if (!m_image.save(&buffer, "PNG")) {
+            png.clear();
+        }
+        QMetaObject::invokeMethod(m_document, "slotPreviewEncoded", Qt::QueuedConnection, Q_ARG(int, m_revision), Q_ARG(QByteArray, png));
+    }
+
+private:
+    KoDocument *m_document;
+    int m_revision;
+    QImage m_image;
+};
+
+/**
+ * A pipe from a thread that decompresses a store entry to the thread that parses it.
+ * Reading blocks until data is available or the writer has finished,
+ * writing blocks while the pipe holds more than a limited amount of data.
+ */
+class LoadPipe : public QIODevice {
+public:
+    LoadPipe()
+        : m_size(0)
+        , m_finished(false)
+        , m_aborted(false)
+    {
+        open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+    }
+
+    bool isSequential() const {
+        return true;
+    }
+
+    bool atEnd() const {
+        QMutexLocker locker(&m_mutex);
+        return m_finished && m_chunks.isEmpty();
+    }
+
+    qint64 bytesAvailable() const {
+        QMutexLocker locker(&m_mutex);
+        return m_size;
+    }
+
+    /// Add @p data for the reader, returns false if the reader has aborted
+    bool put(const QByteArray &data) {
+        QMutexLocker locker(&m_mutex);
+        while (m_size > 1024 * 1024 && !m_aborted) {
+            m_notFull.wait(&m_mutex);
+        }
+        if (m_aborted) {
+            return false;
+        }
+        m_chunks.enqueue(data);
+        m_size += data.size();
+        m_notEmpty.wakeAll();
+        return true;
+    }
+
+    /// Called by the writer when there is no more data
+    void finish() {
+        QMutexLocker locker(&m_mutex);
+        m_finished = true;
+        m_notEmpty.wakeAll();
+    }
+
+    /// Called by the reader when it does not want more data
+    void abort() {
+        QMutexLocker locker(&m_mutex);
+        m_aborted = true;
+        m_chunks.clear();
+        m_size = 0;
+        m_notFull.wakeAll();
+    }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) {
+        QMutexLocker locker(&m_mutex);
+        while (m_chunks.isEmpty() && !m_finished) {
+            m_notEmpty.wait(&m_mutex);
+        }
+        qint64 n = 0;
+        while (n < maxSize && !m_chunks.isEmpty()) {
+            QByteArray &chunk = m_chunks.head();
+            const qint64 count = qMin<qint64>(maxSize - n, chunk.size());
+            memcpy(data + n, chunk.constData(), count);
+            n += count;
+            if (count == chunk.size()) {
+                m_chunks.dequeue();
+            } else {
+                chunk.remove(0, count);
+            }
+        }
+        m_size -= n;
+        m_notFull.wakeAll();
+        return n == 0 && m_finished ? -1 : n;
+    }
+
+    qint64 writeData(const char *, qint64) {
+        return -1;
+    }
+
+private:
+    mutable QMutex m_mutex;
+    QWaitCondition m_notEmpty;
+    QWaitCondition m_notFull;
+    QQueue<QByteArray> m_chunks;
+    qint64 m_size;
+    bool m_finished;
+    bool m_aborted;
+};
+
+/**
+ * Reads the entries of an old style (maindoc.xml) store in a worker thread.
+ *
+ * The main document is decompressed into a LoadPipe, so it can be parsed while it is read.
+ * Then the document info is read, and storeReleased is released since the store is not used anymore.
+ * The document info is parsed while the gui thread builds the document.
+ */
+class StoreLoadJob : public QRunnable {
+public:
+    StoreLoadJob(KoStore *store, LoadPipe *pipe)
+        : infoFound(false)
+        , m_store(store)
+        , m_pipe(pipe)
+    {
+        setAutoDelete(false);
+    }
+
+    void run() {
+        if (m_store->open("root")) {
+            QIODevice *device = m_store->device();
+            QByteArray chunk;
+            do {
+                chunk = device->read(64 * 1024);
+            } while (!chunk.isEmpty() && m_pipe->put(chunk));
+            m_store->close();
+        }
+        m_pipe->finish();
+
+        // Only the bytes are read here, KoXml is not thread safe so the info is parsed by the caller
+        infoFound = m_store->hasFile("documentinfo.xml") && m_store->extractFile("documentinfo.xml", infoData);
+        storeReleased.release();
+    }
+
+    QByteArray infoData;
+    bool infoFound;
+    QSemaphore storeReleased;
+
+private:
+    KoStore *m_store;
+    LoadPipe *m_pipe;
+};
 }
 
 
@@ -158,6 +380,9 @@ public:
         password(QString()),
         modifiedAfterAutosave(false),
         autosaving(false),
+        backgroundAutosaving(false),
+        autoSavePreview(true),
+        previewPngRevision(-1),
         shouldCheckAutoSaveFile(true),
         autoErrorHandlingEnabled(true),
         backupFile(true),
@@ -180,6 +405,11 @@ public:
         m_bTemp = false;
         m_bAutoDetectedMime = false;
 
+        autoSavePool.setMaxThreadCount(1);
+        previewPool.setMaxThreadCount(1);
+        previewTimer.setSingleShot(true);
+        previewTimer.setInterval(1000);
+
         confirmNonNativeSave[0] = true;
         confirmNonNativeSave[1] = true;
         if (QLocale().measurementSystem() == QLocale::ImperialSystem) {
@@ -219,6 +449,14 @@ public:
     int autoSaveDelay; // in seconds, 0 to disable.
     bool modifiedAfterAutosave;
     bool autosaving;
+    bool backgroundAutosaving; // an autosave file is being written by autoSavePool
+    QThreadPool autoSavePool;
+    QPointer<KoMainWindow> autoSaveWindow; // receives progress while autosaving in the background
+    bool autoSavePreview; // include preview.png in autosave files
+    QTimer previewTimer;
+    QThreadPool previewPool;
+    QByteArray previewPng; // cached preview.png
+    int previewPngRevision; // the previewRevision() of previewPng, -1 if none
     bool shouldCheckAutoSaveFile; // usually true
     bool autoErrorHandlingEnabled; // usually true
     bool backupFile;
@@ -445,6 +683,7 @@ KoDocument::KoDocument(KoPart *parent, KUndo2Stack *undoStack)
     d->filterManager = new KoFilterManager(this, d->progressUpdater);
 
     connect(&d->autoSaveTimer, &QTimer::timeout, this, &KoDocument::slotAutoSave);
+    connect(&d->previewTimer, &QTimer::timeout, this, &KoDocument::slotRenderPreview);
     setAutoSave(defaultAutoSave());
 
     setObjectName(newObjectName());
@@ -462,15 +701,24 @@ KoDocument::KoDocument(KoPart *parent, KUndo2Stack *undoStack)
 
     KConfigGroup cfgGrp(d->parentPart->componentData().config(), "Undo");
     d->undoStack->setUndoLimit(cfgGrp.readEntry("UndoLimit", 1000));
+    // memory retained by the commands, in MiB
+    d->undoStack->setMemoryLimit(cfgGrp.readEntry("UndoMemoryLimit", 256) * Q_INT64_C(1024 * 1024));
 
     connect(d->undoStack, &KUndo2QStack::indexChanged, this, &KoDocument::slotUndoStackIndexChanged);
 
+    // the preview is not needed to recover a document, leaving it out makes autosaving faster
+    KConfigGroup autoSaveGroup(d->parentPart->componentData().config(), "Autosave");
+    d->autoSavePreview = autoSaveGroup.readEntry("AutoSavePreview", true);
+
 }
 
 KoDocument::~KoDocument()
 {
     d->autoSaveTimer.disconnect(this);
     d->autoSaveTimer.stop();
+    d->autoSavePool.waitForDone();
+    d->previewTimer.stop();
+    d->previewPool.waitForDone();
     d->parentPart->deleteLater();
 
     delete d->filterManager;
@@ -718,6 +966,10 @@ void KoDocument::slotAutoSave()
         if (d->specialOutputFlag == SaveEncrypted && d->password.isNull()) {
             // That advice should also fix this error from occurring again
             emit statusBarMessage(i18n("The password of this encrypted document is not known. Autosave aborted! Please save your work manually."));
+        } else if (d->backgroundAutosaving) {
+            // still writing the previous autosave, try again next time
+        } else if (d->specialOutputFlag == 0 && (d->outputMimeType.isEmpty() || d->outputMimeType == nativeFormatMimeType())) {
+            startBackgroundAutoSave();
         } else {
             connect(this, &KoDocument::sigProgress, d->parentPart->currentMainwindow(), &KoMainWindow::slotProgress);
             emit statusBarMessage(i18n("Autosaving..."));
@@ -738,6 +990,63 @@ void KoDocument::slotAutoSave()
     }
 }
 
+void KoDocument::startBackgroundAutoSave()
+{
+    d->autoSaveWindow = d->parentPart->currentMainwindow();
+    if (d->autoSaveWindow) {
+        connect(this, &KoDocument::sigProgress, d->autoSaveWindow.data(), &KoMainWindow::slotProgress);
+    }
+    emit statusBarMessage(i18n("Autosaving..."));
+    emit sigProgress(0);
+
+    // The project cannot be copied for another thread, so it is serialized here,
+    // through the same saveNativeFormatCalligra() as a normal save.
+    // The store is kept in memory and the AutoSaveJob writes it to disk.
+    QByteArray data;
+    QBuffer buffer(&data);
+    d->autosaving = true;
+    KoStore *store = KoStore::createStore(&buffer, KoStore::Write, d->outputMimeType, KoStore::Zip);
+    // autosave favours speed over size, store the files uncompressed
+    store->setCompressionLevel(0);
+    bool ok = false;
+    if (store->bad()) {
+        delete store;
+    } else {
+        ok = saveNativeFormatCalligra(store); // deletes the store
+    }
+    d->autosaving = false;
+    if (!ok) {
+        slotAutoSaveFinished(false, d->lastErrorMessage);
+        return;
+    }
+    emit sigProgress(50);
+
+    d->backgroundAutosaving = true;
+    d->modifiedAfterAutosave = false;
+    d->autoSaveTimer.stop(); // until the next change
+    d->autoSavePool.start(new AutoSaveJob(this, autoSaveFile(localFilePath()), data));
+}
+
+void KoDocument::slotAutoSaveFinished(bool success, const QString &errorMessage)
+{
+    d->backgroundAutosaving = false;
+    emit sigProgress(-1);
+    emit clearStatusBarMessage();
+    if (d->autoSaveWindow) {
+        disconnect(this, &KoDocument::sigProgress, d->autoSaveWindow.data(), &KoMainWindow::slotProgress);
+    }
+    d->autoSaveWindow = 0;
+    if (!success) {
+        warnMain << "Autosave failed:" << errorMessage;
+        // try again later
+        d->modifiedAfterAutosave = true;
+        setAutoSave(d->autoSaveDelay);
+        if (!d->disregardAutosaveFailure) {
+            emit statusBarMessage(i18n("Error during autosave! Partition full?"));
+        }
+    }
+}
+
 void KoDocument::setReadWrite(bool readwrite)
 {
     d->readwrite = readwrite;
@@ -972,7 +1281,7 @@ bool KoDocument::saveNativeFormatCalligra(KoStore *store)
         (void)store->close();
     }
 
-    if (store->open("preview.png")) {
+    if ((!d->autosaving || d->autoSavePreview) && store->open("preview.png")) {
         // ### TODO: missing error checking (The partition could be full!)
         savePreview(store);
         (void)store->close();
@@ -994,10 +1303,22 @@ bool KoDocument::saveNativeFormatCalligra(KoStore *store)
 
 bool KoDocument::saveToStream(QIODevice *dev)
 {
+    dev->open(QIODevice::WriteOnly);
+    {
+        KoXmlWriter writer(dev);
+        if (saveXMLStream(writer)) {
+            QFileDevice *file = qobject_cast<QFileDevice*>(dev);
+            return !file || file->error() == QFileDevice::NoError;
+        }
+    }
+    if (dev->pos() > 0) {
+        // the stream writer has written something, don't try to recover
+        warnMain << "saveXMLStream failed after writing" << dev->pos() << "bytes";
+        return false;
+    }
     QDomDocument doc = saveXML();
     // Save to buffer
     QByteArray s = doc.toByteArray(); // utf8 already
-    dev->open(QIODevice::WriteOnly);
     int nwritten = dev->write(s.data(), s.size());
     if (nwritten != (int)s.size())
         warnMain << "wrote " << nwritten << "- expected" <<  s.size();
@@ -1092,17 +1413,82 @@ bool KoDocument::saveOasisPreview(KoStore *store, KoXmlWriter *manifestWriter)
 
 bool KoDocument::savePreview(KoStore *store)
 {
-    QPixmap pix = generatePreview(QSize(256, 256));
-    const QImage preview(pix.toImage().convertToFormat(QImage::Format_ARGB32, Qt::ColorOnly));
+    const QByteArray png = previewData();
+    if (png.isEmpty())
+        return false;
     KoStoreDevice io(store);
     if (!io.open(QIODevice::WriteOnly))
         return false;
-    if (! preview.save(&io, "PNG"))     // ### TODO What is -9 in quality terms?
+    if (io.write(png) != png.size())
         return false;
     io.close();
     return true;
 }
 
+QImage KoDocument::previewImage()
+{
+    QPixmap pix = generatePreview(QSize(256, 256));
+    return pix.toImage().convertToFormat(QImage::Format_ARGB32, Qt::ColorOnly);
+}
+
+QByteArray KoDocument::previewData()
+{
+    const int revision = previewRevision();
+    if (revision >= 0 && revision == d->previewPngRevision) {
+        return d->previewPng;
+    }
+    QByteArray png;
+    QBuffer buffer(&png);
+    buffer.open(QIODevice::WriteOnly);
+    if (!previewImage().save(&buffer, "PNG")) {    // ### TODO What is -9 in quality terms?
+        return QByteArray();
+    }
+    if (revision >= 0) {
+        d->previewPng = png;
+        d->previewPngRevision = revision;
+    }
+    return png;
+}
+
+int KoDocument::previewRevision() const
+{
+    return -1;
+}
+
+void KoDocument::updatePreview()
+{
+    // compress bursts of changes into one rendering
+    d->previewTimer.start();
+}
+
+void KoDocument::slotRenderPreview()
+{
+    const int revision = previewRevision();
+    if (revision < 0 || revision == d->previewPngRevision) {
+        return;
+    }
+    // QPixmap can only be used in the gui thread, the encoding is done in the worker
+    d->previewPool.start(new PreviewJob(this, revision, previewImage()));
+}
+
+void KoDocument::slotPreviewEncoded(int revision, const QByteArray &png)
+{
+    if (!png.isEmpty() && revision == previewRevision()) {
+        d->previewPng = png;
+        d->previewPngRevision = revision;
+    }
+}
+
+void KoDocument::setAutoSavePreview(bool on)
+{
+    d->autoSavePreview = on;
+}
+
+bool KoDocument::autoSavePreview() const
+{
+    return d->autoSavePreview;
+}
+
 QPixmap KoDocument::generatePreview(const QSize& size)
 {
     qreal docWidth, docHeight;
@@ -1842,15 +2228,45 @@ bool KoDocument::loadNativeFormatFromStoreInternal(KoStore *store)
 
         oasis = false;
 
-        KoXmlDocument doc = KoXmlDocument(true);
+        // maindoc.xml is decompressed by a worker thread while it is parsed here,
+        // and documentinfo.xml is extracted by the worker while the document is built.
+        // The pool is declared last, so it waits for the job before the pipe is destroyed.
+        LoadPipe pipe;
+        QScopedPointer<StoreLoadJob> job(new StoreLoadJob(store, &pipe));
+        QThreadPool pool;
+        pool.start(job.data());
 
-        bool ok = oldLoadAndParse(store, "root", doc);
-        if (ok)
+        KoXmlDocument doc = KoXmlDocument(true);
+        QString errorMsg;
+        int errorLine, errorColumn;
+        bool ok = doc.setContent(&pipe, &errorMsg, &errorLine, &errorColumn);
+        pipe.abort();
+        job->storeReleased.acquire();
+        if (!ok) {
+            errorMain << "Parsing error in root! Aborting!" << endl
+            << " In line: " << errorLine << ", column: " << errorColumn << endl
+            << " Error message: " << errorMsg << endl;
+            d->lastErrorMessage = i18n("Parsing error in %1 at line %2, column %3\nError message: %4"
+                                       , QString("root")  , errorLine, errorColumn ,
+                                       QCoreApplication::translate("QXml", errorMsg.toUtf8(), 0));
+        } else {
+            debugMain << "File root loaded and parsed";
             ok = loadXML(doc, store);
+        }
+        pool.waitForDone();
         if (!ok) {
             QApplication::restoreOverrideCursor();
             return false;
         }
+        if (job->infoFound) {
+            KoXmlDocument info = KoXmlDocument(true);
+            if (info.setContent(job->infoData, false)) {
+                d->docInfo->load(info);
+            }
+        } else {
+            delete d->docInfo;
+            d->docInfo = new KoDocumentInfo(this);
+        }
 
     } else {
         errorMain << "ERROR: No maindoc.xml" << endl;
@@ -1865,11 +2281,8 @@ bool KoDocument::loadNativeFormatFromStoreInternal(KoStore *store)
         if (oasisStore.loadAndParse("meta.xml", metaDoc, d->lastErrorMessage)) {
             d->docInfo->loadOasis(metaDoc);
         }
-    } else if (!oasis && store->hasFile("documentinfo.xml")) {
-        KoXmlDocument doc = KoXmlDocument(true);
-        if (oldLoadAndParse(store, "documentinfo.xml", doc)) {
-            d->docInfo->load(doc);
-        }
+    } else if (!oasis) {
+        // loaded with maindoc.xml
     } else {
         //kDebug( 30003 ) <<"cannot open document info";
         delete d->docInfo;
@@ -2170,6 +2583,12 @@ QDomDocument KoDocument::saveXML()
     return QDomDocument();
 }
 
+bool KoDocument::saveXMLStream(KoXmlWriter &writer)
+{
+    Q_UNUSED(writer);
+    return false;
+}
+
 bool KoDocument::isNativeFormat(const QByteArray& mimetype) const
 {
     if (mimetype == nativeFormatMimeType())
@@ -2222,6 +2641,9 @@ bool KoDocument::isLoading() const
 
 void KoDocument::removeAutoSaveFiles()
 {
+    // Do not let a running autosave recreate the file
+    d->autoSavePool.waitForDone();
+
     // Eliminate any auto-save file
     QString asf = autoSaveFile(localFilePath());   // the one in the current dir
     if (QFile::exists(asf))
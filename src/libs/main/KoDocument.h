@@ -46,6 +46,7 @@ class KoUnit;
 class KoXmlWriter;
 
 class QDomDocument;
+class QImage;
 
 // MSVC seems to need to know the declaration of the classes
 // we pass references of in, when used by external modules
@@ -261,6 +262,15 @@ public:
      */
     virtual QPixmap generatePreview(const QSize& size);
 
+    /**
+     * Set whether the preview picture is included in autosave files.
+     * The default is read from the AutoSavePreview entry in the Autosave group
+     * of the application config, and is true if there is no such entry.
+     */
+    void setAutoSavePreview(bool on);
+    /// @return true if the preview picture is included in autosave files
+    bool autoSavePreview() const;
+
     /**
      *  Paints the data itself.
      *  It's this method that %Calligra Parts have to implement.
@@ -328,6 +338,14 @@ public:
      */
     virtual QDomDocument saveXML();
 
+    /**
+     *  Reimplement this to save the contents of the document by streaming it
+     *  directly to @p writer, avoiding building the complete QDomDocument in memory.
+     *  The writer is positioned before the xml declaration.
+     *  @return false if not implemented, in which case saveXML() is used.
+     */
+    virtual bool saveXMLStream(KoXmlWriter &writer);
+
     /**
      *  Return a correctly created QDomDocument for this KoDocument,
      *  including processing instruction, complete DOCTYPE tag (with systemId and publicId), and root element.
@@ -680,6 +698,22 @@ protected:
     QString autoSaveFile(const QString & path) const;
     void setDisregardAutosaveFailure(bool disregardFailure);
 
+    /**
+     * Reimplement to return a number that changes whenever the content painted
+     * by paintContent() changes.
+     * The encoded preview is cached and only regenerated when the revision changes.
+     * The default returns -1 which means the revision is unknown,
+     * and the preview is regenerated on every save.
+     */
+    virtual int previewRevision() const;
+
+    /**
+     * Call when previewRevision() has changed.
+     * The preview is rendered after a short delay and encoded in a worker thread,
+     * so it is ready for the next save.
+     */
+    void updatePreview();
+
     /**
      *  Loads a document from KReadOnlyPart::m_file (KParts takes care of downloading
      *  remote documents).
@@ -776,20 +810,34 @@ private Q_SLOTS:
 
     void slotAutoSave();
 
+    /// Called when the background autosave started by startBackgroundAutoSave() has finished
+    void slotAutoSaveFinished(bool success, const QString &errorMessage);
+
     /// Called by the undo stack when undo or redo is called
     void slotUndoStackIndexChanged(int idx);
 
+    /// Render the preview and start encoding it in a worker thread
+    void slotRenderPreview();
+    /// Called when the preview for @p revision has been encoded to @p png
+    void slotPreviewEncoded(int revision, const QByteArray &png);
+
 protected:
     bool oldLoadAndParse(KoStore *store, const QString& filename, KoXmlDocument& doc);
 private:
     bool saveToStream(QIODevice *dev);
 
+    /// Save the document to an in-memory store and write the autosave file from it in a worker thread
+    void startBackgroundAutoSave();
+
     QString checkImageMimeTypes(const QString &mimeType, const QUrl &url) const;
 
     bool loadNativeFormatFromStore(const QString& file);
     bool loadNativeFormatFromStoreInternal(KoStore *store);
 
     bool savePreview(KoStore *store);
+    /// @return the preview encoded as png, from the cache if it is current
+    QByteArray previewData();
+    QImage previewImage();
     bool saveOasisPreview(KoStore *store, KoXmlWriter *manifestWriter);
 
     QString prettyPathOrUrl() const;
@@ -35,13 +35,22 @@ namespace KPlato
 
 
 FlatProxyModel::FlatProxyModel(QObject *parent)
-    : QAbstractProxyModel( parent )
+    : QAbstractProxyModel( parent ),
+    m_validRows( 0 ),
+    m_resetting( false ),
+    m_moving( false ),
+    m_moveFirst( -1 ),
+    m_moveLast( -1 ),
+    m_moveTo( -1 )
 {
 }
 
 void FlatProxyModel::sourceModelDestroyed()
 {
     m_sourceIndexList.clear();
+    m_sourceRows.clear();
+    m_descendants.clear();
+    m_validRows = 0;
 }
 
 void FlatProxyModel::sourceDataChanged(const QModelIndex &source_top_left, const QModelIndex &source_bottom_right)
@@ -77,25 +86,71 @@ void FlatProxyModel::sourceRowsAboutToBeInserted(const QModelIndex &source_paren
     Q_UNUSED(source_parent);
     Q_UNUSED(start);
     Q_UNUSED(end);
-    beginResetModel();
+    // The inserted rows may have children, so they are counted when inserted
 }
 
 void FlatProxyModel::sourceRowsInserted(const QModelIndex &source_parent, int start, int end)
 {
-    Q_UNUSED(source_parent);
-    Q_UNUSED(start);
-    Q_UNUSED(end);
-
-    initiateMaps();
-    endResetModel();
+    rehash();
+    int row = -1;
+    if ( start > 0 ) {
+        const QModelIndex previous = sourceModel()->index( start - 1, 0, source_parent );
+        row = mapFromSourceRow( previous );
+        if ( row >= 0 ) {
+            row += 1 + m_descendants.value( previous );
+        }
+    } else if ( source_parent.isValid() ) {
+        row = mapFromSourceRow( source_parent );
+        if ( row >= 0 ) {
+            ++row;
+        }
+    } else {
+        row = 0;
+    }
+    if ( row < 0 ) {
+        // fail safe
+        beginResetModel();
+        initiateMaps();
+        endResetModel();
+        return;
+    }
+    QList<QPersistentModelIndex> indexes;
+    collectSourceIndexes( indexes, source_parent, start, end );
+    if ( indexes.isEmpty() ) {
+        return;
+    }
+    beginInsertRows( QModelIndex(), row, row + indexes.count() - 1 );
+    for ( int i = 0; i < indexes.count(); ++i ) {
+        m_sourceIndexList.insert( row + i, indexes.at( i ) );
+        m_sourceRows.insert( indexes.at( i ), row + i );
+    }
+    addDescendants( source_parent, indexes.count() );
+    invalidateRows( row );
+    endInsertRows();
 }
 
 void FlatProxyModel::sourceRowsAboutToBeRemoved( const QModelIndex &source_parent, int start, int end )
 {
-    Q_UNUSED(source_parent);
-    Q_UNUSED(start);
-    Q_UNUSED(end);
-    beginResetModel();
+    const QModelIndex last = sourceModel()->index( end, 0, source_parent );
+    const int first = mapFromSourceRow( sourceModel()->index( start, 0, source_parent ) );
+    int lastRow = mapFromSourceRow( last );
+    if ( first < 0 || lastRow < first ) {
+        // fail safe
+        m_resetting = true;
+        beginResetModel();
+        return;
+    }
+    lastRow += m_descendants.value( last );
+    beginRemoveRows( QModelIndex(), first, lastRow );
+    for ( int row = first; row <= lastRow; ++row ) {
+        const QPersistentModelIndex &idx = m_sourceIndexList.at( row );
+        m_sourceRows.remove( idx );
+        m_descendants.remove( idx );
+    }
+    m_sourceIndexList.erase( m_sourceIndexList.begin() + first, m_sourceIndexList.begin() + lastRow + 1 );
+    addDescendants( source_parent, first - lastRow - 1 );
+    invalidateRows( first );
+    endRemoveRows();
 }
 
 void FlatProxyModel::sourceRowsRemoved( const QModelIndex &source_parent, int start, int end )
@@ -104,30 +159,62 @@ void FlatProxyModel::sourceRowsRemoved( const QModelIndex &source_parent, int st
     Q_UNUSED(start);
     Q_UNUSED(end);
 
-    initiateMaps();
-    endResetModel();
+    if ( m_resetting ) {
+        m_resetting = false;
+        initiateMaps();
+        endResetModel();
+        return;
+    }
+    rehash();
 }
 
 void FlatProxyModel::sourceRowsAboutToBeMoved(const QModelIndex &source_parent, int start, int end, const QModelIndex &destParent, int destStart)
 {
-    Q_UNUSED(source_parent);
-    Q_UNUSED(start);
-    Q_UNUSED(end);
-    Q_UNUSED(destParent);
-    Q_UNUSED(destStart);
-    beginResetModel();
+    const QModelIndex last = sourceModel()->index( end, 0, source_parent );
+    m_moveFirst = mapFromSourceRow( sourceModel()->index( start, 0, source_parent ) );
+    m_moveLast = mapFromSourceRow( last );
+    m_moveTo = flatRow( destParent, destStart );
+    if ( m_moveFirst < 0 || m_moveLast < m_moveFirst || m_moveTo < 0 ) {
+        // fail safe
+        m_resetting = true;
+        beginResetModel();
+        return;
+    }
+    m_moveLast += m_descendants.value( last );
+    // If the rows are moved to where they already are in the flat model,
+    // e.g. to become children of their previous sibling, only the parents change
+    m_moving = beginMoveRows( QModelIndex(), m_moveFirst, m_moveLast, QModelIndex(), m_moveTo );
 }
 
 void FlatProxyModel::sourceRowsMoved(const QModelIndex &source_parent, int start, int end, const QModelIndex &destParent, int destStart)
 {
-    Q_UNUSED(source_parent);
     Q_UNUSED(start);
     Q_UNUSED(end);
-    Q_UNUSED(destParent);
     Q_UNUSED(destStart);
 
-    initiateMaps();
-    endResetModel();
+    if ( m_resetting ) {
+        m_resetting = false;
+        initiateMaps();
+        endResetModel();
+        return;
+    }
+    rehash();
+    const int count = m_moveLast - m_moveFirst + 1;
+    addDescendants( source_parent, -count );
+    addDescendants( destParent, count );
+    if ( ! m_moving ) {
+        emit dataChanged( index( m_moveFirst, 0 ), index( m_moveLast, columnCount() - 1 ) );
+        return;
+    }
+    m_moving = false;
+    const QList<QPersistentModelIndex> indexes = m_sourceIndexList.mid( m_moveFirst, count );
+    m_sourceIndexList.erase( m_sourceIndexList.begin() + m_moveFirst, m_sourceIndexList.begin() + m_moveLast + 1 );
+    const int to = m_moveTo > m_moveLast ? m_moveTo - count : m_moveTo;
+    for ( int i = 0; i < count; ++i ) {
+        m_sourceIndexList.insert( to + i, indexes.at( i ) );
+    }
+    invalidateRows( qMin( m_moveFirst, to ) );
+    endMoveRows();
 }
 
 void FlatProxyModel::setSourceModel(QAbstractItemModel *model)
@@ -159,9 +246,9 @@ void FlatProxyModel::setSourceModel(QAbstractItemModel *model)
 
         disconnect(sourceModel(), &QAbstractItemModel::modelReset, this, &FlatProxyModel::sourceReset);
 
-        connect(sourceModel(), &QAbstractItemModel::rowsAboutToBeMoved,
+        disconnect(sourceModel(), &QAbstractItemModel::rowsAboutToBeMoved,
                 this, &FlatProxyModel::sourceRowsAboutToBeMoved);
-        connect(sourceModel(), &QAbstractItemModel::rowsMoved,
+        disconnect(sourceModel(), &QAbstractItemModel::rowsMoved,
                 this, &FlatProxyModel::sourceRowsMoved);
     }
     QAbstractProxyModel::setSourceModel(model);
@@ -413,7 +500,7 @@ QModelIndex FlatProxyModel::mapFromSource(const QModelIndex &sourceIndex) const
         // we only map indices with column 0
         idx = sourceModel()->index( idx.row(), 0, idx.parent() );
     }
-    QModelIndex proxy_index = index( m_sourceIndexList.indexOf( idx ), sourceIndex.column() );
+    QModelIndex proxy_index = index( mapFromSourceRow( idx ), sourceIndex.column() );
     //debugPlan<<sourceIndex<<"->"<<proxy_index;
     Q_ASSERT(proxy_index.model() == this);
     return proxy_index;
@@ -429,29 +516,119 @@ QItemSelection FlatProxyModel::mapSelectionFromSource(const QItemSelection &sour
     return QAbstractProxyModel::mapSelectionFromSource(sourceSelection);
 }
 
-void FlatProxyModel::initiateMaps( const QModelIndex &sourceParent )
+int FlatProxyModel::mapFromSourceRow( const QModelIndex &sourceIndex ) const
+{
+    if ( ! sourceIndex.isValid() ) {
+        return -1;
+    }
+    QPersistentModelIndex idx = sourceIndex;
+    if ( idx.column() != 0 ) {
+        idx = sourceModel()->index( idx.row(), 0, idx.parent() );
+    }
+    QHash<QPersistentModelIndex, int>::const_iterator it = m_sourceRows.constFind( idx );
+    if ( it == m_sourceRows.constEnd() ) {
+        return -1;
+    }
+    if ( it.value() < m_validRows ) {
+        return it.value();
+    }
+    // Rows have been inserted, removed or moved in front of this index since it was mapped
+    for ( int row = m_validRows; row < m_sourceIndexList.count(); ++row ) {
+        m_sourceRows[ m_sourceIndexList.at( row ) ] = row;
+    }
+    m_validRows = m_sourceIndexList.count();
+    return m_sourceRows.value( idx, -1 );
+}
+
+int FlatProxyModel::flatRow( const QModelIndex &sourceParent, int sourceRow ) const
 {
+    if ( sourceRow < sourceModel()->rowCount( sourceParent ) ) {
+        return mapFromSourceRow( sourceModel()->index( sourceRow, 0, sourceParent ) );
+    }
+    // After the last child, i.e. after all the descendants of the parent
     if ( ! sourceParent.isValid() ) {
-        m_sourceIndexList.clear();
-        m_sourceIndexMap.clear();
+        return m_sourceIndexList.count();
     }
+    int row = mapFromSourceRow( sourceParent );
+    return row < 0 ? -1 : row + 1 + m_descendants.value( sourceParent );
+}
+
+void FlatProxyModel::initiateMaps()
+{
+    m_sourceIndexList.clear();
+    m_sourceRows.clear();
+    m_descendants.clear();
+    m_validRows = 0;
     QAbstractItemModel *m = sourceModel();
     if ( m == 0 ) {
         debugPlan<<"No source model";
         return;
     }
-    int count = m->rowCount( sourceParent );
-    for ( int row = 0; row < count; ++row ) {
+    collectSourceIndexes( m_sourceIndexList, QModelIndex(), 0, m->rowCount() - 1 );
+    m_sourceRows.reserve( m_sourceIndexList.count() );
+    for ( int row = 0; row < m_sourceIndexList.count(); ++row ) {
+        m_sourceRows.insert( m_sourceIndexList.at( row ), row );
+    }
+    m_validRows = m_sourceIndexList.count();
+    //debugPlan<<"source index list="<<m_sourceIndexList;
+}
+
+// Appends the source rows start to end of sourceParent with all their descendants to indexes,
+// registers the number of descendants, and returns the number of indexes appended
+int FlatProxyModel::collectSourceIndexes( QList<QPersistentModelIndex> &indexes, const QModelIndex &sourceParent, int start, int end )
+{
+    QAbstractItemModel *m = sourceModel();
+    int total = 0;
+    for ( int row = start; row <= end; ++row ) {
         QPersistentModelIndex idx = m->index( row, 0, sourceParent );
         //debugPlan<<"map:"<<sourceParent<<row<<idx;
         if ( idx.isValid() ) { // fail safe
-            m_sourceIndexList.append( idx );
-            m_sourceIndexMap.insert( idx.parent(), idx );
+            indexes.append( idx );
+            const int count = collectSourceIndexes( indexes, idx, 0, m->rowCount( idx ) - 1 );
+            if ( count > 0 ) {
+                m_descendants.insert( idx, count );
+            }
+            total += 1 + count;
+        }
+    }
+    return total;
+}
 
-            initiateMaps( idx );
+void FlatProxyModel::addDescendants( const QModelIndex &sourceParent, int count )
+{
+    for ( QModelIndex idx = sourceParent; idx.isValid(); idx = idx.parent() ) {
+        const QPersistentModelIndex pidx = idx.column() == 0 ? idx : idx.sibling( idx.row(), 0 );
+        const int descendants = m_descendants.value( pidx ) + count;
+        if ( descendants > 0 ) {
+            m_descendants.insert( pidx, descendants );
+        } else {
+            m_descendants.remove( pidx );
         }
     }
-    //debugPlan<<"source index list="<<m_sourceIndexList;
+}
+
+void FlatProxyModel::invalidateRows( int row )
+{
+    m_validRows = qMin( m_validRows, row );
+}
+
+// The hash of a QPersistentModelIndex depends on its current row,
+// so the keys must be hashed again when source rows have been inserted, removed or moved
+void FlatProxyModel::rehash()
+{
+    QHash<QPersistentModelIndex, int> rows;
+    rows.reserve( m_sourceRows.count() );
+    for ( QHash<QPersistentModelIndex, int>::const_iterator it = m_sourceRows.constBegin(); it != m_sourceRows.constEnd(); ++it ) {
+        rows.insert( it.key(), it.value() );
+    }
+    m_sourceRows.swap( rows );
+
+    QHash<QPersistentModelIndex, int> descendants;
+    descendants.reserve( m_descendants.count() );
+    for ( QHash<QPersistentModelIndex, int>::const_iterator it = m_descendants.constBegin(); it != m_descendants.constEnd(); ++it ) {
+        descendants.insert( it.key(), it.value() );
+    }
+    m_descendants.swap( descendants );
 }
 
 
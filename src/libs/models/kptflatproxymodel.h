@@ -23,6 +23,8 @@
 #include "planmodels_export.h"
 
 #include <QAbstractProxyModel>
+#include <QHash>
+#include <QPersistentModelIndex>
 
 /// The main namespace
 namespace KPlato
@@ -41,6 +43,10 @@ namespace KPlato
 
     The flat model adds a Parent column at the end of the source model columns,
     to make it possible to access the parent index's data at column 0.
+
+    Source indexes are mapped to flat rows using a hash, and the number of
+    descendants of each source index is kept so that rows inserted, removed
+    or moved in the source model are forwarded as the corresponding flat row ranges.
 */
 class PLANMODELS_EXPORT FlatProxyModel : public QAbstractProxyModel
 {
@@ -99,18 +105,38 @@ public Q_SLOTS:
                                   int start, int end, const QModelIndex &destParent, int destStart );
 
 protected:
+    /// Returns the flat row of @p sourceIndex, or -1 if it is not mapped
     int mapFromSourceRow( const QModelIndex & sourceIndex ) const;
-    int mapToSourceRow( const  QModelIndex & sourceIndex ) const;
+    /// Returns the flat row where the source row @p sourceRow of @p sourceParent is, or would be inserted
+    int flatRow( const QModelIndex &sourceParent, int sourceRow ) const;
 
 private Q_SLOTS:
-    void initiateMaps( const QModelIndex &sourceParent = QModelIndex() );
+    void initiateMaps();
     void sourceModelDestroyed();
     
+private:
+    int collectSourceIndexes( QList<QPersistentModelIndex> &indexes, const QModelIndex &sourceParent, int start, int end );
+    void addDescendants( const QModelIndex &sourceParent, int count );
+    void invalidateRows( int row );
+    /// Rebuild the hashes keyed on source indexes after source rows have changed
+    void rehash();
+
 private:
     /// List of sourceIndexes
     QList<QPersistentModelIndex> m_sourceIndexList;
-    /// Map of sourceIndexes (parent, index)
-    QMultiMap<QPersistentModelIndex, QPersistentModelIndex> m_sourceIndexMap;
+    /// The flat row of each sourceIndex, only rows < m_validRows are up to date.
+    /// The keys are hashed on their row, see rehash()
+    mutable QHash<QPersistentModelIndex, int> m_sourceRows;
+    mutable int m_validRows;
+    /// Number of descendants of sourceIndexes that have children
+    QHash<QPersistentModelIndex, int> m_descendants;
+    /// Set when a source change could not be mapped and the model is reset instead
+    bool m_resetting;
+    /// Set when a source move is forwarded as a flat move of rows m_moveFirst to m_moveLast before m_moveTo
+    bool m_moving;
+    int m_moveFirst;
+    int m_moveLast;
+    int m_moveTo;
 };
 
 } //namespace KPlato
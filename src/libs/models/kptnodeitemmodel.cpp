@@ -76,13 +76,48 @@ const QMetaEnum NodeModel::columnMap() const
 void NodeModel::setProject( Project *project )
 {
     debugPlan<<m_project<<"->"<<project;
+    if ( m_project ) {
+        disconnect( m_project, &Project::nodeChanged, this, &NodeModel::resetEvmSnapshot );
+        disconnect( m_project, &Project::nodeAdded, this, &NodeModel::resetEvmSnapshot );
+        disconnect( m_project, &Project::nodeRemoved, this, &NodeModel::resetEvmSnapshot );
+        disconnect( m_project, &Project::nodeMoved, this, &NodeModel::resetEvmSnapshot );
+        disconnect( m_project, &Project::resourceChanged, this, &NodeModel::resetEvmSnapshot );
+        disconnect( m_project, &Project::projectCalculated, this, &NodeModel::resetEvmSnapshot );
+        disconnect( m_project, &Project::scheduleChanged, this, &NodeModel::resetEvmSnapshot );
+        disconnect( m_project, &Project::scheduleRemoved, this, &NodeModel::resetEvmSnapshot );
+    }
     m_project = project;
+    m_evm.clear();
+    if ( m_project ) {
+        connect( m_project, &Project::nodeChanged, this, &NodeModel::resetEvmSnapshot );
+        connect( m_project, &Project::nodeAdded, this, &NodeModel::resetEvmSnapshot );
+        connect( m_project, &Project::nodeRemoved, this, &NodeModel::resetEvmSnapshot );
+        connect( m_project, &Project::nodeMoved, this, &NodeModel::resetEvmSnapshot );
+        connect( m_project, &Project::resourceChanged, this, &NodeModel::resetEvmSnapshot );
+        connect( m_project, &Project::projectCalculated, this, &NodeModel::resetEvmSnapshot );
+        connect( m_project, &Project::scheduleChanged, this, &NodeModel::resetEvmSnapshot );
+        connect( m_project, &Project::scheduleRemoved, this, &NodeModel::resetEvmSnapshot );
+    }
 }
 
 void NodeModel::setManager( ScheduleManager *sm )
 {
     debugPlan<<m_manager<<"->"<<sm;
     m_manager = sm;
+    m_evm.clear();
+}
+
+void NodeModel::resetEvmSnapshot()
+{
+    m_evm.clear();
+}
+
+EvmSnapshot::Values NodeModel::evmValues( const Node *node ) const
+{
+    if ( ! m_evm.isValid( id(), m_now ) ) {
+        m_evm.calculate( m_project, id(), m_now );
+    }
+    return m_evm.values( node );
 }
 
 QVariant NodeModel::name( const Node *node, int role ) const
@@ -1597,9 +1632,9 @@ QVariant NodeModel::plannedCostTo( const Node *node, int role ) const
     Locale *l = m_project->locale();
     switch ( role ) {
         case Qt::DisplayRole:
-            return l->formatMoney( node->plannedCostTo( m_now, id() ) );
+            return l->formatMoney( evmValues( node ).plannedCostTo );
         case Qt::ToolTipRole:
-            return xi18nc( "@info:tooltip", "Planned cost until %1: %2", QLocale().toString( m_now, QLocale::ShortFormat ), l->formatMoney( node->plannedCostTo( m_now, id() ) ) );
+            return xi18nc( "@info:tooltip", "Planned cost until %1: %2", QLocale().toString( m_now, QLocale::ShortFormat ), l->formatMoney( evmValues( node ).plannedCostTo ) );
         case Qt::EditRole:
             return node->plannedCostTo( m_now );
         case Qt::StatusTipRole:
@@ -1614,11 +1649,11 @@ QVariant NodeModel::actualCostTo( const Node *node, int role ) const
     Locale *l = m_project->locale();
     switch ( role ) {
         case Qt::DisplayRole:
-            return l->formatMoney( node->actualCostTo( id(), m_now ).cost() );
+            return l->formatMoney( evmValues( node ).actualCostTo.cost() );
         case Qt::ToolTipRole:
-            return xi18nc( "@info:tooltip", "Actual cost until %1: %2", QLocale().toString( m_now, QLocale::ShortFormat ), l->formatMoney( node->actualCostTo( id(), m_now ).cost() ) );
+            return xi18nc( "@info:tooltip", "Actual cost until %1: %2", QLocale().toString( m_now, QLocale::ShortFormat ), l->formatMoney( evmValues( node ).actualCostTo.cost() ) );
         case Qt::EditRole:
-            return node->actualCostTo( id(), m_now ).cost();
+            return evmValues( node ).actualCostTo.cost();
         case Qt::StatusTipRole:
         case Qt::WhatsThisRole:
             return QVariant();
@@ -1927,11 +1962,11 @@ QVariant NodeModel::nodeBCWS( const Node *node, int role ) const
 {
     switch ( role ) {
         case Qt::DisplayRole:
-            return m_project->locale()->formatMoney( node->bcws( m_now, id() ), QString(), 0 );
+            return m_project->locale()->formatMoney( evmValues( node ).bcws, QString(), 0 );
         case Qt::EditRole:
-            return node->bcws( m_now, id() );
+            return evmValues( node ).bcws;
         case Qt::ToolTipRole:
-            return xi18nc( "@info:tooltip", "Budgeted Cost of Work Scheduled at %1: %2", QLocale().toString( m_now, QLocale::ShortFormat ), m_project->locale()->formatMoney( node->bcws( m_now, id() ), QString(), 0 ) );
+            return xi18nc( "@info:tooltip", "Budgeted Cost of Work Scheduled at %1: %2", QLocale().toString( m_now, QLocale::ShortFormat ), m_project->locale()->formatMoney( evmValues( node ).bcws, QString(), 0 ) );
         case Qt::StatusTipRole:
         case Qt::WhatsThisRole:
             return QVariant();
@@ -1943,11 +1978,11 @@ QVariant NodeModel::nodeBCWP( const Node *node, int role ) const
 {
     switch ( role ) {
         case Qt::DisplayRole:
-            return m_project->locale()->formatMoney( node->bcwp( id() ), QString(), 0 );
+            return m_project->locale()->formatMoney( evmValues( node ).bcwp, QString(), 0 );
         case Qt::EditRole:
-            return node->bcwp( id() );
+            return evmValues( node ).bcwp;
         case Qt::ToolTipRole:
-            return xi18nc( "@info:tooltip", "Budgeted Cost of Work Performed at %1: %2", QLocale().toString( m_now, QLocale::ShortFormat ), m_project->locale()->formatMoney( node->bcwp( id() ), QString(), 0 ) );
+            return xi18nc( "@info:tooltip", "Budgeted Cost of Work Performed at %1: %2", QLocale().toString( m_now, QLocale::ShortFormat ), m_project->locale()->formatMoney( evmValues( node ).bcwp, QString(), 0 ) );
         case Qt::StatusTipRole:
         case Qt::WhatsThisRole:
             return QVariant();
@@ -1959,11 +1994,11 @@ QVariant NodeModel::nodeACWP( const Node *node, int role ) const
 {
     switch ( role ) {
         case Qt::DisplayRole:
-            return m_project->locale()->formatMoney( node->acwp( m_now, id() ).cost(), QString(), 0 );
+            return m_project->locale()->formatMoney( evmValues( node ).acwp.cost(), QString(), 0 );
         case Qt::EditRole:
-            return node->acwp( m_now, id() ).cost();
+            return evmValues( node ).acwp.cost();
         case Qt::ToolTipRole:
-            return xi18nc( "@info:tooltip", "Actual Cost of Work Performed at %1: %2", QLocale().toString( m_now, QLocale::ShortFormat ), m_project->locale()->formatMoney( node->acwp( m_now, id() ).cost() ) );
+            return xi18nc( "@info:tooltip", "Actual Cost of Work Performed at %1: %2", QLocale().toString( m_now, QLocale::ShortFormat ), m_project->locale()->formatMoney( evmValues( node ).acwp.cost() ) );
         case Qt::StatusTipRole:
         case Qt::WhatsThisRole:
             return QVariant();
@@ -1975,16 +2010,16 @@ QVariant NodeModel::nodePerformanceIndex( const Node *node, int role ) const
 {
     switch ( role ) {
         case Qt::DisplayRole:
-            return QLocale().toString( node->schedulePerformanceIndex( m_now, id() ), 'f', 2 );
+            return QLocale().toString( evmValues( node ).spi, 'f', 2 );
         case Qt::EditRole:
-            return node->schedulePerformanceIndex( m_now, id() );
+            return evmValues( node ).spi;
         case Qt::ToolTipRole:
-            return xi18nc( "@info:tooltip", "Schedule Performance Index at %1: %2", m_now.toString(), QLocale().toString( node->schedulePerformanceIndex( m_now, id() ), 'f', 2 ) );
+            return xi18nc( "@info:tooltip", "Schedule Performance Index at %1: %2", m_now.toString(), QLocale().toString( evmValues( node ).spi, 'f', 2 ) );
         case Qt::StatusTipRole:
         case Qt::WhatsThisRole:
             return QVariant();
         case Qt::ForegroundRole:
-            return QColor(node->schedulePerformanceIndex( m_now, id() ) < 1.0 ? Qt::red : Qt::black);
+            return QColor(evmValues( node ).spi < 1.0 ? Qt::red : Qt::black);
     }
     return QVariant();
 }
@@ -23,6 +23,7 @@
 #include "kptitemmodelbase.h"
 #include "kptschedule.h"
 #include "kptworkpackagemodel.h"
+#include "kptevmsnapshot.h"
 
 #include <QDate>
 #include <QMetaEnum>
@@ -159,6 +160,10 @@ public:
     
     void setNow( const QDate &now ) { m_now = now; }
     QDate now() const { return m_now; }
+
+    /// Returns the earned value figures for @p node at now() for the current schedule.
+    /// The values for all nodes are calculated on first use and cached until the project changes.
+    EvmSnapshot::Values evmValues( const Node *node ) const;
     
     QVariant name( const Node *node, int role ) const;
     QVariant leader( const Node *node, int role ) const;
@@ -273,11 +278,16 @@ public:
     KUndo2Command *setStartedTime( Node *node, const QVariant &value, int role );
     KUndo2Command *setFinishedTime( Node *node, const QVariant &value, int role );
 
+public Q_SLOTS:
+    /// Discard cached earned value figures
+    void resetEvmSnapshot();
+
 private:
     Project *m_project;
     ScheduleManager *m_manager;
     QDate m_now;
     int m_prec;
+    mutable EvmSnapshot m_evm;
 };
 
 class PLANMODELS_EXPORT NodeItemModel : public ItemModelBase
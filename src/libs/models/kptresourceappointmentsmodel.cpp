@@ -25,6 +25,7 @@
 #include "kptappointment.h"
 #include "kptcommand.h"
 #include "kpteffortcostmap.h"
+#include "kpteffortcube.h"
 #include "kptitemmodelbase.h"
 #include "kptcalendar.h"
 #include "kptduration.h"
@@ -32,6 +33,7 @@
 #include "kptproject.h"
 #include "kpttask.h"
 #include "kptresource.h"
+#include "kptschedule.h"
 #include "kptdatetime.h"
 #include "kptdebug.h"
 
@@ -474,22 +476,13 @@ void ResourceAppointmentsItemModel::refreshData()
 {
     long id = m_manager == 0 ? -1 : m_manager->scheduleId();
     //debugPlan<<"Schedule id: "<<id<<endl;
-    QDate start;
-    QDate end;
-    QHash<const Appointment*, EffortCostMap> ec;
+    QSet<const Appointment*> internal;
     QHash<const Appointment*, EffortCostMap> extEff;
     foreach ( Resource *r, m_project->resourceList() ) {
         foreach (Appointment* a, r->appointments( id )) {
-            QDate s = a->startTime().date();
-            QDate e = a->endTime().date();
-            ec[ a ] = a->plannedPrDay( s, e );
-            if ( ! start.isValid() || s < start ) {
-                start = s;
+            if ( a->node() && a->node()->node() ) {
+                internal.insert( a );
             }
-            if ( ! end.isValid() || e > end ) {
-                end = e;
-            }
-            //debugPlan<<a->node()->node()->name()<<": "<<s<<e<<": "<<m_effortMap[ a ].totalEffort().toDouble(Duration::Unit_h);
         }
         // add external appointments
         foreach (Appointment* a, r->externalAppointmentList() ) {
@@ -498,13 +491,22 @@ void ResourceAppointmentsItemModel::refreshData()
             //debugPlan<<r->name()<<a->auxcilliaryInfo()<<": "<<extEff[ a ].startDate()<<extEff[ a ].endDate();
         }
     }
-    m_effortMap.clear();
-    m_externalEffortMap.clear();
-    m_effortMap = ec;
+    m_appointments = internal;
     m_externalEffortMap = extEff;
     return;
 }
 
+Duration ResourceAppointmentsItemModel::plannedEffort( const Appointment *a, const QDate &date ) const
+{
+    if ( m_manager == 0 || ! m_appointments.contains( a ) ) {
+        return Duration::zeroDuration;
+    }
+    const EffortCube &cube = m_manager->effortCube();
+    const Resource *r = a->resource()->resource();
+    const Node *n = a->node()->node();
+    return date.isValid() ? cube.effortCost( r, n, date ).effort() : cube.effortCost( r, n ).effort();
+}
+
 int ResourceAppointmentsItemModel::columnCount( const QModelIndex &/*parent*/ ) const
 {
     return 3 + startDate().daysTo( endDate() );
@@ -606,12 +608,7 @@ QVariant ResourceAppointmentsItemModel::total( const Resource *res, int role ) c
         case Qt::DisplayRole: {
             Duration d;
             if ( m_showInternal ) {
-                QList<Appointment*> lst = res->appointments( m_manager->scheduleId() );
-                foreach ( Appointment *a, lst ) {
-                    if ( m_effortMap.contains( a ) ) {
-                        d += m_effortMap[ a ].totalEffort();
-                    }
-                }
+                d += m_manager->effortCube().effortCost( res ).effort();
             }
             if ( m_showExternal ) {
                 QList<Appointment*> lst = res->externalAppointmentList();
@@ -639,13 +636,8 @@ QVariant ResourceAppointmentsItemModel::total( const Resource *res, const QDate
     switch ( role ) {
         case Qt::DisplayRole: {
             Duration d;
-            if ( m_showInternal ) {
-                QList<Appointment*> lst = res->appointments( id() );
-                foreach ( Appointment *a, lst ) {
-                    if ( m_effortMap.contains( a ) ) {
-                        d += m_effortMap[ a ].effortOnDate( date );
-                    }
-                }
+            if ( m_showInternal && m_manager ) {
+                d += m_manager->effortCube().effortCost( res, date ).effort();
             }
             if ( m_showExternal ) {
                 QList<Appointment*> lst = res->externalAppointmentList();
@@ -685,15 +677,15 @@ QVariant ResourceAppointmentsItemModel::total( const Appointment *a, int role )
     switch ( role ) {
         case Qt::DisplayRole: {
             Duration d;
-            if ( m_effortMap.contains( a ) ) {
-                d = m_effortMap[ a ].totalEffort();
+            if ( m_appointments.contains( a ) ) {
+                d = plannedEffort( a );
             } else if ( m_externalEffortMap.contains( a ) ) {
                 d = m_externalEffortMap[ a ].totalEffort();
             }
             return QLocale().toString( d.toDouble( Duration::Unit_h ), 'f', 1 );
         }
         case Qt::ToolTipRole: {
-            if ( m_effortMap.contains( a ) ) {
+            if ( m_appointments.contains( a ) ) {
                 return i18n( "Total booking by this task" );
             } else if ( m_externalEffortMap.contains( a ) ) {
                 return i18n( "Total booking by the external project" );
@@ -721,11 +713,11 @@ QVariant ResourceAppointmentsItemModel::assignment( const Appointment *a, const
     switch ( role ) {
         case Qt::DisplayRole: {
             Duration d;
-            if ( m_effortMap.contains( a ) ) {
-                if ( date < m_effortMap[ a ].startDate() || date > m_effortMap[ a ].endDate() ) {
+            if ( m_appointments.contains( a ) ) {
+                if ( date < a->startTime().date() || date > a->endTime().date() ) {
                     return QVariant();
                 }
-                d = m_effortMap[ a ].effortOnDate( date );
+                d = plannedEffort( a, date );
                 return QLocale().toString( d.toDouble( Duration::Unit_h ), 'f', 1 );
             } else  if ( m_externalEffortMap.contains( a ) ) {
                 if ( date < m_externalEffortMap[ a ].startDate() || date > m_externalEffortMap[ a ].endDate() ) {
@@ -738,7 +730,7 @@ QVariant ResourceAppointmentsItemModel::assignment( const Appointment *a, const
         }
         case Qt::EditRole:
         case Qt::ToolTipRole: {
-            if ( m_effortMap.contains( a ) ) {
+            if ( m_appointments.contains( a ) ) {
                 return i18n( "Booking by this task on %1", QLocale().toString( date, QLocale::ShortFormat ) );
             } else if ( m_externalEffortMap.contains( a ) ) {
                 return i18n( "Booking by external project on %1",QLocale().toString( date, QLocale::ShortFormat ) );
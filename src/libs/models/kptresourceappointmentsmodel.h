@@ -25,6 +25,8 @@
 #include <kptitemmodelbase.h>
 #include "kpteffortcostmap.h"
 
+#include <QSet>
+
 
 namespace KPlato
 {
@@ -135,10 +137,14 @@ protected:
     QVariant total( const Appointment *a, int role ) const;
     
     QVariant assignment( const Appointment *a, const QDate &date, int role ) const;
+
+    /// Returns the planned effort of the internal appointment @p a, on @p date if it is valid
+    Duration plannedEffort( const Appointment *a, const QDate &date = QDate() ) const;
     
 private:
     int m_columnCount;
-    QHash<const Appointment*, EffortCostMap> m_effortMap;
+    /// The internal appointments, their effort is fetched from the effort cube of the schedule manager
+    QSet<const Appointment*> m_appointments;
     QHash<const Appointment*, EffortCostMap> m_externalEffortMap;
     QDate m_start;
     QDate m_end;
@@ -51,6 +51,13 @@
 #include <QSortFilterProxyModel>
 #include <QVariantList>
 #include <QPair>
+#include <QBuffer>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QScopedPointer>
+#include <QXmlStreamReader>
 
 #define HeaderRole Qt::UserRole + 543
 
@@ -263,10 +270,140 @@ void initScheduleModel(QAbstractItemModel *model, Project *project, ScheduleMana
     dbgRGVariable<<model->rowCount()<<model->columnCount();
 }
 
+//--------------------------------------
+/**
+ * An odt template unpacked into memory.
+ *
+ * Holds the files listed in the manifest and the root element namespace
+ * declarations of the xml files, so that reports can be generated without
+ * reading the template archive again.
+ * A template is never modified after it is loaded.
+ */
+class ReportTemplate
+{
+public:
+    typedef QList<QPair<QByteArray, QByteArray> > Attributes;
+
+    /// Returns the template in @p fileName, from the cache if the file has not been modified since it was loaded
+    static QSharedPointer<const ReportTemplate> load(const QString &fileName, QString &error);
+
+    QString fileName;
+    QDateTime lastModified;
+    qint64 size;
+    QByteArray mimeType;
+    QStringList manifestFiles; // The files in the manifest except content.xml
+    QHash<QString, QByteArray> files;
+    QHash<QString, Attributes> rootAttributes; // Namespace declarations and attributes of the root element of each xml file
+
+private:
+    bool read(KoStore &store, QString &error);
+    bool extract(KoStore &store, const QString &file);
+};
+
+static QMutex s_templateCacheMutex;
+static QHash<QString, QSharedPointer<const ReportTemplate> > s_templateCache;
+
+QSharedPointer<const ReportTemplate> ReportTemplate::load(const QString &fileName, QString &error)
+{
+    QFileInfo info(fileName);
+    {
+        QMutexLocker locker(&s_templateCacheMutex);
+        QSharedPointer<const ReportTemplate> t = s_templateCache.value(info.absoluteFilePath());
+        if (t && t->lastModified == info.lastModified() && t->size == info.size()) {
+            dbgRGTmp<<"Cached:"<<fileName;
+            return t;
+        }
+    }
+    QScopedPointer<KoStore> store(KoStore::createStore(fileName, KoStore::Read));
+    if (!store || store->bad()) {
+        dbgRG<<"Failed to open store:"<<fileName;
+        error = i18n("Failed to open template file: %1", fileName);
+        return QSharedPointer<const ReportTemplate>();
+    }
+    QSharedPointer<ReportTemplate> t(new ReportTemplate());
+    t->fileName = info.absoluteFilePath();
+    t->lastModified = info.lastModified();
+    t->size = info.size();
+    if (!t->read(*store, error)) {
+        return QSharedPointer<const ReportTemplate>();
+    }
+    QMutexLocker locker(&s_templateCacheMutex);
+    s_templateCache.insert(t->fileName, t);
+    return t;
+}
+
+bool ReportTemplate::extract(KoStore &store, const QString &file)
+{
+    QByteArray data;
+    if (!store.extractFile(file, data)) {
+        dbgRG<<"Failed to extract:"<<file;
+        return false;
+    }
+    if (file.endsWith(".xml")) {
+        QXmlStreamReader xml(data);
+        xml.setNamespaceProcessing(true);
+        while (!xml.atEnd()) {
+            xml.readNext();
+            if (xml.tokenType() == QXmlStreamReader::StartElement && !xml.namespaceDeclarations().isEmpty()) {
+                Attributes attributes;
+                // Note: windows needs this type of iteration
+                QXmlStreamNamespaceDeclarations dcl = xml.namespaceDeclarations();
+                for (int ns = 0; ns < dcl.count(); ++ns) {
+                    attributes << Attributes::value_type(("xmlns:" + dcl[ns].prefix()).toLatin1(), dcl[ns].namespaceUri().toUtf8());
+                }
+                QXmlStreamAttributes attr = xml.attributes();
+                for (int a = 0; a < attr.count(); ++a) {
+                    attributes << Attributes::value_type(attr[a].qualifiedName().toLatin1(), attr[a].value().toUtf8());
+                }
+                rootAttributes.insert(file, attributes);
+                break;
+            }
+        }
+    }
+    files.insert(file, data);
+    return true;
+}
+
+bool ReportTemplate::read(KoStore &store, QString &error)
+{
+    if (!store.hasFile("META-INF/manifest.xml")) {
+        dbgRG<<"No manifest file";
+        error = i18n("Failed to load manifest file");
+        return false;
+    }
+    if (!extract(store, "META-INF/manifest.xml")) {
+        error = i18n("Failed to load manifest file");
+        return false;
+    }
+    if (!extract(store, "content.xml")) {
+        error = i18n("Could not find %1", QString("content.xml"));
+        return false;
+    }
+    if (store.hasFile("mimetype")) {
+        store.extractFile("mimetype", mimeType);
+    }
+    QBuffer buffer(&files["META-INF/manifest.xml"]);
+    KoXmlDocument manifest;
+    if (!KoOdfReadStore::loadAndParse(&buffer, manifest, error, "META-INF/manifest.xml")) {
+        dbgRG<<"Failed to read manifest:"<<error;
+        return false;
+    }
+    KoXmlElement e;
+    forEachElement(e, manifest.documentElement()) {
+        dbgRG<<e.tagName()<<e.attributeNames();
+        QString file = e.attribute("full-path");
+        if (file.isEmpty() || file == "content.xml" || file.endsWith("/")) {
+            continue;
+        }
+        manifestFiles << file;
+        extract(store, file);
+    }
+    return true;
+}
+
 //--------------------------------------
 ReportGeneratorOdt::ReportGeneratorOdt()
     : ReportGenerator()
-    , m_templateStore(0)
 {
     m_keys = QStringList() << "table" << "chart";
     m_variables = QStringList() << "project" << "schedule";
@@ -321,14 +458,12 @@ bool ReportGeneratorOdt::open()
         m_lastError = i18n("Missing report result file");
         return false;
     }
-    if (m_templateStore) {
+    if (m_template) {
         m_lastError = i18n("Report generator is already open");
         return false;
     }
-    m_templateStore = KoStore::createStore(m_templateFile, KoStore::Read);
-    if (!m_templateStore) {
-        dbgRG<<"Failed to open store:"<<m_templateFile;
-        m_lastError = i18n("Failed to open template file: %1", m_templateFile);
+    m_template = ReportTemplate::load(m_templateFile, m_lastError);
+    if (!m_template) {
         return false;
     }
     for (ItemModelBase *m : m_basemodels) { // clazy:exclude=range-loop
@@ -347,13 +482,18 @@ bool ReportGeneratorOdt::open()
 
 void ReportGeneratorOdt::close()
 {
-    delete m_templateStore;
-    m_templateStore = 0;
+    m_template.clear();
+}
+
+void ReportGeneratorOdt::clearTemplateCache()
+{
+    QMutexLocker locker(&s_templateCacheMutex);
+    s_templateCache.clear();
 }
 
 bool ReportGeneratorOdt::createReport()
 {
-    if (!m_templateStore) {
+    if (!m_template) {
         m_lastError = i18n("Report generator has not been correctly opened");
         return false;
     }
@@ -364,84 +504,91 @@ bool ReportGeneratorOdt::createReport()
 bool ReportGeneratorOdt::createReportOdt()
 {
     m_tags.clear();
-    dbgRG<<"url:"<<m_templateStore->urlOfStore();
+    dbgRG<<"template:"<<m_template->fileName;
 
-    KoOdfReadStore reader(m_templateStore);
-    if (!reader.loadAndParse(m_lastError)) {
+    KoXmlDocument kodoc;
+    if (!loadAndParse("content.xml", kodoc)) {
         dbgRG<<"Failed to loadAndParse:"<<m_lastError;
         return false;
     }
     // copy manifest file and store a list of file references
-    KoStore *outStore = copyStore(reader, m_reportFile);
+    KoStore *outStore = copyStore(m_reportFile);
     if (!outStore) {
         dbgRG<<"Failed to copy template";
         return false;
     }
     dbgRG << endl << "---- treat main content.xml ----" << endl;
-    QBuffer buffer;
-    KoXmlWriter *writer = createOasisXmlWriter(reader, &buffer, "content.xml", "office:document-content");
-
-    if (!writer) {
-        dbgRG<<"Failed to create content.xml writer";
+    // the content is written directly into the report file
+    if (!outStore->open("content.xml")) {
+        dbgRG<<"Failed to open 'content.xml' for writing";
+        m_lastError = i18n("Failed to write to store: %1", QString("content.xml"));
+        delete outStore;
         return false;
     }
-    KoXmlDocument kodoc = reader.contentDoc();
-    KoXmlElement parent = kodoc.documentElement();
-    writeChildElements(*writer, parent);
-
-    writer->endElement(); // office:document-content
-    writer->endDocument();
+    {
+        KoStoreDevice device(outStore);
+        KoXmlWriter *writer = createOasisXmlWriter(&device, "content.xml", "office:document-content");
+        if (!writer) {
+            dbgRG<<"Failed to create content.xml writer";
+            delete outStore;
+            return false;
+        }
+        writeChildElements(*writer, kodoc.documentElement());
 
-    if (!outStore->addDataToFile(buffer.buffer(), "content.xml")) {
-        dbgRG<<"Failed to open 'content.xml' for writing";
-        m_lastError = i18n("Failed to write to store: %1", QString("content.xml"));
+        writer->endElement(); // office:document-content
+        writer->endDocument();
         delete writer;
+    }
+    if (!outStore->close()) {
+        dbgRG<<"Failed to write 'content.xml'";
+        m_lastError = i18n("Failed to write to store: %1", QString("content.xml"));
         delete outStore;
         return false;
     }
-    buffer.close();
 
     if (m_manifestfiles.contains("styles.xml")) {
         dbgRG << endl << "---- treat styles.xml (for master-page headers/footers) ----" << endl;
-        QBuffer buffer2;
-        KoXmlWriter *styles = createOasisXmlWriter(reader, &buffer2, "styles.xml", "office:document-styles");
-        if (!styles) {
-            dbgRG<<"Failed to create styles.xml writer";
-            return false;
-        }
         KoXmlDocument stylesDoc;
-        if (!reader.loadAndParse("styles.xml", stylesDoc, m_lastError)) {
+        if (!loadAndParse("styles.xml", stylesDoc)) {
             debugPlan<<"Failed to read styles.xml"<<m_lastError;
-            delete writer;
             delete outStore;
             return false;
         }
-        writeChildElements(*styles, stylesDoc.documentElement());
-        styles->endElement(); // office:document-styles
-        styles->endDocument();
-        if (!outStore->addDataToFile(buffer2.buffer(), "styles.xml")) {
+        if (!outStore->open("styles.xml")) {
             dbgRG<<"Failed to open 'styles.xml' for writing";
             m_lastError = i18n("Failed to write to store: %1", QString("styles.xml"));
-            delete writer;
             delete outStore;
+            return false;
         }
+        {
+            KoStoreDevice device(outStore);
+            KoXmlWriter *styles = createOasisXmlWriter(&device, "styles.xml", "office:document-styles");
+            if (!styles) {
+                dbgRG<<"Failed to create styles.xml writer";
+                delete outStore;
+                return false;
+            }
+            writeChildElements(*styles, stylesDoc.documentElement());
+            styles->endElement(); // office:document-styles
+            styles->endDocument();
+            delete styles;
+        }
+        outStore->close();
         m_manifestfiles.removeAt(m_manifestfiles.indexOf("styles.xml"));
     }
 
     dbgRG << endl << "---- treat the embedded files ----" << endl;
-    treatEmbededObjects(reader, *outStore);
+    treatEmbededObjects(*outStore);
     dbgRG << endl << "---- copy rest of files ----" << endl;
     for (int i = 0; i < m_manifestfiles.count(); ++i) {
-        copyFile(*reader.store(), *outStore, m_manifestfiles.at(i));
+        copyFile(*outStore, m_manifestfiles.at(i));
     }
     if (!outStore->finalize()) {
         dbgRG<<"Failed to write store:"<<outStore->urlOfStore();
         m_lastError = i18n("Failed to write report file: %1", outStore->urlOfStore().path());
-        delete writer;
         delete outStore;
         return false;
     }
-    delete writer;
     delete outStore;
     dbgRG<<"finished";
     return true;
@@ -814,36 +961,24 @@ void ReportGeneratorOdt::writeChildElements(KoXmlWriter &writer, const KoXmlElem
     }
 }
 
-bool ReportGeneratorOdt::copyFile(KoStore &from, KoStore &to, const QString &file)
+bool ReportGeneratorOdt::copyFile(KoStore &to, const QString &file)
 {
-    QByteArray data;
-    bool ok = from.extractFile(file, data);
-    if (!ok) {
+    if (!m_template->files.contains(file)) {
         dbgRG<<"Failed to extract:"<<file;
+        return false;
     }
-    if (ok) {
-        ok = addDataToFile(data, file, to);
-        if (!ok) {
-            dbgRG<<"Failed to add file:"<<file;
-        }
-    }
-    if (ok) {
+    QByteArray data = m_template->files.value(file);
+    bool ok = addDataToFile(data, file, to);
+    if (!ok) {
+        dbgRG<<"Failed to add file:"<<file;
+    } else {
         dbgRG<<"Added:"<<file;
     }
     return ok;
 }
 
-KoStore *ReportGeneratorOdt::copyStore(KoOdfReadStore &reader, const QString &outfile)
+KoStore *ReportGeneratorOdt::copyStore(const QString &outfile)
 {
-    if (!reader.store()->hasFile("META-INF/manifest.xml")) {
-        dbgRG<<"No manifest file";
-        return 0;
-    }
-    KoXmlDocument manifest;
-    if (!reader.loadAndParse("META-INF/manifest.xml", manifest, m_lastError)) {
-        dbgRG<<"Failed to read manifest:"<<m_lastError;
-        return 0;
-    }
     QUrl url(outfile);
     if (!url.isLocalFile()) {
         // FIXME: KoStore only handles local files
@@ -851,109 +986,70 @@ KoStore *ReportGeneratorOdt::copyStore(KoOdfReadStore &reader, const QString &ou
         m_lastError = i18n("Report generator can only generate local files");
         return 0;
     }
-    KoStore *out = KoStore::createStore(url.path(), KoStore::Write);
-    if (!out) {
+    // The store writes the mimetype first, see OpenDocument v1.2 part 3: Packages
+    KoStore *out = KoStore::createStore(url.path(), KoStore::Write, m_template->mimeType, KoStore::Auto, !m_template->mimeType.isEmpty());
+    if (!out || out->bad()) {
         dbgRG<<"Failed to create store";
         m_lastError = i18n("Failed to open report file: %1", url.path());
+        delete out;
         return 0;
     }
-    // This should go first, see OpenDocument v1.2 part 3: Packages
-    if (reader.store()->hasFile("mimetype")) {
-        if (!copyFile(*reader.store(), *out, "mimetype")) {
-            m_lastError = i18n("Failed to load manifest file");
-            delete out;
-            return 0;
-        }
-    }
-    if (!copyFile(*reader.store(), *out, "META-INF/manifest.xml")) {
+    if (!copyFile(*out, "META-INF/manifest.xml")) {
         m_lastError = i18n("Failed to write manifest file");
         delete out;
         return 0;
     }
-
-    KoXmlElement e;
-    forEachElement(e, manifest.documentElement()) {
-        dbgRG<<e.tagName()<<e.attributeNames();
-        QString file;
-        if (e.hasAttribute("full-path")) {
-            file = e.attribute("full-path");
-            if (file.isEmpty() || file == "content.xml" || file.endsWith("/")) {
-                file.clear();
-                continue;
-            }
-        }
-        if (!file.isEmpty()) {
-            m_manifestfiles << file;
-        }
-    }
+    m_manifestfiles = m_template->manifestFiles;
     return out;
 }
 
-KoXmlWriter *ReportGeneratorOdt::createOasisXmlWriter(KoOdfReadStore &reader, QBuffer *buffer, const QString fileName, const char *rootElementName)
+bool ReportGeneratorOdt::loadAndParse(const QString &fileName, KoXmlDocument &doc)
 {
-    if (!reader.store()) {
-        m_lastError = i18n("No store backend");
-        dbgRG<<"No store";
-        return 0;
-    }
-    dbgRGTmp<<fileName<<rootElementName<<"has file:"<<reader.store()->hasFile(fileName);
-    if (reader.store()->isOpen()) {
-        reader.store()->close();
-    }
-    if (!reader.store()->open(fileName)) {
-        dbgRG << "Entry " << fileName << " not found!";
-        m_lastError = xi18nc("@info", "Failed to open file <filename>%1</filename> from store.", fileName);
-        return 0;
-    }
-    if (!reader.store()->device()->isOpen()) {
-        reader.store()->device()->open(QIODevice::ReadOnly);
-    }
-    KoXmlWriter *writer = 0;
-    QXmlStreamReader xml(reader.store()->device());
-    xml.setNamespaceProcessing(true);
-    while (!xml.atEnd()) {
-        xml.readNext();
-        if (xml.tokenType() == QXmlStreamReader::StartElement && !xml.namespaceDeclarations().isEmpty()) {
-            writer = new KoXmlWriter(buffer);
-            writer->startDocument(rootElementName);
-            writer->startElement(rootElementName);
-            writer->addAttribute("xmlns:calligra", KoXmlNS::calligra);
-
-            // Note: windows needs this type of iteration
-            QXmlStreamNamespaceDeclarations dcl = xml.namespaceDeclarations();
-            for (int ns = 0; ns < dcl.count(); ++ns) {
-                dbgRGTmp<<"add namespace:"<<("xmlns:" + dcl[ns].prefix())<<dcl[ns].namespaceUri();
-                writer->addAttribute(("xmlns:" + dcl[ns].prefix()).toLatin1(), dcl[ns].namespaceUri().toUtf8());
-            }
-            QXmlStreamAttributes attr = xml.attributes();
-            for (int a = 0; a < attr.count(); ++a) {
-                dbgRGTmp<<"add attribute:"<<attr[a].qualifiedName().toString()<<attr[a].value().toString();
-                writer->addAttribute(attr[a].qualifiedName().toLatin1(), attr[a].value().toUtf8());
-            }
-        }
+    if (!m_template->files.contains(fileName)) {
+        dbgRG<<"Entry"<<fileName<<"not found!";
+        m_lastError = i18n("Could not find %1", fileName);
+        return false;
     }
-    reader.store()->close();
-    if (!writer) {
+    QByteArray data = m_template->files.value(fileName);
+    QBuffer buffer(&data);
+    return KoOdfReadStore::loadAndParse(&buffer, doc, m_lastError, fileName);
+}
+
+KoXmlWriter *ReportGeneratorOdt::createOasisXmlWriter(QIODevice *device, const QString &fileName, const char *rootElementName)
+{
+    dbgRGTmp<<fileName<<rootElementName<<"has file:"<<m_template->files.contains(fileName);
+    if (!m_template->rootAttributes.contains(fileName)) {
         dbgRG<<"Failed to find a start elemet with namespace declarations in"<<fileName;
         m_lastError = xi18nc("@info", "Missing namespace declarations:<nl/><filename>%1</filename>", fileName);
+        return 0;
+    }
+    KoXmlWriter *writer = new KoXmlWriter(device);
+    writer->startDocument(rootElementName);
+    writer->startElement(rootElementName);
+    writer->addAttribute("xmlns:calligra", KoXmlNS::calligra);
+
+    const ReportTemplate::Attributes attributes = m_template->rootAttributes.value(fileName);
+    for (const ReportTemplate::Attributes::value_type &a : attributes) {
+        dbgRGTmp<<"add attribute:"<<a.first<<a.second;
+        writer->addAttribute(a.first.constData(), a.second);
     }
     return writer;
 }
 
-void ReportGeneratorOdt::treatEmbededObjects(KoOdfReadStore &reader, KoStore &outStore)
+void ReportGeneratorOdt::treatEmbededObjects(KoStore &outStore)
 {
     dbgRGChart;
     {QMap<QString, QString>::const_iterator it;
     for (it = m_embededcharts.constBegin(); it != m_embededcharts.constEnd(); ++it) {
-        treatChart(reader, outStore, it.key(), it.value());
+        treatChart(outStore, it.key(), it.value());
     }}
     {QMap<QString, QString>::const_iterator it;
     for (it = m_embededgantts.constBegin(); it != m_embededgantts.constEnd(); ++it) {
-        treatGantt(reader, outStore, it.key(), it.value());
+        treatGantt(outStore, it.key(), it.value());
     }}
 }
 
-void ReportGeneratorOdt::treatChart(KoOdfReadStore &reader, KoStore &outStore, const QString &name, const QString &dir)
+void ReportGeneratorOdt::treatChart(KoStore &outStore, const QString &name, const QString &dir)
 {
     dbgRGChart<<name<<dir;
     if (!m_userfields.contains(name)) {
@@ -963,10 +1059,9 @@ void ReportGeneratorOdt::treatChart(KoOdfReadStore &reader, KoStore &outStore, c
     QString file = dir + "/content.xml";
     file = file.remove("./");
     dbgRGChart<<file<<m_manifestfiles;
-    QString err;
     KoXmlDocument doc;
-    if (!reader.loadAndParse(file, doc, err)) {
-        dbgRGChart<<err;
+    if (!loadAndParse(file, doc)) {
+        dbgRGChart<<m_lastError;
         return;
     }
     m_activefields << name;
@@ -998,16 +1093,18 @@ void ReportGeneratorOdt::treatChart(KoOdfReadStore &reader, KoStore &outStore, c
         dbgRGChart<<field;
 
     }
-    QBuffer buffer;
-    KoXmlWriter *writer = createOasisXmlWriter(reader, &buffer, file, "office:document-content");
+    if (outStore.open(file)) {
+        KoStoreDevice device(&outStore);
+        KoXmlWriter *writer = createOasisXmlWriter(&device, file, "office:document-content");
+        if (writer) {
+            writeChartElements(*writer, doc.documentElement());
 
-    writeChartElements(*writer, doc.documentElement());
-
-    writer->endElement(); // office:document-content
-    writer->endDocument();
-
-    dbgRGChart<<writer->toString();
-    if (!outStore.addDataToFile(buffer.buffer(), file)) {
+            writer->endElement(); // office:document-content
+            writer->endDocument();
+            delete writer;
+        }
+        outStore.close();
+    } else {
         dbgRGChart<<"Failed to open"<<file<<"for writing";
         m_lastError = i18n("Failed to write to store: %1", file);
     }
@@ -1016,9 +1113,8 @@ void ReportGeneratorOdt::treatChart(KoOdfReadStore &reader, KoStore &outStore, c
     dbgRGChart<<m_manifestfiles;
 }
 
-void ReportGeneratorOdt::treatGantt(KoOdfReadStore &reader, KoStore &outStore, const QString &name, const QString &file)
+void ReportGeneratorOdt::treatGantt(KoStore &outStore, const QString &name, const QString &file)
 {
-    Q_UNUSED(reader);
     Q_UNUSED(outStore);
     Q_UNUSED(name);
     Q_UNUSED(file);
@@ -1228,17 +1324,28 @@ QAbstractItemModel *ReportGeneratorOdt::dataModel(const QString &name) const
 void ReportGeneratorOdt::UserField::setModel(QAbstractItemModel *model, int role)
 {
     headerNames.clear();
+    headerColumns.clear();
+    bindings.clear();
     this->model.setSourceModel(model);
     for (int c = 0; c < this->model.columnCount(); ++c) {
         headerNames << this->model.headerData(c, Qt::Horizontal, role).toString().toLower();
+        if (!headerColumns.contains(headerNames.last())) {
+            headerColumns.insert(headerNames.last(), c);
+        }
     }
 }
 
 int ReportGeneratorOdt::UserField::column(const QString &columnName) const
 {
+    // this is called for every cell, so resolve each name only once
+    QHash<QString, int>::const_iterator it = bindings.constFind(columnName);
+    if (it != bindings.constEnd()) {
+        return it.value();
+    }
     QStringList l = columnName.split('.');
-    int c = l.isEmpty() ? -1 : headerNames.indexOf(l.last().toLower());
+    int c = l.isEmpty() ? -1 : headerColumns.value(l.last().toLower(), -1);
     dbgRGTable<<"  column:"<<columnName<<'='<<c;
+    bindings.insert(columnName, c);
     return c;
 }
 
@@ -28,6 +28,8 @@
 
 #include <qdom.h>
 #include <QSortFilterProxyModel>
+#include <QSharedPointer>
+#include <QHash>
 
 class QIODevice;
 class QString;
@@ -44,8 +46,15 @@ namespace KPlato
 class Project;
 class ScheduleManager;
 class ItemModelBase;
-
-
+class ReportTemplate;
+
+/**
+ * Generates an odt report from an odt template.
+ *
+ * The template file is read and prepared once and cached by file name and
+ * modification time, so generating many reports from the same template
+ * does not unpack it again.
+ */
 class PLANMODELS_EXPORT ReportGeneratorOdt : public ReportGenerator
 {
 public:
@@ -57,7 +66,13 @@ public:
 
     bool createReport();
 
+    /// Remove all templates from the template cache, they are read from file again when used
+    static void clearTemplateCache();
+
 protected:
+    /// The template in use, shared with all generators that use the same unmodified template file
+    const ReportTemplate *reportTemplate() const { return m_template.data(); }
+
     bool createReportOdt();
     bool handleTextP(KoXmlWriter &writer, const KoXmlElement &textp);
     void handleDrawFrame(KoXmlWriter &writer, const KoXmlElement &frame);
@@ -68,13 +83,14 @@ protected:
     void treatUserFieldGet(KoXmlWriter &writer, const KoXmlElement &e);
     void writeElementAttributes(KoXmlWriter &writer, const KoXmlElement &element, const QStringList &exclude = QStringList());
     void writeChildElements(KoXmlWriter &writer, const KoXmlElement &parent);
-    bool copyFile(KoStore &from, KoStore &to, const QString &file);
-    KoStore *copyStore(KoOdfReadStore &reader, const QString &outfile);
-    KoXmlWriter *createOasisXmlWriter(KoOdfReadStore &reader, QBuffer *buffer, const QString fileName, const char *rootElementName);
-
-    void treatEmbededObjects(KoOdfReadStore &reader, KoStore &outStore);
-    void treatChart(KoOdfReadStore &reader, KoStore &outStore, const QString &name, const QString &file);
-    void treatGantt(KoOdfReadStore &reader, KoStore &outStore, const QString &name, const QString &file);
+    bool copyFile(KoStore &to, const QString &file);
+    KoStore *copyStore(const QString &outfile);
+    bool loadAndParse(const QString &fileName, KoXmlDocument &doc);
+    KoXmlWriter *createOasisXmlWriter(QIODevice *device, const QString &fileName, const char *rootElementName);
+
+    void treatEmbededObjects(KoStore &outStore);
+    void treatChart(KoStore &outStore, const QString &name, const QString &file);
+    void treatGantt(KoStore &outStore, const QString &name, const QString &file);
     void writeChartElements(KoXmlWriter &writer, const KoXmlElement &parent);
 
     void listChildNodes(const QDomNode &parent);
@@ -103,6 +119,8 @@ public:
         QString dataName; // Name associated with the data (eg: tasks)
         QStringList properties; // Info on how to handle the data (eg: values=bcws,bcwp,acwp)
         QStringList headerNames; // Lowercase list of all header names
+        QHash<QString, int> headerColumns; // Column of each of the headerNames
+        mutable QHash<QString, int> bindings; // Column of each column name used in the template, resolved on first use
         QStringList columns; // Lowercase list of headernames that shall be used
         QSortFilterProxyModel model;
         int seqNr; // A sequence number used to tabulate column names (eg: seqNr=2: table1.name2)
@@ -115,7 +133,7 @@ public:
     UserField *findUserField(const KoXmlElement &decl) const;
 
 private:
-    KoStore *m_templateStore;
+    QSharedPointer<const ReportTemplate> m_template;
     QStringList m_manifestfiles;
 
     QList<QString> m_sortedfields;
@@ -27,6 +27,7 @@
 #include <QStandardItemModel>
 #include <QStandardItem>
 #include <QSortFilterProxyModel>
+#include <QSignalSpy>
 
 #include <QTest>
 
@@ -617,6 +618,110 @@ void FlatProxyModelTester::testWithNodeItemModel()
     QCOMPARE(flatmodel.data(idx), QVariant("T3"));
 }
 
+// Returns the names in column 0 of the flat model
+static QStringList flatNames( const FlatProxyModel &model )
+{
+    QStringList names;
+    for ( int row = 0; row < model.rowCount(); ++row ) {
+        names << model.index( row, 0 ).data().toString();
+    }
+    return names;
+}
+
+void FlatProxyModelTester::testIncrementalUpdates()
+{
+    Project project;
+    Task *s1 = project.createTask();
+    s1->setName("S1");
+    project.addSubTask(s1, &project);
+    Task *s11 = project.createTask();
+    s11->setName("S1.1");
+    project.addSubTask(s11, s1);
+    Task *t = project.createTask();
+    t->setName("T1.1.1");
+    project.addSubTask(t, s11);
+    Task *s2 = project.createTask();
+    s2->setName("S2");
+    project.addSubTask(s2, &project);
+    Task *s21 = project.createTask();
+    s21->setName("S2.1");
+    project.addSubTask(s21, s2);
+    t = project.createTask();
+    t->setName("T2.1.1");
+    project.addSubTask(t, s21);
+    Task *t3 = project.createTask();
+    t3->setName("T3");
+    project.addSubTask(t3, &project);
+
+    NodeItemModel model;
+    model.setProject(&project);
+
+    FlatProxyModel flatmodel;
+    flatmodel.setSourceModel(&model);
+    QCOMPARE(flatNames(flatmodel), QStringList() << "S1" << "S1.1" << "T1.1.1" << "S2" << "S2.1" << "T2.1.1" << "T3");
+
+    QSignalSpy reset(&flatmodel, &QAbstractItemModel::modelReset);
+    QSignalSpy inserted(&flatmodel, &QAbstractItemModel::rowsInserted);
+    QSignalSpy removed(&flatmodel, &QAbstractItemModel::rowsRemoved);
+    QSignalSpy moved(&flatmodel, &QAbstractItemModel::rowsMoved);
+
+    // insert into a sub-summarytask
+    t = project.createTask();
+    t->setName("T1.1.2");
+    project.addSubTask(t, s11);
+    QCOMPARE(flatNames(flatmodel), QStringList() << "S1" << "S1.1" << "T1.1.1" << "T1.1.2" << "S2" << "S2.1" << "T2.1.1" << "T3");
+    QCOMPARE(inserted.count(), 1);
+    QCOMPARE(inserted.at(0).at(1).toInt(), 3);
+    QCOMPARE(inserted.at(0).at(2).toInt(), 3);
+    QCOMPARE(flatmodel.mapFromSource(model.index(t)).row(), 3);
+    QCOMPARE(flatmodel.mapFromSource(model.index(t3)).row(), 7);
+
+    // move a summarytask with children
+    QVERIFY(project.moveTask(s2, &project, 0));
+    QCOMPARE(flatNames(flatmodel), QStringList() << "S2" << "S2.1" << "T2.1.1" << "S1" << "S1.1" << "T1.1.1" << "T1.1.2" << "T3");
+    QCOMPARE(moved.count(), 1);
+    QCOMPARE(moved.at(0).at(1).toInt(), 4);
+    QCOMPARE(moved.at(0).at(2).toInt(), 6);
+    QCOMPARE(moved.at(0).at(4).toInt(), 0);
+    QCOMPARE(flatmodel.mapFromSource(model.index(s1)).row(), 3);
+    QCOMPARE(flatmodel.mapFromSource(model.index(t)).row(), 6);
+
+    // move to another parent
+    QVERIFY(project.moveTask(t3, s2, -1));
+    QCOMPARE(flatNames(flatmodel), QStringList() << "S2" << "S2.1" << "T2.1.1" << "T3" << "S1" << "S1.1" << "T1.1.1" << "T1.1.2");
+    QCOMPARE(moved.count(), 2);
+    QModelIndex idx = flatmodel.index(3, flatmodel.columnCount() - 1);
+    QCOMPARE(flatmodel.data(idx), QVariant("S2"));
+
+    // remove a summarytask with children
+    project.takeTask(s1);
+    QCOMPARE(flatNames(flatmodel), QStringList() << "S2" << "S2.1" << "T2.1.1" << "T3");
+    QCOMPARE(removed.count(), 1);
+    QCOMPARE(removed.at(0).at(1).toInt(), 4);
+    QCOMPARE(removed.at(0).at(2).toInt(), 7);
+    QCOMPARE(flatmodel.mapFromSource(model.index(t3)).row(), 3);
+
+    // and insert it again
+    project.addSubTask(s1, 0, &project);
+    QCOMPARE(flatNames(flatmodel), QStringList() << "S1" << "S1.1" << "T1.1.1" << "T1.1.2" << "S2" << "S2.1" << "T2.1.1" << "T3");
+    QCOMPARE(inserted.count(), 2);
+    QCOMPARE(inserted.at(1).at(1).toInt(), 0);
+    QCOMPARE(inserted.at(1).at(2).toInt(), 3);
+    QCOMPARE(flatmodel.mapFromSource(model.index(t3)).row(), 7);
+
+    // insert into a summarytask that has changed source row since the first move
+    t = project.createTask();
+    t->setName("T2.2");
+    project.addSubTask(t, s2);
+    QCOMPARE(flatNames(flatmodel), QStringList() << "S1" << "S1.1" << "T1.1.1" << "T1.1.2" << "S2" << "S2.1" << "T2.1.1" << "T3" << "T2.2");
+    QCOMPARE(inserted.count(), 3);
+    QCOMPARE(inserted.at(2).at(1).toInt(), 8);
+    QCOMPARE(flatmodel.mapFromSource(model.index(s2)).row(), 4);
+    QCOMPARE(flatmodel.mapFromSource(model.index(t)).row(), 8);
+
+    QCOMPARE(reset.count(), 0);
+}
+
 } //namespace KPlato
 
 QTEST_GUILESS_MAIN( KPlato::FlatProxyModelTester )
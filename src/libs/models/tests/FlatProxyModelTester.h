@@ -40,6 +40,7 @@ private Q_SLOTS:
     void testInsertRemoveChildren();
     void testInsertRemoveGrandChildren();
     void testWithNodeItemModel();
+    void testIncrementalUpdates();
 
 private:
     FlatProxyModel m_flatmodel;
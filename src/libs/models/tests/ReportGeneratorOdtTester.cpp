@@ -0,0 +1,137 @@
+/* This file is part of the KDE project
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+// clazy:excludeall=qstring-arg
+#include "ReportGeneratorOdtTester.h"
+
+#include "reportgenerator/ReportGeneratorOdt.h"
+#include "kptproject.h"
+
+#include <KoStore.h>
+
+#include <QTest>
+#include <QUrl>
+
+
+namespace KPlato
+{
+
+// Gives access to the template in use
+class TestReportGenerator : public ReportGeneratorOdt
+{
+public:
+    const void *templateData() const { return reportTemplate(); }
+};
+
+void ReportGeneratorOdtTester::initTestCase()
+{
+    QVERIFY( m_dir.isValid() );
+    m_templateFile = m_dir.path() + "/template.odt";
+    ReportGeneratorOdt::clearTemplateCache();
+}
+
+bool ReportGeneratorOdtTester::writeTemplate( const QString &text )
+{
+    QScopedPointer<KoStore> store( KoStore::createStore( m_templateFile, KoStore::Write, "application/vnd.oasis.opendocument.text", KoStore::Zip ) );
+    if ( store->bad() ) {
+        return false;
+    }
+    const QByteArray manifest =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<manifest:manifest xmlns:manifest=\"urn:oasis:names:tc:opendocument:xmlns:manifest:1.0\" manifest:version=\"1.2\">"
+        "<manifest:file-entry manifest:full-path=\"/\" manifest:media-type=\"application/vnd.oasis.opendocument.text\"/>"
+        "<manifest:file-entry manifest:full-path=\"content.xml\" manifest:media-type=\"text/xml\"/>"
+        "</manifest:manifest>";
+    const QByteArray content =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<office:document-content xmlns:office=\"urn:oasis:names:tc:opendocument:xmlns:office:1.0\""
+        " xmlns:text=\"urn:oasis:names:tc:opendocument:xmlns:text:1.0\" office:version=\"1.2\">"
+        "<office:body><office:text><text:p>" + text.toUtf8() + "</text:p></office:text></office:body>"
+        "</office:document-content>";
+    if ( ! store->open( "META-INF/manifest.xml" ) || store->write( manifest ) != manifest.size() || ! store->close() ) {
+        return false;
+    }
+    if ( ! store->open( "content.xml" ) || store->write( content ) != content.size() || ! store->close() ) {
+        return false;
+    }
+    return store->finalize();
+}
+
+// Returns the content.xml of the report, and the template it was created from in @p templateData
+QByteArray ReportGeneratorOdtTester::createReport( const QString &fileName, const void **templateData )
+{
+    Project project;
+    project.setName( "P1" );
+    const QString reportFile = m_dir.path() + '/' + fileName;
+    TestReportGenerator rg;
+    rg.setTemplateFile( m_templateFile );
+    rg.setReportFile( QUrl::fromLocalFile( reportFile ).toString() );
+    rg.setProject( &project );
+    if ( ! rg.open() ) {
+        qDebug()<<rg.lastError();
+        return QByteArray();
+    }
+    *templateData = rg.templateData();
+    if ( ! rg.createReport() ) {
+        qDebug()<<rg.lastError();
+        return QByteArray();
+    }
+    rg.close();
+
+    QScopedPointer<KoStore> store( KoStore::createStore( reportFile, KoStore::Read ) );
+    QByteArray content;
+    if ( store->bad() || ! store->extractFile( "content.xml", content ) ) {
+        return QByteArray();
+    }
+    return content;
+}
+
+void ReportGeneratorOdtTester::templateCache()
+{
+    QVERIFY( writeTemplate( "Report A" ) );
+
+    const void *t1 = 0;
+    const QByteArray first = createReport( "r1.odt", &t1 );
+    QVERIFY( t1 );
+    QVERIFY( first.contains( "Report A" ) );
+
+    // a second generator uses the cached template
+    const void *t2 = 0;
+    const QByteArray second = createReport( "r2.odt", &t2 );
+    QCOMPARE( t2, t1 );
+    QCOMPARE( second, first );
+
+    // the output is the same when the template is read from file again
+    ReportGeneratorOdt::clearTemplateCache();
+    const void *t3 = 0;
+    const QByteArray uncached = createReport( "r3.odt", &t3 );
+    QVERIFY( t3 );
+    QCOMPARE( uncached, first );
+
+    // a modified template is read again, the size is the same so only the time tells
+    QTest::qSleep( 1100 );
+    QVERIFY( writeTemplate( "Report B" ) );
+    const void *t4 = 0;
+    const QByteArray modified = createReport( "r4.odt", &t4 );
+    QVERIFY( t4 && t4 != t3 );
+    QVERIFY( modified.contains( "Report B" ) );
+    QVERIFY( ! modified.contains( "Report A" ) );
+}
+
+} //namespace KPlato
+
+QTEST_GUILESS_MAIN( KPlato::ReportGeneratorOdtTester )
@@ -578,6 +578,10 @@ void KoStore::setCompressionEnabled(bool /*e*/)
 {
 }
 
+void KoStore::setCompressionLevel(int /*level*/)
+{
+}
+
 bool KoStore::isEncrypted()
 {
     return false;
@@ -313,6 +313,13 @@ public:
      */
     virtual void setCompressionEnabled(bool e);
 
+    /**
+     * Set the compression level of the files written after this call.
+     * -1 is the backend default, 0 stores the files without compression and
+     * 1 (fastest) to 9 (smallest) are deflate levels. Only supported by the ZIP backend.
+     */
+    virtual void setCompressionLevel(int level);
+
 protected:
     KoStore(Mode mode, bool writeMimetype = true);
 
@@ -228,7 +228,7 @@ void KoXmlWriter::addAttribute(const char* attrName, const QByteArray& value)
     writeChar(' ');
     writeCString(attrName);
     writeCString("=\"");
-    char* escaped = escapeForXML(value.constData(), value.size());
+    char* escaped = escapeForXML(value.constData(), value.size(), true);
     writeCString(escaped);
     if (escaped != d->escapeBuffer)
         delete[] escaped;
@@ -240,7 +240,7 @@ void KoXmlWriter::addAttribute(const char* attrName, const char* value)
     writeChar(' ');
     writeCString(attrName);
     writeCString("=\"");
-    char* escaped = escapeForXML(value, -1);
+    char* escaped = escapeForXML(value, -1, true);
     writeCString(escaped);
     if (escaped != d->escapeBuffer)
         delete[] escaped;
@@ -293,7 +293,7 @@ void KoXmlWriter::writeString(const QString& str)
 
 // In case of a reallocation (ret value != d->buffer), the caller owns the return value,
 // it must delete it (with [])
-char* KoXmlWriter::escapeForXML(const char* source, int length = -1) const
+char* KoXmlWriter::escapeForXML(const char* source, int length, bool attribute) const
 {
     // we're going to be pessimistic on char length; so lets make the outputLength less
     // the amount one char can take: 6
@@ -344,9 +344,29 @@ char* KoXmlWriter::escapeForXML(const char* source, int length = -1) const
             *destination = '\0';
             return output;
         // Control codes accepted in XML 1.0 documents.
+        // A parser normalizes them to spaces in attribute values, so there they are written as character references.
         case 9:
+            if (attribute) {
+                memcpy(destination, "&#9;", 4);
+                destination += 4;
+                break;
+            }
+            *destination++ = *src++;
+            continue;
         case 10:
+            if (attribute) {
+                memcpy(destination, "&#10;", 5);
+                destination += 5;
+                break;
+            }
+            *destination++ = *src++;
+            continue;
         case 13:
+            if (attribute) {
+                memcpy(destination, "&#13;", 5);
+                destination += 5;
+                break;
+            }
             *destination++ = *src++;
             continue;
         default:
@@ -284,7 +284,7 @@ private:
             writeChar('>');
         }
     }
-    char* escapeForXML(const char* source, int length) const;
+    char* escapeForXML(const char* source, int length, bool attribute = false) const;
     bool prepareForChild();
     void prepareForTextNode();
     void init();
@@ -21,9 +21,12 @@
 // clazy:excludeall=qstring-arg
 #include "KoZipStore.h"
 #include "KoStore_p.h"
+#include "KoZipWriter.h"
 
 #include <QBuffer>
 #include <QByteArray>
+#include <QFile>
+#include <QSaveFile>
 
 #include <kzip.h>
 #include <StoreDebug.h>
@@ -34,6 +37,7 @@
 KoZipStore::KoZipStore(const QString & _filename, Mode mode, const QByteArray & appIdentification,
                        bool writeMimetype)
   : KoStore(mode, writeMimetype)
+  , m_device(0)
 {
     debugStore << "KoZipStore Constructor filename =" << _filename
     << " mode = " << int(mode)
@@ -42,22 +46,21 @@ KoZipStore::KoZipStore(const QString & _filename, Mode mode, const QByteArray &
 
     d->localFileName = _filename;
 
-    m_pZip = new KZip(_filename);
-
     init(appIdentification);   // open the zip file and init some vars
 }
 
 KoZipStore::KoZipStore(QIODevice *dev, Mode mode, const QByteArray & appIdentification,
                        bool writeMimetype)
   : KoStore(mode, writeMimetype)
+  , m_device(dev)
 {
-    m_pZip = new KZip(dev);
     init(appIdentification);
 }
 
 KoZipStore::KoZipStore(QWidget* window, const QUrl &_url, const QString & _filename, Mode mode,
                        const QByteArray & appIdentification, bool writeMimetype)
   : KoStore(mode, writeMimetype)
+  , m_device(0)
 {
     debugStore << "KoZipStore Constructor url" << _url.url(QUrl::PreferLocalFile)
     << " filename = " << _filename
@@ -77,7 +80,6 @@ KoZipStore::KoZipStore(QWidget* window, const QUrl &_url, const QString & _filen
         d->localFileName = QLatin1String("/tmp/kozip"); // ### FIXME with KTempFile
     }
 
-    m_pZip = new KZip(d->localFileName);
     init(appIdentification);   // open the zip file and init some vars
 }
 
@@ -88,6 +90,10 @@ KoZipStore::~KoZipStore()
     if (!d->finalized)
         finalize(); // ### no error checking when the app forgot to call finalize itself
     delete m_pZip;
+    delete m_writer;
+    delete m_saveFile;
+    delete m_mappedBuffer;
+    delete m_mappedFile; // unmaps the file
 
     // Now we have still some job to do for remote files.
     if (d->fileMode == KoStorePrivate::RemoteRead) {
@@ -103,48 +109,95 @@ void KoZipStore::init(const QByteArray& appIdentification)
     Q_D(KoStore);
 
     m_currentDir = 0;
-    d->good = m_pZip->open(d->mode == Write ? QIODevice::WriteOnly : QIODevice::ReadOnly);
-
-    if (!d->good)
-        return;
+    m_pZip = 0;
+    m_mappedFile = 0;
+    m_mappedBuffer = 0;
+    m_writer = 0;
+    m_saveFile = 0;
+    m_compressionLevel = -1;
 
     if (d->mode == Write) {
-        //debugStore <<"KoZipStore::init writing mimetype" << appIdentification;
+        QIODevice *device = m_device;
+        if (!device) {
+            m_saveFile = new QSaveFile(d->localFileName);
+            device = m_saveFile;
+        }
+        d->good = device->isOpen() ? device->isWritable() : device->open(QIODevice::WriteOnly);
+        if (!d->good)
+            return;
 
-        m_pZip->setCompression(KZip::NoCompression);
-        m_pZip->setExtraField(KZip::NoExtraField);
+        m_writer = new KoZipWriter(device);
 
-        // Write identification
+        // Write identification, it must be stored uncompressed
         if (d->writeMimetype) {
-            (void)m_pZip->writeFile(QLatin1String("mimetype"), appIdentification);
+            m_writer->setCompressionLevel(0);
+            m_writer->addEntry(QLatin1String("mimetype"), appIdentification);
         }
-
-        m_pZip->setCompression(KZip::DeflateCompression);
-        // We don't need the extra field in Calligra - so we leave it as "no extra field".
+        m_writer->setCompressionLevel(m_compressionLevel);
     } else {
-        d->good = m_pZip->directory() != 0;
+        if (m_device) {
+            m_pZip = new KZip(m_device);
+        } else {
+            // Map the file into memory so KZip reads it without a read() per block
+            m_mappedFile = new QFile(d->localFileName);
+            uchar *data = 0;
+            if (m_mappedFile->open(QIODevice::ReadOnly) && m_mappedFile->size() > 0) {
+                data = m_mappedFile->map(0, m_mappedFile->size());
+            }
+            if (data) {
+                m_mappedBuffer = new QBuffer();
+                m_mappedBuffer->setData(QByteArray::fromRawData(reinterpret_cast<const char*>(data), m_mappedFile->size()));
+                m_pZip = new KZip(m_mappedBuffer);
+            } else {
+                delete m_mappedFile;
+                m_mappedFile = 0;
+                m_pZip = new KZip(d->localFileName);
+            }
+        }
+        d->good = m_pZip->open(QIODevice::ReadOnly) && m_pZip->directory() != 0;
     }
 }
 
 void KoZipStore::setCompressionEnabled(bool e)
 {
-    if (e) {
-        m_pZip->setCompression(KZip::DeflateCompression);
-    } else {
-        m_pZip->setCompression(KZip::NoCompression);        
+    setCompressionLevel(e ? -1 : 0);
+}
+
+void KoZipStore::setCompressionLevel(int level)
+{
+    m_compressionLevel = level;
+    if (m_writer) {
+        m_writer->setCompressionLevel(level);
     }
 }
 
 bool KoZipStore::doFinalize()
 {
-    return m_pZip->close();
+    Q_D(KoStore);
+    if (d->mode == Read) {
+        return m_pZip->close();
+    }
+    if (!m_writer) {
+        return false;
+    }
+    bool ok = m_writer->finish();
+    if (m_saveFile) {
+        if (ok) {
+            ok = m_saveFile->commit();
+        } else {
+            m_saveFile->cancelWriting();
+        }
+    }
+    return ok;
 }
 
 bool KoZipStore::openWrite(const QString& name)
 {
     Q_D(KoStore);
     d->stream = 0; // Don't use!
-    return m_pZip->prepareWriting(name, "", "" /*m_pZip->rootDir()->user(), m_pZip->rootDir()->group()*/, 0);
+    Q_UNUSED(name); // d->fileName is used when the file is closed
+    m_entryData.clear();
+    return m_writer != 0;
 }
 
 bool KoZipStore::openRead(const QString& name)
@@ -182,14 +235,16 @@ qint64 KoZipStore::write(const char* _data, qint64 _len)
     }
 
     d->size += _len;
-    if (m_pZip->writeData(_data, _len))     // writeData returns a bool!
-        return _len;
-    return 0;
+    m_entryData.append(_data, _len);
+    return _len;
 }
 
 QStringList KoZipStore::directoryList() const
 {
     QStringList retval;
+    if (!m_pZip) {
+        return retval;
+    }
     const KArchiveDirectory *directory = m_pZip->directory();
     foreach(const QString &name, directory->entries()) {
         const KArchiveEntry* fileArchiveEntry = m_pZip->directory()->entry(name);
@@ -204,7 +259,10 @@ bool KoZipStore::closeWrite()
 {
     Q_D(KoStore);
     debugStore << "Wrote file" << d->fileName << " into ZIP archive. size" << d->size;
-    return m_pZip->finishWriting(d->size);
+    // the writer compresses the file in a worker thread while the next one is written
+    m_writer->addEntry(d->fileName, m_entryData);
+    m_entryData.clear();
+    return true;
 }
 
 bool KoZipStore::enterRelativeDirectory(const QString& dirName)
@@ -227,6 +285,10 @@ bool KoZipStore::enterRelativeDirectory(const QString& dirName)
 
 bool KoZipStore::enterAbsoluteDirectory(const QString& path)
 {
+    Q_D(KoStore);
+    if (d->mode == Write) {
+        return true; // no checking here
+    }
     if (path.isEmpty()) {
         m_currentDir = 0;
         return true;
@@ -238,6 +300,10 @@ bool KoZipStore::enterAbsoluteDirectory(const QString& path)
 
 bool KoZipStore::fileExists(const QString& absPath) const
 {
+    Q_D(const KoStore);
+    if (d->mode == Write) {
+        return d->filesList.contains(absPath);
+    }
     const KArchiveEntry *entry = m_pZip->directory()->entry(absPath);
     return entry && entry->isFile();
 }
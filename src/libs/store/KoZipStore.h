@@ -22,10 +22,21 @@
 
 #include "KoStore.h"
 
+class KoZipWriter;
 class KZip;
 class KArchiveDirectory;
+class QBuffer;
+class QFile;
+class QSaveFile;
 class QUrl;
 
+/**
+ * A store backed by a zip archive.
+ *
+ * When reading, the archive is mapped into memory if possible.
+ * When writing, the files are compressed by a KoZipWriter, which deflates
+ * independent files in parallel, and the archive is written on finalize().
+ */
 class KoZipStore : public KoStore
 {
 public:
@@ -42,6 +53,7 @@ public:
     ~KoZipStore();
 
     virtual void setCompressionEnabled(bool e);
+    virtual void setCompressionLevel(int level);
     virtual qint64 write(const char* _data, qint64 _len);
 
     virtual QStringList directoryList() const;
@@ -61,9 +73,24 @@ protected:
 
 private:
 
-    /// The archive
+    /// The device given in the constructor, if any
+    QIODevice *m_device;
+
+    /// The archive, in read mode
     KZip * m_pZip;
 
+    /// The memory mapped file and the buffer reading it, in read mode
+    QFile *m_mappedFile;
+    QBuffer *m_mappedBuffer;
+
+    /// The archive writer and the file it writes to, in write mode
+    KoZipWriter *m_writer;
+    QSaveFile *m_saveFile;
+
+    /// The data of the file currently open for writing
+    QByteArray m_entryData;
+    int m_compressionLevel;
+
     /** In "Read" mode this pointer is pointing to the
     current directory in the archive to speed up the verification process */
     const KArchiveDirectory* m_currentDir;
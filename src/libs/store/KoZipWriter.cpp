@@ -0,0 +1,212 @@
+/* This file is part of the KDE project
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+*/
+
+// clazy:excludeall=qstring-arg
+#include "KoZipWriter.h"
+
+#include <StoreDebug.h>
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QIODevice>
+#include <QRunnable>
+#include <QString>
+#include <QtEndian>
+
+#include <zlib.h>
+
+#include <cstring>
+
+namespace {
+
+void putShort(QByteArray &buffer, quint16 value)
+{
+    uchar b[2];
+    qToLittleEndian<quint16>(value, b);
+    buffer.append(reinterpret_cast<const char*>(b), 2);
+}
+
+void putLong(QByteArray &buffer, quint32 value)
+{
+    uchar b[4];
+    qToLittleEndian<quint32>(value, b);
+    buffer.append(reinterpret_cast<const char*>(b), 4);
+}
+
+/// Compress @p data as a raw deflate stream, as used in zip archives
+bool deflateData(const QByteArray &data, int level, QByteArray &result)
+{
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (deflateInit2(&stream, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return false;
+    }
+    result.resize(deflateBound(&stream, data.size()));
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.constData()));
+    stream.avail_in = data.size();
+    stream.next_out = reinterpret_cast<Bytef*>(result.data());
+    stream.avail_out = result.size();
+    const int ret = deflate(&stream, Z_FINISH);
+    result.resize(stream.total_out);
+    deflateEnd(&stream);
+    return ret == Z_STREAM_END;
+}
+
+}
+
+/// An entry in the archive, compressed by the thread pool
+class KoZipWriter::Entry : public QRunnable
+{
+public:
+    Entry(const QString &name, const QByteArray &data, int level)
+        : name(name.toUtf8())
+        , data(data)
+        , level(level)
+        , crc(0)
+        , size(data.size())
+        , deflated(false)
+        , offset(0)
+    {
+        setAutoDelete(false);
+        const QDateTime now = QDateTime::currentDateTime();
+        const QDate date = now.date();
+        const QTime time = now.time();
+        dosTime = (time.hour() << 11) | (time.minute() << 5) | (time.second() / 2);
+        dosDate = ((date.year() - 1980) << 9) | (date.month() << 5) | date.day();
+    }
+
+    void run() {
+        crc = crc32(0L, Z_NULL, 0);
+        crc = crc32(crc, reinterpret_cast<const Bytef*>(data.constData()), data.size());
+        if (level != 0) {
+            QByteArray result;
+            // keep the data uncompressed if it does not get smaller
+            if (deflateData(data, level, result) && result.size() < data.size()) {
+                data = result;
+                deflated = true;
+            }
+        }
+    }
+
+    /// The part of the header that is equal in the local header and the central directory
+    void putCommonHeader(QByteArray &buffer) const {
+        putShort(buffer, deflated ? 20 : 10); // version needed to extract
+        putShort(buffer, 0x0800); // flags: utf-8 names
+        putShort(buffer, deflated ? 8 : 0); // compression method
+        putShort(buffer, dosTime);
+        putShort(buffer, dosDate);
+        putLong(buffer, crc);
+        putLong(buffer, data.size());
+        putLong(buffer, size);
+        putShort(buffer, name.size());
+        putShort(buffer, 0); // extra field length
+    }
+
+    QByteArray name;
+    QByteArray data;
+    int level;
+    quint32 crc;
+    qint64 size;
+    bool deflated;
+    quint16 dosTime;
+    quint16 dosDate;
+    qint64 offset;
+};
+
+KoZipWriter::KoZipWriter(QIODevice *device)
+    : m_device(device)
+    , m_level(-1)
+{
+}
+
+KoZipWriter::~KoZipWriter()
+{
+    m_pool.waitForDone();
+    qDeleteAll(m_entries);
+}
+
+void KoZipWriter::setCompressionLevel(int level)
+{
+    m_level = qBound(-1, level, 9);
+}
+
+int KoZipWriter::compressionLevel() const
+{
+    return m_level;
+}
+
+void KoZipWriter::addEntry(const QString &name, const QByteArray &data)
+{
+    Entry *entry = new Entry(name, data, m_level);
+    m_entries << entry;
+    if (m_level == 0) {
+        entry->run(); // just the checksum
+    } else {
+        m_pool.start(entry);
+    }
+}
+
+bool KoZipWriter::finish()
+{
+    m_pool.waitForDone();
+
+    if (m_entries.count() > 0xffff) {
+        errorStore << "Too many entries in zip archive:" << m_entries.count();
+        return false;
+    }
+    qint64 offset = 0;
+    foreach (Entry *entry, m_entries) {
+        entry->offset = offset;
+        QByteArray header;
+        putLong(header, 0x04034b50);
+        entry->putCommonHeader(header);
+        header += entry->name;
+        if (m_device->write(header) != header.size() || m_device->write(entry->data) != entry->data.size()) {
+            errorStore << "Failed to write zip entry" << entry->name;
+            return false;
+        }
+        offset += header.size() + entry->data.size();
+        entry->data.clear();
+    }
+    QByteArray directory;
+    foreach (const Entry *entry, m_entries) {
+        putLong(directory, 0x02014b50);
+        putShort(directory, (3 << 8) | 20); // made by unix, zip 2.0
+        entry->putCommonHeader(directory);
+        putShort(directory, 0); // file comment length
+        putShort(directory, 0); // disk number start
+        putShort(directory, 0); // internal attributes
+        putLong(directory, 0100644 << 16); // external attributes: regular file, rw-r--r--
+        putLong(directory, entry->offset);
+        directory += entry->name;
+    }
+    if (offset + directory.size() > 0xffffffffLL) {
+        errorStore << "Zip archive too large:" << offset + directory.size();
+        return false;
+    }
+    const quint32 directorySize = directory.size();
+    putLong(directory, 0x06054b50);
+    putShort(directory, 0); // number of this disk
+    putShort(directory, 0); // disk where the central directory starts
+    putShort(directory, m_entries.count()); // entries on this disk
+    putShort(directory, m_entries.count()); // total number of entries
+    putLong(directory, directorySize); // size of the central directory
+    putLong(directory, offset); // offset of the central directory
+    putShort(directory, 0); // comment length
+    return m_device->write(directory) == directory.size();
+}
@@ -0,0 +1,69 @@
+/* This file is part of the KDE project
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+*/
+
+#ifndef koZipWriter_h
+#define koZipWriter_h
+
+#include <QList>
+#include <QThreadPool>
+
+class QByteArray;
+class QIODevice;
+class QString;
+
+/**
+ * Writes a zip archive to a device.
+ *
+ * Each entry is deflated by a thread pool as soon as it is added, so independent
+ * entries are compressed in parallel while the next one is produced.
+ * The archive is written by finish(), with the entries in the order they were added.
+ *
+ * Only what KoStore needs is supported: files, no directories,
+ * no extra fields and no zip64 extensions.
+ */
+class KoZipWriter
+{
+public:
+    /// Write to @p device, which must be open for writing. The device is not closed.
+    explicit KoZipWriter(QIODevice *device);
+    ~KoZipWriter();
+
+    /**
+     * Set the deflate level of the entries added after this call.
+     * -1 is the zlib default, 0 stores the entries without compression,
+     * 1 (fastest) to 9 (smallest) are zlib levels.
+     */
+    void setCompressionLevel(int level);
+    int compressionLevel() const;
+
+    /// Add an entry called @p name with @p data
+    void addEntry(const QString &name, const QByteArray &data);
+
+    /// Wait for the compression to finish and write the archive. Returns false on error.
+    bool finish();
+
+private:
+    class Entry;
+
+    QIODevice *m_device;
+    int m_level;
+    QList<Entry*> m_entries;
+    QThreadPool m_pool;
+};
+
+#endif
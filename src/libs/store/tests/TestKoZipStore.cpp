@@ -0,0 +1,130 @@
+/* This file is part of the KDE project
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+// clazy:excludeall=qstring-arg
+#include "TestKoZipStore.h"
+
+#include <KoStore.h>
+
+#include <QBuffer>
+#include <QScopedPointer>
+#include <QTemporaryDir>
+#include <QTest>
+
+static QByteArray entryData(int i)
+{
+    QByteArray data;
+    for (int j = 0; j < (i + 1) * 1000; ++j) {
+        data += QByteArray::number(i * j % 97) + ' ';
+    }
+    return data;
+}
+
+void TestKoZipStore::testRoundtrip_data()
+{
+    QTest::addColumn<int>("level");
+    QTest::addColumn<int>("entries");
+
+    QTest::newRow("stored") << 0 << 10;
+    QTest::newRow("fastest") << 1 << 10;
+    QTest::newRow("default") << -1 << 100;
+    QTest::newRow("smallest") << 9 << 10;
+}
+
+void TestKoZipStore::testRoundtrip()
+{
+    QFETCH(int, level);
+    QFETCH(int, entries);
+
+    QByteArray archive;
+    QBuffer buffer(&archive);
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+    QScopedPointer<KoStore> out(KoStore::createStore(&buffer, KoStore::Write, "application/x-test", KoStore::Zip));
+    QVERIFY(!out->bad());
+    out->setCompressionLevel(level);
+    for (int i = 0; i < entries; ++i) {
+        QVERIFY(out->open(QString("dir/entry%1.txt").arg(i)));
+        const QByteArray data = entryData(i);
+        QCOMPARE(out->write(data), qint64(data.size()));
+        QVERIFY(out->close());
+    }
+    QVERIFY(out->open("empty"));
+    QVERIFY(out->close());
+    QVERIFY(out->finalize());
+    out.reset();
+    buffer.close();
+
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    QScopedPointer<KoStore> in(KoStore::createStore(&buffer, KoStore::Read, "", KoStore::Zip));
+    QVERIFY(!in->bad());
+    for (int i = 0; i < entries; ++i) {
+        QVERIFY(in->open(QString("dir/entry%1.txt").arg(i)));
+        QCOMPARE(in->read(in->size()), entryData(i));
+        QVERIFY(in->close());
+    }
+    QVERIFY(in->open("empty"));
+    QCOMPARE(in->size(), qint64(0));
+    QVERIFY(in->close());
+}
+
+void TestKoZipStore::testRoundtripFile()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.path() + "/test.zip";
+
+    QScopedPointer<KoStore> out(KoStore::createStore(fileName, KoStore::Write, "application/x-test", KoStore::Zip));
+    QVERIFY(!out->bad());
+    for (int i = 0; i < 10; ++i) {
+        QVERIFY(out->open(QString("entry%1").arg(i)));
+        out->write(entryData(i));
+        QVERIFY(out->close());
+    }
+    QVERIFY(out->finalize());
+    out.reset();
+
+    // read through the memory mapped file
+    QScopedPointer<KoStore> in(KoStore::createStore(fileName, KoStore::Read, "", KoStore::Zip));
+    QVERIFY(!in->bad());
+    for (int i = 9; i >= 0; --i) {
+        QVERIFY(in->open(QString("entry%1").arg(i)));
+        QCOMPARE(in->read(in->size()), entryData(i));
+        QVERIFY(in->close());
+    }
+}
+
+void TestKoZipStore::testMimetypeStored()
+{
+    QByteArray archive;
+    QBuffer buffer(&archive);
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+    QScopedPointer<KoStore> out(KoStore::createStore(&buffer, KoStore::Write, "application/x-test", KoStore::Zip));
+    QVERIFY(out->open("root"));
+    out->write(entryData(10));
+    QVERIFY(out->close());
+    QVERIFY(out->finalize());
+    out.reset();
+
+    // ODF requires the mimetype to be the first entry, uncompressed, at offset 38
+    QCOMPARE(archive.left(4), QByteArray("PK\x03\x04"));
+    QCOMPARE(archive[8], '\0'); // compression method: stored
+    QCOMPARE(archive.mid(30, 8), QByteArray("mimetype"));
+    QCOMPARE(archive.mid(38, 18), QByteArray("application/x-test"));
+}
+
+QTEST_GUILESS_MAIN(TestKoZipStore)
@@ -1145,6 +1145,18 @@ void DependencyScene::drawBackground ( QPainter *painter, const QRectF &rect )
 QList<QGraphicsItem*> DependencyScene::itemList( int type ) const
 {
     QList<QGraphicsItem*> lst;
+    if ( type == DependencyNodeItem::Type ) {
+        foreach ( DependencyNodeItem *i, m_nodeItems ) {
+            lst << i;
+        }
+        return lst;
+    }
+    if ( type == DependencyLinkItem::Type ) {
+        foreach ( DependencyLinkItem *i, m_linkItems ) {
+            lst << i;
+        }
+        return lst;
+    }
     foreach ( QGraphicsItem *i, items() ) {
         if ( i->type() == type ) {
             lst << i;
@@ -1156,14 +1168,19 @@ QList<QGraphicsItem*> DependencyScene::itemList( int type ) const
 void DependencyScene::clearScene()
 {
     m_connectionitem->clear();
-    QList<QGraphicsItem*> its, deps;
-    foreach ( QGraphicsItem *i, items() ) {
-        if ( i->type() == DependencyNodeItem::Type && i->parentItem() == 0 ) {
+    QList<QGraphicsItem*> its;
+    foreach ( DependencyNodeItem *i, m_nodeItems ) {
+        // top level graphics items delete their graphics children
+        if ( i->QGraphicsItem::parentItem() == 0 ) {
             its << i;
-        } else if ( i->type() == DependencyLinkItem::Type ) {
-            deps << i;
         }
     }
+    QList<DependencyLinkItem*> deps = m_linkItems.values();
+    m_linkItems.clear();
+    m_nodeItems.clear();
+    m_allItems.clear();
+    m_visibleItems.clear();
+    m_hiddenItems.clear();
     qDeleteAll( deps );
     qDeleteAll( its );
     removeItem( m_connectionitem );
@@ -1218,11 +1235,17 @@ void DependencyScene::setItemVisible( DependencyNodeItem *item, bool show )
 {
     //debugPlanDepEditor<<"Visible count="<<m_visibleItems.count()<<" total="<<m_allItems.count();
     item->setItemVisible( show );
-    int row = m_allItems.indexOf( item );
+    int row = m_allItems.lastIndexOf( item );
     if ( row == -1 ) {
         debugPlanDepEditor<<"Unknown item!!";
         return;
     }
+    if ( show && row == m_allItems.count() - 1 && ! m_visibleItems.contains( row ) && ! m_hiddenItems.contains( row ) ) {
+        // A new item appended at the end, the rows of the other items are not affected
+        m_visibleItems.insert( row, item );
+        item->setRow( m_visibleItems.count() - 1 );
+        return;
+    }
     if (show && CONTAINS(m_hiddenItems, item)) {
         moveItem( item, m_project->flatNodeList() ); // might have been moved
     }
@@ -1266,7 +1289,8 @@ DependencyNodeItem *DependencyScene::createItem( Node *node )
     DependencyNodeItem *after = itemBefore( parent, node );
     int i = m_allItems.count()-1;
     if ( after ) {
-        i = m_allItems.indexOf( after );
+        // when building the scene items are appended, so search from the end
+        i = m_allItems.lastIndexOf( after );
         //debugPlanDepEditor<<"after="<<after->node()->name()<<" pos="<<i;
     }
     DependencyNodeItem *item = new DependencyNodeItem( node, parent );
@@ -1283,26 +1307,36 @@ DependencyNodeItem *DependencyScene::createItem( Node *node )
     }
     item->setRectangle( QRectF( itemX( col ), itemY(), itemWidth(), itemHeight() ) );
     m_allItems.insert( i+1, item );
+    m_nodeItems.insert( node, item );
     setItemVisible( item, true );
     return item;
 }
 
 DependencyLinkItem *DependencyScene::findItem( const Relation* rel ) const
 {
-    foreach ( QGraphicsItem *i, itemList( DependencyLinkItem::Type ) ) {
-        if ( static_cast<DependencyLinkItem*>( i )->relation == rel ) {
-            return static_cast<DependencyLinkItem*>( i );
-        }
-    }
-    return 0;
+    return m_linkItems.value( rel );
 }
 
 DependencyLinkItem *DependencyScene::findItem( const DependencyConnectorItem *c1, const DependencyConnectorItem *c2, bool exact ) const
 {
     DependencyNodeItem *n1 = c1->nodeItem();
     DependencyNodeItem *n2 = c2->nodeItem();
-    foreach ( QGraphicsItem *i, itemList( DependencyLinkItem::Type ) ) {
-        DependencyLinkItem *link = static_cast<DependencyLinkItem*>( i );
+    // Only links to/from n1 are candidates, so look them up through the nodes relations
+    QList<DependencyLinkItem*> candidates;
+    foreach ( Relation *rel, n1->node()->dependChildNodes() ) {
+        if ( rel->child() == n2->node() ) {
+            candidates << m_linkItems.value( rel );
+        }
+    }
+    foreach ( Relation *rel, n1->node()->dependParentNodes() ) {
+        if ( rel->parent() == n2->node() ) {
+            candidates << m_linkItems.value( rel );
+        }
+    }
+    foreach ( DependencyLinkItem *link, candidates ) {
+        if ( link == 0 ) {
+            continue;
+        }
         if ( link->predItem == n1 && link->succItem == n2 ) {
             switch ( link->relation->type() ) {
                 case Relation::StartStart:
@@ -1356,12 +1390,7 @@ DependencyLinkItem *DependencyScene::findItem( const DependencyConnectorItem *c1
 
 DependencyNodeItem *DependencyScene::findItem( const Node *node ) const
 {
-    foreach ( QGraphicsItem *i, itemList( DependencyNodeItem::Type ) ) {
-        if ( static_cast<DependencyNodeItem*>( i )->node() == node ) {
-            return static_cast<DependencyNodeItem*>( i );
-        }
-    }
-    return 0;
+    return m_nodeItems.value( node );
 }
 
 void DependencyScene::createLinks()
@@ -1376,17 +1405,28 @@ void DependencyScene::createLinks( DependencyNodeItem *item )
         createLink( item, rel );
     }
 }
-void DependencyScene::createLink( DependencyNodeItem *parent, Relation *rel )
+DependencyLinkItem *DependencyScene::createLink( DependencyNodeItem *parent, Relation *rel )
 {
     DependencyNodeItem *child = findItem( rel->child() );
     if ( parent == 0 || child == 0 ) {
-        return;
+        return 0;
     }
     DependencyLinkItem *dep = new DependencyLinkItem( parent, child, rel );
     dep->setEditable( m_readwrite );
     addItem( dep );
+    m_linkItems.insert( rel, dep );
     //debugPlanDepEditor;
     dep->createPath();
+    return dep;
+}
+
+void DependencyScene::removeLink( const Relation *rel )
+{
+    DependencyLinkItem *item = m_linkItems.take( rel );
+    if ( item ) {
+        removeItem( item );
+        delete item;
+    }
 }
 
 void DependencyScene::mouseMoveEvent( QGraphicsSceneMouseEvent *mouseEvent )
@@ -1775,11 +1815,10 @@ void DependencyView::slotRelationAdded( Relation* rel )
     if ( item == 0 ) {
         DependencyNodeItem *p = findItem( rel->parent() );
         DependencyNodeItem *c = findItem( rel->child() );
-        DependencyLinkItem *r = new DependencyLinkItem( p, c, rel );
-        scene()->addItem( r );
-        //debugPlanDepEditor;
-        r->createPath();
-        r->setVisible( c->isVisible() && p->isVisible() );
+        DependencyLinkItem *r = itemScene()->createLink( p, rel );
+        if ( r ) {
+            r->setVisible( c->isVisible() && p->isVisible() );
+        }
     } else debugPlanDepEditor<<"Relation already exists!";
 }
 
@@ -1790,8 +1829,7 @@ void DependencyView::slotRelationRemoved( Relation* rel )
     }
     DependencyLinkItem *item = findItem( rel );
     if ( item ) {
-        scene()->removeItem( item );
-        delete item;
+        itemScene()->removeLink( rel );
     } else debugPlanDepEditor<<"Relation does not exist!";
 }
 
@@ -365,7 +365,9 @@ public:
     
     void createLinks();
     void createLinks( DependencyNodeItem *item );
-    void createLink( DependencyNodeItem *parent, Relation *rel );
+    DependencyLinkItem *createLink( DependencyNodeItem *parent, Relation *rel );
+    /// Remove and delete the link item for relation @p rel
+    void removeLink( const Relation *rel );
 
     void connectorEntered( DependencyConnectorItem *item, bool entered );
     void setFromItem( DependencyConnectorItem *item );
@@ -408,6 +410,9 @@ private:
     NodeItemModel *m_model;
     bool m_readwrite;
     QList<DependencyNodeItem*> m_allItems;
+    // Lookup tables, kept in sync with the items in the scene
+    QHash<const Node*, DependencyNodeItem*> m_nodeItems;
+    QHash<const Relation*, DependencyLinkItem*> m_linkItems;
     QMap<int, DependencyNodeItem*> m_visibleItems;
     QMap<int, DependencyNodeItem*> m_hiddenItems;
     DependencyCreatorItem *m_connectionitem;
@@ -29,6 +29,9 @@
 #include <QApplication>
 #include <QPainter>
 #include <QLocale>
+#include <QAbstractItemModel>
+
+#include <algorithm>
 
 #include <KLocalizedString>
 
@@ -977,6 +980,71 @@ void ResourceGanttItemDelegate::paintGanttItem( QPainter* painter, const KGantt:
     painter->restore();
 }
 
+// Sort load slots on start time
+static bool slotStartLessThan( const ResourceGanttItemDelegate::LoadSlot &s1, const ResourceGanttItemDelegate::LoadSlot &s2 )
+{
+    return s1.start < s2.start;
+}
+
+// True if the slot @p s ends before @p time
+static bool slotEndsBefore( const ResourceGanttItemDelegate::LoadSlot &s, const DateTime &time )
+{
+    return s.end <= time;
+}
+
+const QVector<ResourceGanttItemDelegate::LoadSlot> &ResourceGanttItemDelegate::loadProfile( const QModelIndex &idx )
+{
+    static const QVector<LoadSlot> empty;
+    const QAbstractItemModel *model = idx.model();
+    if ( model != m_profileModel ) {
+        if ( m_profileModel ) {
+            disconnect( m_profileModel, 0, this, 0 );
+        }
+        m_loadProfiles.clear();
+        m_profileModel = model;
+        // The model rebuilds its appointments when it is reset or resources are added or removed
+        connect( model, &QAbstractItemModel::modelReset, this, &ResourceGanttItemDelegate::clearLoadProfiles );
+        connect( model, &QAbstractItemModel::layoutChanged, this, &ResourceGanttItemDelegate::clearLoadProfiles );
+        connect( model, &QAbstractItemModel::rowsInserted, this, &ResourceGanttItemDelegate::clearLoadProfiles );
+        connect( model, &QAbstractItemModel::rowsRemoved, this, &ResourceGanttItemDelegate::clearLoadProfiles );
+        connect( model, &QAbstractItemModel::dataChanged, this, &ResourceGanttItemDelegate::clearLoadProfiles );
+    }
+    Appointment *external = static_cast<Appointment*>( idx.data( Role::ExternalAppointments ).value<void*>() );
+    Appointment *internal = static_cast<Appointment*>( idx.data( Role::InternalAppointments ).value<void*>() );
+    const void *key = internal ? internal : external;
+    if ( key == 0 ) {
+        return empty;
+    }
+    QHash<const void*, QVector<LoadSlot> >::const_iterator it = m_loadProfiles.constFind( key );
+    if ( it != m_loadProfiles.constEnd() ) {
+        return it.value();
+    }
+    Appointment tot;
+    if ( external ) {
+        tot += *external;
+    }
+    if ( internal ) {
+        tot += *internal;
+    }
+    QVector<LoadSlot> &profile = m_loadProfiles[ key ];
+    profile.reserve( tot.intervals().map().count() );
+    foreach ( const AppointmentInterval &i, tot.intervals().map() ) {
+        LoadSlot s;
+        s.start = i.startTime();
+        s.end = i.endTime();
+        s.load = i.load();
+        profile << s;
+    }
+    // intervals on the same date are not ordered by time in the map
+    std::sort( profile.begin(), profile.end(), slotStartLessThan );
+    return profile;
+}
+
+void ResourceGanttItemDelegate::clearLoadProfiles()
+{
+    m_loadProfiles.clear();
+}
+
 void ResourceGanttItemDelegate::paintResourceItem( QPainter* painter, const KGantt::StyleOptionGanttItem& opt, const QModelIndex& idx )
 {
     if ( ! opt.itemRect.isValid() ) {
@@ -994,35 +1062,78 @@ void ResourceGanttItemDelegate::paintResourceItem( QPainter* painter, const KGan
 
     qreal x0 = opt.grid->mapToChart( idx.data( KGantt::StartTimeRole ).toDateTime() );
 
-    Appointment *external = static_cast<Appointment*>( idx.data( Role::ExternalAppointments ).value<void*>() );
-    Appointment *internal = static_cast<Appointment*>( idx.data( Role::InternalAppointments ).value<void*>() );
     int rl = idx.data( Role::Maximum ).toInt(); //TODO check calendar
-    Appointment tot = *external + *internal;
+    const QVector<LoadSlot> &profile = loadProfile( idx );
+
+    // Only the intervals inside the visible part of the chart are painted
+    QRectF visible = painter->worldTransform().inverted().mapRect( QRectF( painter->viewport() ) );
+    if ( painter->hasClipping() ) {
+        visible &= painter->clipBoundingRect();
+    }
+    const DateTime visibleStart( opt.grid->mapFromChart( visible.left() + x0 ).toDateTime() );
+    const DateTime visibleEnd( opt.grid->mapFromChart( visible.right() + x0 ).toDateTime() );
+    QVector<LoadSlot>::const_iterator it = profile.constBegin();
+    if ( visibleStart.isValid() ) {
+        it = std::lower_bound( profile.constBegin(), profile.constEnd(), visibleStart, slotEndsBefore );
+    }
+    // Intervals narrower than this are merged with their neighbours into one bar
+    // showing the average load, so a zoomed out chart does not paint thousands of slivers
+    const qreal minWidth = 3.;
+    qreal x1 = 0.;
+    qreal x2 = 0.;
+    double loadTime = 0.;
+    qint64 time = 0;
+    int maxLoad = 0;
+    bool pending = false;
+
     painter->save();
     // TODO check load vs units properly, it's not as simple as below!
     QLocale locale;
-    foreach ( const AppointmentInterval &i, tot.intervals().map() ) {
-        int il = i.load();
-        QString txt = locale.toString( (double)il / (double)rl, 'f', 1 );
-        QPen pen = painter->pen();
-        if ( il > rl ) {
-            painter->setBrush( m_overloadBrush );
-            pen.setColor( Qt::white );
-        } else if ( il < rl ) {
-            painter->setBrush( m_underloadBrush );
-        } else {
-            painter->setBrush( defaultBrush( KGantt::TypeTask ) );
+    for ( ; ; ++it ) {
+        const bool done = it == profile.constEnd() || ( visibleEnd.isValid() && it->start > visibleEnd );
+        qreal v1 = 0.;
+        qreal v2 = 0.;
+        if ( ! done ) {
+            v1 = opt.grid->mapToChart( it->start ) - x0;
+            v2 = opt.grid->mapToChart( it->end ) - x0;
+        }
+        if ( pending && ( done || v1 - x2 > 1. || x2 - x1 >= minWidth || v2 - v1 >= minWidth ) ) {
+            const int il = time > 0 ? qRound( loadTime / time ) : maxLoad;
+            QString txt = locale.toString( (double)il / (double)rl, 'f', 1 );
+            QPen pen = painter->pen();
+            if ( maxLoad > rl ) {
+                painter->setBrush( m_overloadBrush );
+                pen.setColor( Qt::white );
+            } else if ( il < rl ) {
+                painter->setBrush( m_underloadBrush );
+            } else {
+                painter->setBrush( defaultBrush( KGantt::TypeTask ) );
+            }
+            QRectF rr( x1, r.y(), x2 - x1, r.height() );
+            painter->drawRect( rr );
+            if ( rr.width() > minWidth && painter->boundingRect( rr, Qt::AlignCenter, txt ).width() < rr.width() ) {
+                QPen pn = painter->pen();
+                painter->setPen( pen );
+                painter->drawText( rr, Qt::AlignCenter, txt );
+                painter->setPen( pn );
+            }
+            pending = false;
+        }
+        if ( done ) {
+            break;
         }
-        qreal v1 = opt.grid->mapToChart( i.startTime() );
-        qreal v2 = opt.grid->mapToChart( i.endTime() );
-        QRectF rr( v1 - x0, r.y(), v2 - v1, r.height() );
-        painter->drawRect( rr );
-        if ( painter->boundingRect( rr, Qt::AlignCenter, txt ).width() < rr.width() ) {
-            QPen pn = painter->pen();
-            painter->setPen( pen );
-            painter->drawText( rr, Qt::AlignCenter, txt );
-            painter->setPen( pn );
+        if ( ! pending ) {
+            x1 = v1;
+            loadTime = 0.;
+            time = 0;
+            maxLoad = 0;
+            pending = true;
         }
+        x2 = v2;
+        const qint64 t = it->start.msecsTo( it->end );
+        loadTime += (double)it->load * t;
+        time += t;
+        maxLoad = qMax( maxLoad, it->load );
     }
 
     painter->restore();
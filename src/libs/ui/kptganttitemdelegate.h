@@ -22,11 +22,16 @@
 
 #include "planui_export.h"
 
+#include "kptdatetime.h"
+
 #include <KGanttGlobal>
 
 #include <KGanttItemDelegate>
 
 #include <QBrush>
+#include <QHash>
+#include <QVector>
+#include <QPointer>
 
 namespace KGantt
 {
@@ -36,6 +41,7 @@ namespace KGantt
 
 class QPainter;
 class QModelIndex;
+class QAbstractItemModel;
 
 
 namespace KPlato
@@ -99,13 +105,30 @@ public:
 
     virtual void paintGanttItem( QPainter* painter, const KGantt::StyleOptionGanttItem& opt, const QModelIndex& idx );
 
+    /// The load of a resource in the time interval start to end
+    struct LoadSlot {
+        DateTime start;
+        DateTime end;
+        int load;
+    };
+
 protected:
     void paintResourceItem( QPainter* painter, const KGantt::StyleOptionGanttItem& opt, const QModelIndex& idx );
 
+    /// Returns the load profile of the resource @p idx, sorted on start time.
+    /// The profile is built from the internal and external appointments once,
+    /// and kept until the appointments in the model changes.
+    const QVector<LoadSlot> &loadProfile( const QModelIndex &idx );
+
+private Q_SLOTS:
+    void clearLoadProfiles();
+
 private:
     Q_DISABLE_COPY(ResourceGanttItemDelegate)
     QBrush m_overloadBrush;
     QBrush m_underloadBrush;
+    QPointer<const QAbstractItemModel> m_profileModel;
+    QHash<const void*, QVector<LoadSlot> > m_loadProfiles;
 
 };
 
@@ -230,6 +230,12 @@ GanttPrintingDialog::GanttPrintingDialog( ViewBase *view, GanttViewBase *gantt )
     }
     debugPlan<<m_sceneRect<<printer().pageRect()<<m_horPages<<m_vertPages;
     printer().setFromTo( documentFirstPage(), documentLastPage() );
+    m_gantt->setPrinting( true );
+}
+
+GanttPrintingDialog::~GanttPrintingDialog()
+{
+    m_gantt->setPrinting( false );
 }
 
 void GanttPrintingDialog::startPrinting(RemovePolicy removePolicy )
@@ -567,7 +573,9 @@ void NodeGanttViewBase::saveContext( QDomElement &settings ) const
 //-------------------------------------------
 MyKGanttView::MyKGanttView( QWidget *parent )
     : NodeGanttViewBase( parent ),
-    m_manager( 0 )
+    m_manager( 0 ),
+    m_rowPositionsDirty( true ),
+    m_printing( false )
 {
     debugPlan<<"------------------- create MyKGanttView -----------------------";
     GanttItemModel *gm = new GanttItemModel( this );
@@ -607,6 +615,20 @@ MyKGanttView::MyKGanttView( QWidget *parent )
     // removed custom code here
 
     connect( model(), &NodeItemModel::nodeInserted, this, &MyKGanttView::slotNodeInserted );
+
+    // Only the dependencies in or crossing the visible rows are in the constraint model,
+    // so they are updated when the rows or the visible part of the chart changes
+    m_dependencyTimer.setSingleShot( true );
+    connect( &m_dependencyTimer, &QTimer::timeout, this, &MyKGanttView::updateVisibleDependencies );
+    connect( sfModel(), &QAbstractItemModel::modelReset, this, &MyKGanttView::slotRowsChanged );
+    connect( sfModel(), &QAbstractItemModel::layoutChanged, this, &MyKGanttView::slotRowsChanged );
+    connect( sfModel(), &QAbstractItemModel::rowsInserted, this, &MyKGanttView::slotRowsChanged );
+    connect( sfModel(), &QAbstractItemModel::rowsRemoved, this, &MyKGanttView::slotRowsChanged );
+    connect( sfModel(), &QAbstractItemModel::rowsMoved, this, &MyKGanttView::slotRowsChanged );
+    connect( treeView(), &QTreeView::expanded, this, &MyKGanttView::slotRowsChanged );
+    connect( treeView(), &QTreeView::collapsed, this, &MyKGanttView::slotRowsChanged );
+    connect( graphicsView()->verticalScrollBar(), &QAbstractSlider::valueChanged, this, &MyKGanttView::scheduleDependencyUpdate );
+    connect( graphicsView()->verticalScrollBar(), &QAbstractSlider::rangeChanged, this, &MyKGanttView::scheduleDependencyUpdate );
 }
 
 GanttItemModel *MyKGanttView::model() const
@@ -639,17 +661,17 @@ void MyKGanttView::setProject( Project *proj )
 void MyKGanttView::slotProjectCalculated( ScheduleManager *sm )
 {
     if ( m_manager == sm ) {
-        setScheduleManager( sm );
+        // The item model updates its data itself, and relations are not changed by scheduling,
+        // so the dependencies are kept
+        setStartDateTime();
     }
 }
 
-void MyKGanttView::setScheduleManager( ScheduleManager *sm )
+void MyKGanttView::setStartDateTime()
 {
-    clearDependencies();
-    m_manager = sm;
     KGantt::DateTimeGrid *g = static_cast<KGantt::DateTimeGrid*>( grid() );
-    if ( sm && project() ) {
-        QDateTime start = project()->startTime( sm->scheduleId() );
+    if ( m_manager && project() ) {
+        QDateTime start = project()->startTime( m_manager->scheduleId() );
         if ( g->startDateTime() !=  start ) {
             g->setStartDateTime( start );
         }
@@ -657,10 +679,23 @@ void MyKGanttView::setScheduleManager( ScheduleManager *sm )
     if ( ! g->startDateTime().isValid() ) {
         g->setStartDateTime( QDateTime::currentDateTime() );
     }
+}
+
+void MyKGanttView::setScheduleManager( ScheduleManager *sm )
+{
+    clearDependencies();
+    m_manager = sm;
+    setStartDateTime();
     model()->setScheduleManager( sm );
     createDependencies();
 }
 
+void MyKGanttView::setPrinting( bool on )
+{
+    m_printing = on;
+    updateVisibleDependencies();
+}
+
 void MyKGanttView::slotNodeInserted( Node *node )
 {
     foreach( Relation *r, node->dependChildNodes() ) {
@@ -671,33 +706,53 @@ void MyKGanttView::slotNodeInserted( Node *node )
     }
 }
 
-void MyKGanttView::addDependency( Relation *rel )
+KGantt::Constraint MyKGanttView::createConstraint( const Relation *rel ) const
 {
     QModelIndex par = sfModel()->mapFromSource( model()->index( rel->parent() ) );
     QModelIndex ch = sfModel()->mapFromSource( model()->index( rel->child() ) );
-//    debugPlan<<"addDependency() "<<model()<<par.model();
-    if ( par.isValid() && ch.isValid() ) {
-        KGantt::Constraint con( par, ch, KGantt::Constraint::TypeSoft,
-                                 static_cast<KGantt::Constraint::RelationType>( rel->type() )/*NOTE!!*/
-                               );
-        if ( ! constraintModel()->hasConstraint( con ) ) {
-            constraintModel()->addConstraint( con );
+    return KGantt::Constraint( par, ch, KGantt::Constraint::TypeSoft,
+                                static_cast<KGantt::Constraint::RelationType>( rel->type() )/*NOTE!!*/
+                              );
+}
+
+void MyKGanttView::addDependency( Relation *rel )
+{
+    QHash<const Relation*, KGantt::Constraint>::iterator it = m_dependencies.find( rel );
+    if ( it != m_dependencies.end() ) {
+        if ( it.value().startIndex().isValid() && it.value().endIndex().isValid() ) {
+            return;
+        }
+        // the tasks have been removed and inserted again
+        if ( m_shownDependencies.remove( rel ) ) {
+            constraintModel()->removeConstraint( it.value() );
         }
+        m_dependencies.erase( it );
+    }
+    KGantt::Constraint con = createConstraint( rel );
+//    debugPlan<<"addDependency() "<<model()<<con.startIndex().model();
+    if ( con.startIndex().isValid() && con.endIndex().isValid() ) {
+        m_dependencies.insert( rel, con );
+        m_dependencyTimer.start();
     }
 }
 
 void MyKGanttView::removeDependency( Relation *rel )
 {
-    QModelIndex par = sfModel()->mapFromSource( model()->index( rel->parent() ) );
-    QModelIndex ch = sfModel()->mapFromSource( model()->index( rel->child() ) );
-    KGantt::Constraint con( par, ch, KGantt::Constraint::TypeSoft,
-                             static_cast<KGantt::Constraint::RelationType>( rel->type() )/*NOTE!!*/
-                           );
-    constraintModel()->removeConstraint( con );
+    QHash<const Relation*, KGantt::Constraint>::iterator it = m_dependencies.find( rel );
+    if ( it == m_dependencies.end() ) {
+        return;
+    }
+    if ( m_shownDependencies.remove( rel ) ) {
+        constraintModel()->removeConstraint( it.value() );
+    }
+    m_dependencies.erase( it );
 }
 
 void MyKGanttView::clearDependencies()
 {
+    m_dependencyTimer.stop();
+    m_dependencies.clear();
+    m_shownDependencies.clear();
     constraintModel()->clear();
     // Remove old deps from view
     // NOTE: This should be handled by KGantt
@@ -715,6 +770,68 @@ void MyKGanttView::createDependencies()
             addDependency( r );
         }
     }
+    updateVisibleDependencies();
+}
+
+void MyKGanttView::slotRowsChanged()
+{
+    m_rowPositionsDirty = true;
+    m_dependencyTimer.start();
+}
+
+void MyKGanttView::scheduleDependencyUpdate()
+{
+    m_dependencyTimer.start();
+}
+
+void MyKGanttView::updateVisibleDependencies()
+{
+    m_dependencyTimer.stop();
+    if ( m_rowPositionsDirty ) {
+        // Only rows that are not hidden in collapsed parents get a position
+        m_rowPositions.clear();
+        int pos = 0;
+        for ( QModelIndex idx = sfModel()->index( 0, 0 ); idx.isValid(); idx = treeView()->indexBelow( idx ) ) {
+            m_rowPositions.insert( model()->node( sfModel()->mapToSource( idx ) ), pos++ );
+        }
+        m_rowPositionsDirty = false;
+    }
+    int top = 0;
+    int bottom = m_rowPositions.count();
+    if ( ! m_printing ) {
+        QModelIndex idx = treeView()->indexAt( QPoint( 0, 0 ) );
+        if ( idx.isValid() ) {
+            top = m_rowPositions.value( model()->node( sfModel()->mapToSource( idx ) ), top );
+        }
+        idx = treeView()->indexAt( QPoint( 0, treeView()->viewport()->height() - 1 ) );
+        if ( idx.isValid() ) {
+            bottom = m_rowPositions.value( model()->node( sfModel()->mapToSource( idx ) ), bottom );
+        }
+    }
+    QHash<const Relation*, KGantt::Constraint>::iterator it = m_dependencies.begin();
+    while ( it != m_dependencies.end() ) {
+        const KGantt::Constraint &con = it.value();
+        const QModelIndex start = con.startIndex();
+        const QModelIndex end = con.endIndex();
+        if ( ! start.isValid() || ! end.isValid() ) {
+            // the tasks have been removed, slotNodeInserted() adds it again if they are inserted
+            if ( m_shownDependencies.remove( it.key() ) ) {
+                constraintModel()->removeConstraint( con );
+            }
+            it = m_dependencies.erase( it );
+            continue;
+        }
+        const int p1 = m_rowPositions.value( model()->node( sfModel()->mapToSource( start ) ), -1 );
+        const int p2 = m_rowPositions.value( model()->node( sfModel()->mapToSource( end ) ), -1 );
+        const bool visible = p1 >= 0 && p2 >= 0 && qMin( p1, p2 ) <= bottom && qMax( p1, p2 ) >= top;
+        if ( visible && ! m_shownDependencies.contains( it.key() ) ) {
+            m_shownDependencies.insert( it.key() );
+            constraintModel()->addConstraint( con );
+        } else if ( ! visible && m_shownDependencies.remove( it.key() ) ) {
+            constraintModel()->removeConstraint( con );
+        }
+        ++it;
+    }
 }
 
 //------------------------------------------
@@ -34,6 +34,11 @@
 #include <KGanttGlobal>
 #include <KGanttView>
 #include <KGanttDateTimeGrid>
+#include <KGanttConstraint>
+
+#include <QHash>
+#include <QSet>
+#include <QTimer>
 
 class KoDocument;
 
@@ -134,6 +139,7 @@ class GanttPrintingDialog : public PrintingDialog
     Q_OBJECT
 public:
     GanttPrintingDialog( ViewBase *view, GanttViewBase *gantt );
+    ~GanttPrintingDialog();
 
     void startPrinting( RemovePolicy removePolicy );
     QList<QWidget*> createOptionWidgets() const;
@@ -196,6 +202,9 @@ public:
     virtual bool loadContext( const KoXmlElement &settings );
     virtual void saveContext( QDomElement &settings ) const;
 
+    /// Called with @p on true while the view may be printed, so that the whole chart can be made printable
+    virtual void setPrinting( bool on ) { Q_UNUSED( on ); }
+
 public Q_SLOTS:
     void setPrintingOptions(const KPlato::GanttPrintingOptions &opt) { m_printOptions = opt; }
 
@@ -244,6 +253,9 @@ public:
     void setProject( Project *project );
     void setScheduleManager( ScheduleManager *sm );
 
+    /// While printing, all dependencies are in the constraint model
+    void setPrinting( bool on );
+
 public Q_SLOTS:
     void clearDependencies();
     void createDependencies();
@@ -253,8 +265,26 @@ public Q_SLOTS:
 
     void slotNodeInserted(KPlato::Node *node);
 
+protected Q_SLOTS:
+    /// Add the dependencies in or crossing the visible rows to the constraint model, and remove the others
+    void updateVisibleDependencies();
+    /// Rows have been added, removed, moved, expanded or collapsed
+    void slotRowsChanged();
+    void scheduleDependencyUpdate();
+
 protected:
+    void setStartDateTime();
+    KGantt::Constraint createConstraint( const Relation *rel ) const;
+
     ScheduleManager *m_manager;
+    /// All the dependencies, the constraint model only contains those in m_shownDependencies
+    QHash<const Relation*, KGantt::Constraint> m_dependencies;
+    QSet<const Relation*> m_shownDependencies;
+    /// The position of nodes in the expanded tree
+    QHash<const Node*, int> m_rowPositions;
+    bool m_rowPositionsDirty;
+    bool m_printing;
+    QTimer m_dependencyTimer;
 };
 
 class PLANUI_EXPORT GanttView : public ViewBase
@@ -29,7 +29,7 @@
 namespace KPlato
 {
 
-WBSDefinitionDialog::WBSDefinitionDialog(Project &project, WBSDefinition &def, QWidget *p)
+WBSDefinitionDialog::WBSDefinitionDialog(Project &project, const WBSDefinition &def, QWidget *p)
     : KoDialog(p)
 {
     setCaption( i18n("WBS Definition") );
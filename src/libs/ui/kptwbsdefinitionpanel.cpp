@@ -76,7 +76,7 @@ void ComboBoxDelegate::updateEditorGeometry(QWidget *editor, const QStyleOptionV
 
 //----------------------
 
-WBSDefinitionPanel::WBSDefinitionPanel( Project &project, WBSDefinition &def, QWidget *p, const char *n)
+WBSDefinitionPanel::WBSDefinitionPanel( Project &project, const WBSDefinition &def, QWidget *p, const char *n)
     : QWidget(p),
       m_project( project ),
       m_def(def),
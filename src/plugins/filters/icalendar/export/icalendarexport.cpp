@@ -19,27 +19,17 @@
 
 // clazy:excludeall=qstring-arg
 #include "icalendarexport.h"
-#include "config.h"
+#include "icalendarwriter.h"
+#include "icalendarexportdialog.h"
 
 #include <kptmaindocument.h>
-#include <kpttask.h>
-#include <kptnode.h>
-#include <kptresource.h>
-#include <kptdocuments.h>
 #include "kptdebug.h"
 
-#include <kcalcore/attendee.h>
-#include <kcalcore/attachment.h>
-#include <kcalcore/icalformat.h>
-#include <kcalcore/memorycalendar.h>
-
-#include <QTextCodec>
-#include <QByteArray>
-#include <QString>
-#include <QTextStream>
 #include <QFile>
 
 #include <kpluginfactory.h>
+#include <KConfigGroup>
+#include <KSharedConfig>
 
 #include <KoFilterChain.h>
 #include <KoFilterManager.h>
@@ -51,11 +41,6 @@ using namespace KPlato;
 K_PLUGIN_FACTORY_WITH_JSON(ICalendarExportFactory, "plan_icalendar_export.json",
                            registerPlugin<ICalendarExport>();)
 
-#ifdef HAVE_QDATETIME_KCALCORE
-#define KQDT QDateTime
-#else
-#define KQDT KDateTime
-#endif
 
 ICalendarExport::ICalendarExport(QObject* parent, const QVariantList &)
         : KoFilter(parent)
@@ -87,107 +72,36 @@ KoFilter::ConversionStatus ICalendarExport::convert(const QByteArray& from, cons
         errorPlan << "Output filename is empty";
         return KoFilter::InternalError;
     }
+    const Project &project = doc->getProject();
+    ICalendarWriter writer;
+    //TODO: schedule selection dialog
+    const long id = ICalendarWriter::scheduleId(project);
+    KConfigGroup config = KSharedConfig::openConfig()->group("ICalendar Export");
+    ICalendarExportDialog dlg(m_chain->outputFile());
+    dlg.setFilePerResource(config.readEntry("FilePerResource", false));
+    if (dlg.exec() != QDialog::Accepted) {
+        return KoFilter::UserCancelled;
+    }
+    config.writeEntry("FilePerResource", dlg.filePerResource());
+    if (dlg.filePerResource()) {
+        if (! writer.writePerResource(project, id, m_chain->outputFile())) {
+            errorPlan << writer.errorMessage();
+            return KoFilter::StorageCreationError;
+        }
+        return KoFilter::OK;
+    }
     QFile file(m_chain->outputFile());
     if (! file.open(QIODevice::WriteOnly)) {
         errorPlan << "Failed to open output file:" << file.fileName();
         return KoFilter::StorageCreationError;
     }
-
-    KoFilter::ConversionStatus status = convert(doc->getProject(), file);
+    const bool ok = writer.write(project, id, file);
     file.close();
-    //debugPlan << "Finished with status:"<<status;
-    return status;
-}
-
-KoFilter::ConversionStatus ICalendarExport::convert(const Project &project, QFile &file)
-{
-    KCalCore::Calendar::Ptr cal(new KCalCore::MemoryCalendar("UTC"));
-
-    //TODO: schedule selection dialog
-    long id = ANYSCHEDULED;
-    bool baselined = project.isBaselined(id);
-    QList<ScheduleManager*> lst = project.allScheduleManagers();
-    foreach(const ScheduleManager *m, lst) {
-        if (! baselined) {
-            id = lst.last()->scheduleId();
-            //debugPlan<<"last:"<<id;
-            break;
-        }
-        if (m->isBaselined()) {
-            id = m->scheduleId();
-            //debugPlan<<"baselined:"<<id;
-            break;
-        }
-    }
-    //debugPlan<<id;
-    createTodos(cal, &project, id);
-
-    KCalCore::ICalFormat format;
-    qint64 n = file.write(format.toString(cal).toUtf8());
-    if (n < 0) {
+    if (! ok) {
+        errorPlan << writer.errorMessage();
         return KoFilter::InternalError;
     }
     return KoFilter::OK;
 }
 
-void ICalendarExport::createTodos(KCalCore::Calendar::Ptr cal, const Node *node, long id, KCalCore::Todo::Ptr parent)
-{
-    KCalCore::Todo::Ptr todo(new KCalCore::Todo());
-    todo->setUid( node->id() );
-    todo->setSummary(node->name());
-    todo->setDescription(node->description());
-    todo->setCategories(QLatin1String("Plan"));
-    if (! node->projectNode()->leader().isEmpty()) {
-        todo->setOrganizer(node->projectNode()->leader());
-    }
-    if ( node->type() != Node::Type_Project && ! node->leader().isEmpty()) {
-        KCalCore::Person::Ptr p = KCalCore::Person::fromFullName(node->leader());
-        KCalCore::Attendee::Ptr a(new KCalCore::Attendee(p->name(), p->email()));
-        a->setRole(KCalCore::Attendee::NonParticipant);
-        todo->addAttendee(a);
-    }
-    DateTime st = node->startTime(id);
-    DateTime et = node->endTime(id);
-    if (st.isValid()) {
-        todo->setDtStart( KQDT( st ) );
-    }
-    if (et.isValid()) {
-        todo->setDtDue( KQDT( et ) );
-    }
-    if (node->type() == Node::Type_Task) {
-        const Task *task = qobject_cast<Task*>(const_cast<Node*>(node));
-        Schedule *s = task->schedule(id);
-        if (id < 0 || s == 0) {
-            // Not scheduled, use requests
-            const QList<Resource*> lst = task->requestedResources();
-            foreach(const Resource *r, lst) {
-                if (r->type() == Resource::Type_Work) {
-                    todo->addAttendee(KCalCore::Attendee::Ptr(new KCalCore::Attendee(r->name(), r->email())));
-                }
-            }
-        } else {
-            foreach(const Resource *r, s->resources()) {
-                if (r->type() == Resource::Type_Work) {
-                    todo->addAttendee(KCalCore::Attendee::Ptr(new KCalCore::Attendee(r->name(), r->email())));
-                }
-            }
-
-        }
-    } else if (node->type() == Node::Type_Milestone) {
-        const Task *task = qobject_cast<Task*>(const_cast<Node*>(node));
-        todo->setDtStart(KQDT());
-        todo->setPercentComplete(task->completion().percentFinished());
-    }
-    foreach(const Document *doc, node->documents().documents()) {
-        todo->addAttachment(KCalCore::Attachment::Ptr(new KCalCore::Attachment(doc->url().url())));
-    }
-    if (! parent.isNull()) {
-        todo->setRelatedTo(parent->uid(), KCalCore::Incidence::RelTypeParent);
-    }
-    cal->addTodo(todo);
-    foreach(const Node *n, node->childNodeIterator()) {
-        createTodos(cal, n, id, todo);
-    }
-}
-
 #include "icalendarexport.moc"
@@ -23,20 +23,18 @@
 
 #include <KoFilter.h>
 
-#include <kcalcore/calendar.h>
-
 #include <QObject>
 #include <QVariantList>
 
-class QFile;
 class QByteArray;
 
-namespace KPlato
-{
-class Project;
-class Node;
-}
-
+/**
+ * Exports the project as VTODO components to an iCalendar file using ICalendarWriter.
+ *
+ * The user may choose to write a file for each resource instead, containing the tasks
+ * the resource is scheduled to work on. The choice is remembered in the "FilePerResource"
+ * entry of the "ICalendar Export" config group.
+ */
 class ICalendarExport : public KoFilter
 {
 
@@ -47,10 +45,6 @@ public:
     virtual ~ICalendarExport() {}
 
     virtual KoFilter::ConversionStatus convert(const QByteArray& from, const QByteArray& to);
-
-protected:
-    KoFilter::ConversionStatus convert(const KPlato::Project &project, QFile &file);
-    void createTodos(KCalCore::Calendar::Ptr cal, const KPlato::Node *node, long id, KCalCore::Todo::Ptr parent = KCalCore::Todo::Ptr());
 };
 
 #endif // ICALENDAREXPORT_H
@@ -0,0 +1,77 @@
+/* This file is part of the KDE project
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+// clazy:excludeall=qstring-arg
+#include "icalendarexportdialog.h"
+#include "icalendarwriter.h"
+
+#include <KLocalizedString>
+
+#include <QFileInfo>
+#include <QLabel>
+#include <QRadioButton>
+#include <QVBoxLayout>
+
+
+ICalendarExportDialog::ICalendarExportDialog(const QString &fileName, QWidget *parent)
+    : KoDialog(parent)
+{
+    setCaption(i18n("iCalendar Export"));
+    setButtons(Ok|Cancel);
+    setDefaultButton(Ok);
+    showButtonSeparator(true);
+
+    QWidget *w = new QWidget(this);
+    QVBoxLayout *l = new QVBoxLayout(w);
+    l->setMargin(0);
+
+    m_singleFile = new QRadioButton(i18n("Export all tasks to one file"), w);
+    l->addWidget(m_singleFile);
+    m_filePerResource = new QRadioButton(i18n("Export one file per resource"), w);
+    m_filePerResource->setToolTip(i18n("Each file contains the tasks the resource is scheduled to work on"));
+    l->addWidget(m_filePerResource);
+
+    const QString example = QFileInfo(ICalendarWriter::resourceFileName(fileName, i18nc("example resource name", "Resource"))).fileName();
+    QLabel *naming = new QLabel(xi18nc("@info", "The files are named after the resource, e.g. <filename>%1</filename>", example), w);
+    naming->setWordWrap(true);
+    naming->setEnabled(false);
+    connect(m_filePerResource, &QAbstractButton::toggled, naming, &QWidget::setEnabled);
+    l->addWidget(naming);
+
+    QLabel *utc = new QLabel(i18n("Start and due times are written in UTC. Calendar applications show them in their own time zone."), w);
+    utc->setWordWrap(true);
+    l->addWidget(utc);
+    l->addStretch();
+
+    m_singleFile->setChecked(true);
+    setMainWidget(w);
+}
+
+bool ICalendarExportDialog::filePerResource() const
+{
+    return m_filePerResource->isChecked();
+}
+
+void ICalendarExportDialog::setFilePerResource(bool on)
+{
+    if (on) {
+        m_filePerResource->setChecked(true);
+    } else {
+        m_singleFile->setChecked(true);
+    }
+}
@@ -0,0 +1,45 @@
+/* This file is part of the KDE project
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef ICALENDAREXPORTDIALOG_H
+#define ICALENDAREXPORTDIALOG_H
+
+#include <KoDialog.h>
+
+class QRadioButton;
+
+/**
+ * Lets the user choose between exporting all tasks to one file
+ * and exporting one file per resource.
+ */
+class ICalendarExportDialog : public KoDialog
+{
+    Q_OBJECT
+public:
+    explicit ICalendarExportDialog(const QString &fileName, QWidget *parent = 0);
+
+    /// True if a file shall be written for each resource
+    bool filePerResource() const;
+    void setFilePerResource(bool on);
+
+private:
+    QRadioButton *m_singleFile;
+    QRadioButton *m_filePerResource;
+};
+
+#endif // ICALENDAREXPORTDIALOG_H
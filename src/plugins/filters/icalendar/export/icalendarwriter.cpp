@@ -0,0 +1,346 @@
+/* This file is part of the KDE project
+   Copyright (C) 2009, 2011, 2012 Dag Andersen <danders@get2net.dk>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+// clazy:excludeall=qstring-arg
+#include "icalendarwriter.h"
+#include "config.h"
+
+#include <kptproject.h>
+#include <kpttask.h>
+#include <kptnode.h>
+#include <kptresource.h>
+#include <kptschedule.h>
+#include <kptdocuments.h>
+#include "kptdebug.h"
+
+#include <kcalcore/attendee.h>
+#include <kcalcore/attachment.h>
+#include <kcalcore/icalformat.h>
+#include <kcalcore/memorycalendar.h>
+
+#include <QByteArray>
+#include <QString>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QIODevice>
+#include <QSet>
+#include <QRegExp>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThreadPool>
+
+
+using namespace KPlato;
+
+#ifdef HAVE_QDATETIME_KCALCORE
+#define KQDT QDateTime
+#else
+#define KQDT KDateTime
+#endif
+
+namespace {
+
+QByteArray calendarBegin()
+{
+    QByteArray data("BEGIN:VCALENDAR\r\n");
+    data += "PRODID:" + KCalCore::CalFormat::productId().toUtf8() + "\r\n";
+    data += "VERSION:2.0\r\n";
+    return data;
+}
+
+QByteArray calendarEnd()
+{
+    return QByteArray("END:VCALENDAR\r\n");
+}
+
+QList<Resource*> workResources(const Task *task, long id)
+{
+    Schedule *s = task->schedule(id);
+    // Not scheduled, use requests
+    const QList<Resource*> lst = id < 0 || s == 0 ? task->requestedResources() : s->resources();
+    QList<Resource*> resources;
+    foreach(Resource *r, lst) {
+        if (r->type() == Resource::Type_Work) {
+            resources << r;
+        }
+    }
+    return resources;
+}
+
+KCalCore::Todo::Ptr createTodo(const Node *node, long id)
+{
+    KCalCore::Todo::Ptr todo(new KCalCore::Todo());
+    todo->setUid( node->id() );
+    todo->setSummary(node->name());
+    todo->setDescription(node->description());
+    todo->setCategories(QLatin1String("Plan"));
+    if (! node->projectNode()->leader().isEmpty()) {
+        todo->setOrganizer(node->projectNode()->leader());
+    }
+    if ( node->type() != Node::Type_Project && ! node->leader().isEmpty()) {
+        KCalCore::Person::Ptr p = KCalCore::Person::fromFullName(node->leader());
+        KCalCore::Attendee::Ptr a(new KCalCore::Attendee(p->name(), p->email()));
+        a->setRole(KCalCore::Attendee::NonParticipant);
+        todo->addAttendee(a);
+    }
+    // The todos are written without the calendar, so use utc to avoid timezone definitions
+    DateTime st = node->startTime(id);
+    DateTime et = node->endTime(id);
+    if (st.isValid()) {
+        todo->setDtStart( KQDT( st.toUTC() ) );
+    }
+    if (et.isValid()) {
+        todo->setDtDue( KQDT( et.toUTC() ) );
+    }
+    if (node->type() == Node::Type_Task) {
+        const Task *task = qobject_cast<Task*>(const_cast<Node*>(node));
+        foreach(const Resource *r, workResources(task, id)) {
+            todo->addAttendee(KCalCore::Attendee::Ptr(new KCalCore::Attendee(r->name(), r->email())));
+        }
+    } else if (node->type() == Node::Type_Milestone) {
+        const Task *task = qobject_cast<Task*>(const_cast<Node*>(node));
+        todo->setDtStart(KQDT());
+        todo->setPercentComplete(task->completion().percentFinished());
+    }
+    foreach(const Document *doc, node->documents().documents()) {
+        todo->addAttachment(KCalCore::Attachment::Ptr(new KCalCore::Attachment(doc->url().url())));
+    }
+    if (node->parentNode()) {
+        todo->setRelatedTo(node->parentNode()->id(), KCalCore::Incidence::RelTypeParent);
+    }
+    return todo;
+}
+
+/// Append the VTODO component of @p node, and of its children if @p subtree is true, to @p data
+void writeTodos(KCalCore::ICalFormat &format, const Node *node, long id, bool subtree, QByteArray &data)
+{
+    KCalCore::Incidence::Ptr todo = createTodo(node, id);
+    data += format.toString(todo).toUtf8();
+    if (subtree) {
+        foreach(const Node *n, node->childNodeIterator()) {
+            writeTodos(format, n, id, true, data);
+        }
+    }
+}
+
+/**
+ * Serializes a part of the project in a worker thread.
+ * The result is available when done has been released.
+ */
+class TodoJob : public QRunnable {
+public:
+    TodoJob(const Node *node, long id, bool subtree)
+        : m_node(node)
+        , m_id(id)
+        , m_subtree(subtree)
+    {
+        setAutoDelete(false);
+    }
+
+    void run() {
+        KCalCore::ICalFormat format;
+        writeTodos(format, m_node, m_id, m_subtree, result);
+        done.release();
+    }
+
+    QByteArray result;
+    QSemaphore done;
+
+private:
+    const Node *m_node;
+    long m_id;
+    bool m_subtree;
+};
+
+/// The todos of one resource, written to file when the buffer grows large
+class ResourceFile {
+public:
+    ResourceFile() : created(false) {}
+
+    bool flush() {
+        QFile file(fileName);
+        if (! file.open(created ? QIODevice::Append : QIODevice::WriteOnly | QIODevice::Truncate)) {
+            errorPlan << "Failed to open output file:" << file.fileName();
+            return false;
+        }
+        if (! created) {
+            buffer.prepend(calendarBegin());
+            created = true;
+        }
+        const bool ok = file.write(buffer) == buffer.size();
+        buffer.clear();
+        return ok;
+    }
+
+    QString fileName;
+    QByteArray buffer;
+    bool created;
+};
+
+/// The workers only read the project, so the schedule must be loaded up front
+void restoreSchedule(const Project &project, long id)
+{
+    ScheduleManager *sm = project.scheduleManager(id);
+    if (sm) {
+        sm->restoreSchedule();
+    }
+}
+
+} // namespace
+
+ICalendarWriter::ICalendarWriter()
+{
+}
+
+QString ICalendarWriter::errorMessage() const
+{
+    return m_errorMessage;
+}
+
+QString ICalendarWriter::resourceFileName(const QString &fileName, const QString &resourceName)
+{
+    const QFileInfo info(fileName);
+    QString name = resourceName;
+    name.replace(QRegExp("[/\\\\:*?\"<>|]"), "_");
+    const QString suffix = info.suffix().isEmpty() ? QString("ics") : info.suffix();
+    return info.absolutePath() + QLatin1Char('/') + info.completeBaseName() + QLatin1Char('-') + name + QLatin1Char('.') + suffix;
+}
+
+long ICalendarWriter::scheduleId(const Project &project)
+{
+    long id = ANYSCHEDULED;
+    bool baselined = project.isBaselined(id);
+    QList<ScheduleManager*> lst = project.allScheduleManagers();
+    foreach(const ScheduleManager *m, lst) {
+        if (! baselined) {
+            id = lst.last()->scheduleId();
+            //debugPlan<<"last:"<<id;
+            break;
+        }
+        if (m->isBaselined()) {
+            id = m->scheduleId();
+            //debugPlan<<"baselined:"<<id;
+            break;
+        }
+    }
+    //debugPlan<<id;
+    return id;
+}
+
+bool ICalendarWriter::write(const Project &project, long id, QIODevice &file)
+{
+    m_errorMessage.clear();
+    restoreSchedule(project, id);
+    if (file.write(calendarBegin()) < 0) {
+        m_errorMessage = file.errorString();
+        return false;
+    }
+    // Split the project into parts, level by level, until there is enough work for the threads.
+    // A part is a node alone or a node with its subtree, the parts are kept in document order.
+    QThreadPool pool;
+    QList<QPair<const Node*, bool> > parts;
+    parts << qMakePair(static_cast<const Node*>(&project), true);
+    bool split = true;
+    while (split && parts.count() < 4 * pool.maxThreadCount()) {
+        split = false;
+        QList<QPair<const Node*, bool> > lst;
+        for (int i = 0; i < parts.count(); ++i) {
+            const Node *node = parts.at(i).first;
+            if (parts.at(i).second && node->numChildren() > 0) {
+                lst << qMakePair(node, false);
+                foreach(const Node *n, node->childNodeIterator()) {
+                    lst << qMakePair(n, true);
+                }
+                split = true;
+            } else {
+                lst << parts.at(i);
+            }
+        }
+        parts = lst;
+    }
+    QList<TodoJob*> jobs;
+    for (int i = 0; i < parts.count(); ++i) {
+        TodoJob *job = new TodoJob(parts.at(i).first, id, parts.at(i).second);
+        jobs << job;
+        pool.start(job);
+    }
+    // Write the parts in order as they are finished
+    bool ok = true;
+    foreach(TodoJob *job, jobs) {
+        job->done.acquire();
+        if (ok && file.write(job->result) < 0) {
+            ok = false;
+        }
+        job->result.clear();
+    }
+    pool.waitForDone();
+    qDeleteAll(jobs);
+    if (ok && file.write(calendarEnd()) < 0) {
+        ok = false;
+    }
+    if (! ok) {
+        m_errorMessage = file.errorString();
+    }
+    return ok;
+}
+
+bool ICalendarWriter::writePerResource(const Project &project, long id, const QString &fileName)
+{
+    m_errorMessage.clear();
+    restoreSchedule(project, id);
+
+    QHash<const Resource*, ResourceFile> files;
+    QSet<QString> names;
+    KCalCore::ICalFormat format;
+    foreach(const Node *node, project.allNodes()) {
+        if (node->type() != Node::Type_Task) {
+            continue;
+        }
+        const QList<Resource*> resources = workResources(static_cast<const Task*>(node), id);
+        QByteArray todo;
+        foreach(const Resource *r, resources) {
+            if (todo.isEmpty()) {
+                writeTodos(format, node, id, false, todo);
+            }
+            ResourceFile &file = files[r];
+            if (file.fileName.isEmpty()) {
+                file.fileName = resourceFileName(fileName, r->name());
+                if (names.contains(file.fileName)) {
+                    file.fileName = resourceFileName(fileName, r->name() + QLatin1Char('-') + r->id());
+                }
+                names.insert(file.fileName);
+            }
+            file.buffer += todo;
+            if (file.buffer.size() > 64 * 1024 && ! file.flush()) {
+                m_errorMessage = QStringLiteral("Failed to write file: %1").arg(file.fileName);
+                return false;
+            }
+        }
+    }
+    QHash<const Resource*, ResourceFile>::iterator it;
+    for (it = files.begin(); it != files.end(); ++it) {
+        it.value().buffer += calendarEnd();
+        if (! it.value().flush()) {
+            m_errorMessage = QStringLiteral("Failed to write file: %1").arg(it.value().fileName);
+            return false;
+        }
+    }
+    return true;
+}
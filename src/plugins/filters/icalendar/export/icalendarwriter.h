@@ -0,0 +1,66 @@
+/* This file is part of the KDE project
+   Copyright (C) 2009, 2011, 2012 Dag Andersen <danders@get2net.dk>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef ICALENDARWRITER_H
+#define ICALENDARWRITER_H
+
+#include <QString>
+
+class QIODevice;
+
+namespace KPlato
+{
+class Project;
+}
+
+/**
+ * Writes the tasks of a project as VTODO components in iCalendar format.
+ *
+ * The todos are written as they are created,
+ * the subtrees of the project are serialized in parallel by worker threads.
+ * No KoDocument is needed, so it is used both by the export filter and the batch tool.
+ *
+ * Start and due times are written in UTC, so no timezone definitions are needed.
+ */
+class ICalendarWriter
+{
+public:
+    ICalendarWriter();
+
+    /// Write all tasks scheduled in schedule @p id to @p device
+    bool write(const KPlato::Project &project, long id, QIODevice &device);
+    /**
+     * Write one file per resource, named as @p fileName with the resource name appended,
+     * containing the tasks the resource is scheduled to work on in schedule @p id
+     */
+    bool writePerResource(const KPlato::Project &project, long id, const QString &fileName);
+
+    /// The name of the file for the resource named @p resourceName when writing per resource to @p fileName
+    static QString resourceFileName(const QString &fileName, const QString &resourceName);
+
+    /// The baselined schedule if there is one, else the last schedule
+    static long scheduleId(const KPlato::Project &project);
+
+    QString errorMessage() const;
+
+private:
+    QString m_errorMessage;
+};
+
+#endif // ICALENDARWRITER_H
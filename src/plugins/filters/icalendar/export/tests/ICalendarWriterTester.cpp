@@ -0,0 +1,99 @@
+/* This file is part of the KDE project
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+// clazy:excludeall=qstring-arg
+#include "ICalendarWriterTester.h"
+
+#include "icalendarwriter.h"
+#include "tests/ProjectGenerator.h"
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+
+namespace KPlato
+{
+
+void ICalendarWriterTester::resourceFileName()
+{
+    QCOMPARE( ICalendarWriter::resourceFileName( "/tmp/plan/tasks.ics", "R1" ), QString( "/tmp/plan/tasks-R1.ics" ) );
+    // the suffix defaults to ics
+    QCOMPARE( ICalendarWriter::resourceFileName( "/tmp/plan/tasks", "R1" ), QString( "/tmp/plan/tasks-R1.ics" ) );
+    QCOMPARE( ICalendarWriter::resourceFileName( "/tmp/plan/tasks.v1.ical", "R1" ), QString( "/tmp/plan/tasks.v1-R1.ical" ) );
+    // characters that are not allowed in file names are replaced
+    QCOMPARE( ICalendarWriter::resourceFileName( "/tmp/plan/tasks.ics", "A/B:C" ), QString( "/tmp/plan/tasks-A_B_C.ics" ) );
+}
+
+void ICalendarWriterTester::writePerResource()
+{
+    QTemporaryDir dir;
+    QVERIFY( dir.isValid() );
+
+    // 20 tasks, the leaf tasks request the resources round robin
+    Project *project = ProjectGenerator::createProject( 20, 3, 1 );
+    QList<Resource*> resources = project->resourceList();
+    QCOMPARE( resources.count(), 3 );
+    resources.at( 1 )->setName( "A/B" );
+    resources.at( 2 )->setName( "A/B" );
+    ScheduleManager *sm = ProjectGenerator::createScheduleManager( project, "S1" );
+    project->calculate( *sm );
+    const long id = sm->scheduleId();
+
+    const QString fileName = dir.path() + "/tasks.ics";
+    ICalendarWriter writer;
+    QVERIFY2( writer.writePerResource( *project, id, fileName ), writer.errorMessage().toLatin1() );
+    QVERIFY( ! QFile::exists( fileName ) );
+
+    QStringList expected;
+    expected << dir.path() + "/tasks-R1.ics"
+             << dir.path() + "/tasks-A_B.ics"
+             // a second resource with the same name gets its id appended
+             << ICalendarWriter::resourceFileName( fileName, "A/B-" + resources.at( 2 )->id() );
+    QCOMPARE( QDir( dir.path() ).entryList( QDir::Files ).count(), expected.count() );
+
+    int todos = 0;
+    for ( int i = 0; i < expected.count(); ++i ) {
+        QFile file( expected.at( i ) );
+        QVERIFY2( file.open( QIODevice::ReadOnly ), expected.at( i ).toLatin1() );
+        const QByteArray data = file.readAll();
+        QVERIFY( data.startsWith( "BEGIN:VCALENDAR\r\n" ) );
+        QVERIFY( data.endsWith( "END:VCALENDAR\r\n" ) );
+        QCOMPARE( data.count( "BEGIN:VTODO" ), data.count( "END:VTODO" ) );
+        QVERIFY( data.count( "BEGIN:VTODO" ) > 0 );
+        // each file holds the tasks of its resource only
+        int count = 0;
+        foreach ( const Task *t, project->allTasks() ) {
+            if ( t->type() == Node::Type_Task && t->schedule( id )->resources().contains( resources.at( i ) ) ) {
+                QVERIFY( data.contains( "UID:" + t->id().toUtf8() ) );
+                // times are in utc
+                QVERIFY( data.contains( "DUE:" + t->endTime( id ).toUTC().toString( "yyyyMMddTHHmmss" ).toLatin1() + "Z\r\n" ) );
+                ++count;
+            }
+        }
+        QCOMPARE( data.count( "BEGIN:VTODO" ), count );
+        todos += count;
+    }
+    QCOMPARE( todos, 20 );
+
+    delete project;
+}
+
+} //namespace KPlato
+
+QTEST_GUILESS_MAIN( KPlato::ICalendarWriterTester )
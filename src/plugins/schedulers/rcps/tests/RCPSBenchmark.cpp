@@ -0,0 +1,55 @@
+/* This file is part of the KDE project
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+// clazy:excludeall=qstring-arg
+#include "RCPSBenchmark.h"
+
+#include "KPlatoRCPSPlugin.h"
+
+#include "tests/ProjectGenerator.h"
+
+#include <QTest>
+#include <QScopedPointer>
+
+namespace KPlato
+{
+
+void RCPSBenchmark::calculate_data()
+{
+    // the genetic algorithm is too slow for the largest projects
+    ProjectGenerator::addBenchmarkData( 1000 );
+}
+
+void RCPSBenchmark::calculate()
+{
+    QFETCH( int, tasks );
+    QFETCH( int, resources );
+
+    QScopedPointer<Project> project( ProjectGenerator::createProject( tasks, resources ) );
+    ScheduleManager *sm = ProjectGenerator::createScheduleManager( project.data(), "Benchmark" );
+
+    KPlatoRCPSPlugin plugin( 0, QVariantList() );
+    QBENCHMARK {
+        plugin.calculate( *project, sm, true/*nothread*/ );
+    }
+    QVERIFY( sm->calculationResult() == ScheduleManager::CalculationDone );
+}
+
+} //namespace KPlato
+
+QTEST_GUILESS_MAIN( KPlato::RCPSBenchmark )
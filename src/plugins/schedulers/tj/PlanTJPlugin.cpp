@@ -64,7 +64,7 @@ QString PlanTJPlugin::description() const
 
 int PlanTJPlugin::capabilities() const
 {
-    return SchedulerPlugin::AvoidOverbooking | SchedulerPlugin::ScheduleForward | SchedulerPlugin::ScheduleBackward;
+    return SchedulerPlugin::AvoidOverbooking | SchedulerPlugin::ScheduleForward | SchedulerPlugin::ScheduleBackward | SchedulerPlugin::EstimateVariants;
 }
 
 ulong PlanTJPlugin::currentGranularity() const
@@ -74,6 +74,11 @@ ulong PlanTJPlugin::currentGranularity() const
 }
 
 void PlanTJPlugin::calculate( KPlato::Project &project, KPlato::ScheduleManager *sm, bool nothread )
+{
+    calculateEstimateVariants( project, sm, QMap<ScheduleManager*, int>(), nothread );
+}
+
+void PlanTJPlugin::calculateEstimateVariants( KPlato::Project &project, KPlato::ScheduleManager *sm, const QMap<ScheduleManager*, int> &variants, bool nothread )
 {
     foreach ( SchedulerThread *j, m_jobs ) {
         if ( j->manager() == sm ) {
@@ -81,8 +86,16 @@ void PlanTJPlugin::calculate( KPlato::Project &project, KPlato::ScheduleManager
         }
     }
     sm->setScheduling( true );
+    // The schedules must exist before the job takes its copy of the project
+    for ( QMap<ScheduleManager*, int>::const_iterator it = variants.constBegin(); it != variants.constEnd(); ++it ) {
+        it.key()->createSchedules();
+        it.key()->setScheduling( true );
+    }
 
     PlanTJScheduler *job = new PlanTJScheduler( &project, sm, currentGranularity() );
+    for ( QMap<ScheduleManager*, int>::const_iterator it = variants.constBegin(); it != variants.constEnd(); ++it ) {
+        job->addEstimateVariant( it.key(), it.value() );
+    }
     m_jobs << job;
     connect(job, &KPlato::SchedulerThread::jobFinished, this, &PlanTJPlugin::slotFinished);
 
@@ -136,26 +149,47 @@ void PlanTJPlugin::slotFinished( SchedulerThread *j )
     Project *mp = job->mainProject();
     ScheduleManager *sm = job->mainManager();
     //debugPlan<<"PlanTJPlugin::slotFinished:"<<mp<<sm<<job->isStopped();
+    const QList<PlanTJScheduler::EstimateVariant> variants = job->estimateVariants();
     if ( job->isStopped() ) {
         sm->setCalculationResult( ScheduleManager::CalculationCanceled );
+        foreach ( const PlanTJScheduler::EstimateVariant &v, variants ) {
+            v.mainManager->setCalculationResult( ScheduleManager::CalculationCanceled );
+        }
     } else {
         updateLog( job );
         if ( job->result > 0 ) {
             sm->setCalculationResult( ScheduleManager::CalculationError );
+            foreach ( const PlanTJScheduler::EstimateVariant &v, variants ) {
+                v.mainManager->setCalculationResult( ScheduleManager::CalculationError );
+            }
         } else {
             Project *tp = job->project();
             ScheduleManager *tm = job->manager();
             updateProject( tp, tm, mp, sm );
             sm->setCalculationResult( ScheduleManager::CalculationDone );
+            foreach ( const PlanTJScheduler::EstimateVariant &v, variants ) {
+                if ( v.manager ) {
+                    updateProject( tp, v.manager, mp, v.mainManager );
+                    v.mainManager->setCalculationResult( ScheduleManager::CalculationDone );
+                } else {
+                    v.mainManager->setCalculationResult( ScheduleManager::CalculationError );
+                }
+            }
         }
     }
     sm->setScheduling( false );
+    foreach ( const PlanTJScheduler::EstimateVariant &v, variants ) {
+        v.mainManager->setScheduling( false );
+    }
 
     m_jobs.removeAt( m_jobs.indexOf( job ) );
     if ( m_jobs.isEmpty() ) {
         m_synctimer.stop();
     }
     emit sigCalculationFinished( mp, sm );
+    foreach ( const PlanTJScheduler::EstimateVariant &v, variants ) {
+        emit sigCalculationFinished( mp, v.mainManager );
+    }
 
     disconnect(this, &PlanTJPlugin::sigCalculationStarted, mp, &KPlato::Project::sigCalculationStarted);
     disconnect(this, &PlanTJPlugin::sigCalculationFinished, mp, &KPlato::Project::sigCalculationFinished);
@@ -25,6 +25,7 @@
 #include "kptschedulerplugin.h"
 
 #include <QVariantList>
+#include <QMap>
 
 
 namespace KPlato
@@ -49,6 +50,13 @@ public:
 
     /// Calculate the project
     virtual void calculate( Project &project, ScheduleManager *sm, bool nothread = false );
+    /**
+     * Calculate the project using the expected estimate for @p sm, and in the same run
+     * the estimate given in @p variants for each of the schedule managers in @p variants.
+     * The variants are scheduled as TaskJuggler scenarios sharing the project structure,
+     * and the results are written back to their respective schedule managers.
+     */
+    virtual void calculateEstimateVariants( Project &project, ScheduleManager *sm, const QMap<ScheduleManager*, int> &variants, bool nothread = false );
 
     /// Return the scheduling granularity in milliseconds
     ulong currentGranularity() const;
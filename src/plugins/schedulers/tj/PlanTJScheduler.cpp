@@ -80,6 +80,16 @@ PlanTJScheduler::~PlanTJScheduler()
     delete m_tjProject;
 }
 
+void PlanTJScheduler::addEstimateVariant( ScheduleManager *sm, int use )
+{
+    Q_ASSERT( ! isRunning() );
+    EstimateVariant v;
+    v.mainManager = sm;
+    v.manager = 0;
+    v.use = use;
+    m_variants << v;
+}
+
 void PlanTJScheduler::slotMessage( int type, const QString &msg, TJ::CoreAttributes *object )
 {
 //     debugPlan<<"PlanTJScheduler::slotMessage:"<<msg;
@@ -129,6 +139,14 @@ void PlanTJScheduler::run()
 
         m_project->initiateCalculation( *m_schedule );
         m_project->initiateCalculationLists( *m_schedule );
+        for ( int i = 0; i < m_variants.count(); ++i ) {
+            ScheduleManager *vm = m_project->scheduleManager( m_variants.at( i ).mainManager->managerId() );
+            Q_CHECK_PTR( vm );
+            Q_ASSERT( vm->expected() );
+            m_variants[ i ].manager = vm;
+            m_project->initiateCalculation( *vm->expected() );
+            m_project->initiateCalculationLists( *vm->expected() );
+        }
 
         m_usePert = m_manager->usePert();
         m_recalculate = m_manager->recalculate();
@@ -210,6 +228,9 @@ bool PlanTJScheduler::solve()
     DebugCtrl.setDebugLevel(0);
     DebugCtrl.setDebugMode(PSDEBUG+TSDEBUG+RSDEBUG+PADEBUG);
 
+    if ( ! m_variants.isEmpty() ) {
+        return m_tjProject->scheduleAllScenarios();
+    }
     return m_tjProject->scheduleScenario( sc );
 }
 
@@ -218,6 +239,11 @@ bool PlanTJScheduler::kplatoToTJ()
     m_tjProject = new TJ::Project();
     m_tjProject->setScheduleGranularity( m_granularity / 1000 );
     m_tjProject->getScenario( 0 )->setMinSlackRate( 0.0 ); // Do not calculate critical path
+    // Estimate variants are sub-scenarios of the plan scenario, scenario i + 1 holds variant i.
+    // They must exist before any tasks or resources are created.
+    for ( int i = 0; i < m_variants.count(); ++i ) {
+        new TJ::Scenario( m_tjProject, QString( "variant%1" ).arg( i + 1 ), m_variants.at( i ).mainManager->name(), m_tjProject->getScenario( 0 ) );
+    }
 
     m_tjProject->setNow( m_project->constraintStartTime().toTime_t() );
     m_tjProject->setStart( m_project->constraintStartTime().toTime_t() );
@@ -360,12 +386,31 @@ ulong PlanTJScheduler::tjGranularity() const
 
 bool PlanTJScheduler::kplatoFromTJ()
 {
+    if ( ! kplatoFromTJ( 0, m_manager ) ) {
+        return false;
+    }
+    for ( int i = 0; i < m_variants.count(); ++i ) {
+        if ( m_haltScheduling ) {
+            break;
+        }
+        if ( ! kplatoFromTJ( i + 1, m_variants.at( i ).manager ) ) {
+            return false;
+        }
+    }
+    m_project->setCurrentSchedule( m_schedule->id() );
+    return true;
+}
+
+bool PlanTJScheduler::kplatoFromTJ( int sc, ScheduleManager *sm )
+{
+    MainSchedule *schedule = sm ? sm->expected() : m_schedule;
+    m_project->setCurrentSchedule( schedule->id() );
     MainSchedule *cs = static_cast<MainSchedule*>( m_project->currentSchedule() );
 
     QDateTime start;
     QDateTime end;
     for ( QMap<TJ::Task*, Task*>::ConstIterator it = m_taskmap.constBegin(); it != m_taskmap.constEnd(); ++it ) {
-        if ( ! taskFromTJ( it.key(), it.value() ) ) {
+        if ( ! taskFromTJ( it.key(), it.value(), sc ) ) {
             return false;
         }
         if ( ! start.isValid() || it.value()->startTime() < start ) {
@@ -378,13 +423,13 @@ bool PlanTJScheduler::kplatoFromTJ()
     m_project->setStartTime( start.isValid() ? start : m_project->constraintStartTime() );
     m_project->setEndTime( end.isValid() ? end : m_project->constraintEndTime() );
 
-    adjustSummaryTasks( m_schedule->summaryTasks() );
+    adjustSummaryTasks( schedule->summaryTasks() );
 
     foreach ( Task *task, m_taskmap ) {
         calcPertValues( task );
     }
 
-    m_project->calcCriticalPathList( m_schedule );
+    m_project->calcCriticalPathList( schedule );
     // calculate positive float
     foreach ( Task* t, m_taskmap ) {
         if ( ! t->inCriticalPath() && t->isStartNode() ) {
@@ -393,17 +438,21 @@ bool PlanTJScheduler::kplatoFromTJ()
     }
 
     QLocale locale;
-    logInfo( m_project, 0, xi18nc( "@info/plain" , "Project scheduled to start at %1 and finish at %2", locale.toString(m_project->startTime(), QLocale::ShortFormat), locale.toString(m_project->endTime(), QLocale::ShortFormat) ) );
+    if ( sc == 0 ) {
+        logInfo( m_project, 0, xi18nc( "@info/plain" , "Project scheduled to start at %1 and finish at %2", locale.toString(m_project->startTime(), QLocale::ShortFormat), locale.toString(m_project->endTime(), QLocale::ShortFormat) ) );
+    } else {
+        logInfo( m_project, 0, xi18nc( "@info/plain" , "Schedule %1 scheduled to start at %2 and finish at %3", m_variants.at( sc - 1 ).mainManager->name(), locale.toString(m_project->startTime(), QLocale::ShortFormat), locale.toString(m_project->endTime(), QLocale::ShortFormat) ) );
+    }
 
-    if ( m_manager ) {
+    if ( sm ) {
         logDebug( m_project, 0, QString( "Project scheduling finished at %1" ).arg( locale.toString(QDateTime::currentDateTime(), QLocale::ShortFormat) ) );
-        m_project->finishCalculation( *m_manager );
-        m_manager->scheduleChanged( cs );
+        m_project->finishCalculation( *sm );
+        sm->scheduleChanged( cs );
     }
     return true;
 }
 
-bool PlanTJScheduler::taskFromTJ( TJ::Task *job, Task *task )
+bool PlanTJScheduler::taskFromTJ( TJ::Task *job, Task *task, int sc )
 {
     if ( m_haltScheduling || m_manager == 0 ) {
         return true;
@@ -412,13 +461,13 @@ bool PlanTJScheduler::taskFromTJ( TJ::Task *job, Task *task )
     Q_ASSERT( cs );
     QTimeZone tz = m_project->timeZone();
     debugPlan<<"taskFromTJ:"<<task<<task->name()<<cs->id()<<tz;
-    time_t s = job->getStart( 0 );
+    time_t s = job->getStart( sc );
     if ( s < m_tjProject->getStart() || s > m_tjProject->getEnd() ) {
         m_project->currentSchedule()->setSchedulingError( true );
         cs->setSchedulingError( true );
         s = m_tjProject->getStart();
     }
-    time_t e = job->getEnd( 0 );
+    time_t e = job->getEnd( sc );
     if ( job->isMilestone() ) {
         Q_ASSERT( s = (e + 1));
         e = s - 1;
@@ -446,10 +495,10 @@ bool PlanTJScheduler::taskFromTJ( TJ::Task *job, Task *task )
     if ( task->endTime() > m_project->endTime() ) {
         m_project->setEndTime( task->endTime() );
     }
-    foreach ( TJ::CoreAttributes *a, job->getBookedResources( 0 ) ) {
+    foreach ( TJ::CoreAttributes *a, job->getBookedResources( sc ) ) {
         TJ::Resource *r = static_cast<TJ::Resource*>( a );
         Resource *res = m_resourcemap[ r ];
-        const QVector<TJ::Interval> lst = r->getBookedIntervals( 0, job );
+        const QVector<TJ::Interval> lst = r->getBookedIntervals( sc, job );
         foreach ( const TJ::Interval &tji, lst ) {
             AppointmentInterval ai = fromTJInterval( tji, tz );
             double load = res->type() == Resource::Type_Material ? res->units() : ai.load() * r->getEfficiency();
@@ -458,6 +507,10 @@ bool PlanTJScheduler::taskFromTJ( TJ::Task *job, Task *task )
         }
     }
     cs->setScheduled( true );
+    if ( sc > 0 ) {
+        // only log the details of the main schedule
+        return true;
+    }
     QLocale locale;
     if ( task->type() == Node::Type_Milestone ) {
         logInfo( task, 0, xi18nc( "@info/plain" , "Scheduled milestone: %1", locale.toString(task->startTime(), QLocale::ShortFormat) ) );
@@ -873,21 +926,28 @@ void PlanTJScheduler::addRequest( TJ::Task *job, Task *task )
     }
     // Note: FI tasks can never have an estimate set (duration, length or effort)
     if ( task->constraint() != Node::FixedInterval ) {
-        if ( task->estimate()->type() == Estimate::Type_Duration && task->estimate()->calendar() == 0 ) {
-            job->setDuration( 0, task->estimate()->value( Estimate::Use_Expected, m_usePert ).toDouble( Duration::Unit_d ) );
-            return;
+        // Scenario 0 uses the expected estimate, scenario i + 1 the estimate of variant i
+        for ( int sc = 0; sc <= m_variants.count(); ++sc ) {
+            int use = sc == 0 ? Estimate::Use_Expected : m_variants.at( sc - 1 ).use;
+            if ( task->estimate()->type() == Estimate::Type_Duration && task->estimate()->calendar() == 0 ) {
+                job->setDuration( sc, task->estimate()->value( use, m_usePert ).toDouble( Duration::Unit_d ) );
+                continue;
+            }
+            if ( task->estimate()->type() == Estimate::Type_Duration && task->estimate()->calendar() != 0 ) {
+                job->setLength( sc, task->estimate()->value( use, m_usePert ).toDouble( Duration::Unit_d ) * 24.0 / m_tjProject->getDailyWorkingHours() );
+                continue;
+            }
+            if ( m_recalculate && task->completion().isStarted() ) {
+                job->setEffort( sc, task->completion().remainingEffort().toDouble( Duration::Unit_d ) );
+            } else {
+                Estimate *estimate = task->estimate();
+                double e = estimate->scale( estimate->value( use, m_usePert ), Duration::Unit_d, estimate->scales() );
+                job->setEffort( sc, e );
+            }
         }
-        if ( task->estimate()->type() == Estimate::Type_Duration && task->estimate()->calendar() != 0 ) {
-            job->setLength( 0, task->estimate()->value( Estimate::Use_Expected, m_usePert ).toDouble( Duration::Unit_d ) * 24.0 / m_tjProject->getDailyWorkingHours() );
+        if ( task->estimate()->type() == Estimate::Type_Duration ) {
             return;
         }
-        if ( m_recalculate && task->completion().isStarted() ) {
-            job->setEffort( 0, task->completion().remainingEffort().toDouble( Duration::Unit_d ) );
-        } else {
-            Estimate *estimate = task->estimate();
-            double e = estimate->scale( estimate->value( Estimate::Use_Expected, m_usePert ), Duration::Unit_d, estimate->scales() );
-            job->setEffort( 0, e );
-        }
     }
     if ( task->requests().isEmpty() ) {
         return;
@@ -67,6 +67,25 @@ public:
     PlanTJScheduler( Project *project, ScheduleManager *sm, ulong granularity, QObject *parent = 0 );
     ~PlanTJScheduler();
 
+    /// An additional schedule calculated with another estimate than expected
+    struct EstimateVariant
+    {
+        ScheduleManager *mainManager;
+        ScheduleManager *manager;
+        int use;
+    };
+
+    /**
+     * Also calculate the schedule of @p sm using the estimate @p use.
+     * The variant is scheduled as a TJ scenario in the same run as the main manager,
+     * so the project structure is only translated once.
+     * Must be called before the job is started, and @p sm must have its schedules created
+     * before this job was constructed.
+     */
+    void addEstimateVariant( ScheduleManager *sm, int use );
+    /// The estimate variants, manager is valid when the job has finished
+    QList<EstimateVariant> estimateVariants() const { return m_variants; }
+
     bool check();
     bool solve();
     int result;
@@ -75,6 +94,8 @@ public:
     bool kplatoToTJ();
     /// Fetch project data from TJ structure
     bool kplatoFromTJ();
+    /// Fetch the data of TJ scenario @p sc into the schedule managed by @p sm
+    bool kplatoFromTJ( int sc, ScheduleManager *sm );
 
 
 Q_SIGNALS:
@@ -105,7 +126,7 @@ protected:
     void addRequests();
     void addRequest( TJ::Task *job, Task *task );
     void addStartEndJob();
-    bool taskFromTJ( TJ::Task *job, Task *task );
+    bool taskFromTJ( TJ::Task *job, Task *task, int sc = 0 );
     void calcPertValues( Task *task );
     Duration calcPositiveFloat( Task *task );
 
@@ -131,6 +152,7 @@ private:
 
     QMap<TJ::Task*, Task*> m_taskmap;
     QMap<TJ::Resource*, Resource*> m_resourcemap;
+    QList<EstimateVariant> m_variants;
 
     ulong m_granularity;
 };
@@ -13,6 +13,9 @@
 #ifndef _LoopDetectorInfo_h_
 #define _LoopDetectorInfo_h_
 
+#include <QPair>
+#include <QSet>
+
 namespace TJ
 {
 
@@ -56,6 +59,7 @@ public:
     }
     const Task* getTask() const { return t; }
     bool getAtEnd() const { return atEnd; }
+    QPair<const Task*, bool> key() const { return qMakePair(t, atEnd); }
     LoopDetectorInfo* next() const { return nextLDI; }
     LoopDetectorInfo* prev() const { return prevLDI; }
 protected:
@@ -70,6 +74,8 @@ private:
  * This class stores the waypoints the dependency loop detector passes when
  * looking for loops. Since it is very performance critical we use a
  * handrolled list class instead of a Qt class.
+ * The waypoints are also kept in a hash set, so find() does not have to
+ * scan the list. A list must not contain the same waypoint twice.
  *
  * @short Waypoint list of the dependency loop detector.
  * @author Chris Schlaeger <cs@kde.org>
@@ -106,11 +112,7 @@ public:
 
     bool find(const LoopDetectorInfo* ref) const
     {
-        for (LoopDetectorInfo* p = root; p; p = p->nextLDI)
-            if (*p == *ref)
-                return true;
-
-        return false;
+        return index.contains(ref->key());
     }
 
     void append(LoopDetectorInfo* p)
@@ -127,10 +129,12 @@ public:
             leaf = leaf->nextLDI;
         }
         leaf->nextLDI = 0;
+        index.insert(p->key());
         ++items;
     }
     void removeLast()
     {
+        index.remove(leaf->key());
         if (leaf == root)
         {
             delete leaf;
@@ -147,6 +151,7 @@ public:
     LoopDetectorInfo* popLast()
     {
         LoopDetectorInfo* lst = leaf;
+        index.remove(lst->key());
         if (leaf == root)
             root = leaf = 0;
         else
@@ -162,6 +167,7 @@ private:
     long items;
     LoopDetectorInfo* root;
     LoopDetectorInfo* leaf;
+    QSet<QPair<const Task*, bool> > index;
 } ;
 
 } // namespace TJ
@@ -538,10 +538,9 @@ Project::pass2(bool noDepCheck)
      * scenarios. */
     if (scenarioList.count() > 1)
     {
-        qWarning()<<"TODO";
-/*        for (ScenarioListIterator sli(scenarioList[0]->getSubListIterator());
-             *sli; ++sli)
-            overlayScenario(0, (*sli)->getSequenceNo() - 1);*/
+        foreach (CoreAttributes *s, scenarioList[0]->getSubList()) {
+            overlayScenario(0, static_cast<Scenario*>(s)->getSequenceNo() - 1);
+        }
     }
 
     // Now check that all tasks have sufficient data to be scheduled.
@@ -808,17 +807,7 @@ Project::finishScenario(int sc)
     if (getScenario(sc)->getMinSlackRate() > 0.0)
     {
         setProgressInfo(QString("Computing critical paths..."));
-        /* The critical path detector needs to know the end of the last task.
-         * So we have to find this out first. */
-        time_t maxEnd = 0;
-        foreach (CoreAttributes *t, taskList) {
-            if (maxEnd < static_cast<Task*>(t)->getEnd(sc))
-                maxEnd = static_cast<Task*>(t)->getEnd(sc);
-        }
-        foreach (CoreAttributes *t, taskList) {
-            static_cast<Task*>(t)->checkAndMarkCriticalPath
-                (sc, getScenario(sc)->getMinSlackRate(), maxEnd);
-        }
+        Task::markCriticalPaths(sc, getScenario(sc)->getMinSlackRate(), taskList);
     }
 }
 
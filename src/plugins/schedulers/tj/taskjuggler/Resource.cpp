@@ -61,6 +61,8 @@ Resource::Resource(Project* p, const QString& i, const QString& n,
     sbSize((p->getEnd() + 1 - p->getStart()) / p->getScheduleGranularity() + 1),
     specifiedBookings(new SbBooking**[p->getMaxScenarios()]),
     scoreboards(new SbBooking**[p->getMaxScenarios()]),
+    bookedSlotIndex(),
+    bookedSlotIndexBoard(0),
     scenarios(new ResourceScenario[p->getMaxScenarios()]),
     allocationProbability(new double[p->getMaxScenarios()])
 {
@@ -282,6 +284,7 @@ Resource::setLimits(UsageLimits* l)
 void
 Resource::initScoreboard()
 {
+    invalidateBookedSlotIndex();
     scoreboard = new SbBooking*[sbSize];
 
     // First mark all scoreboard slots as unavailable (1).
@@ -503,6 +506,12 @@ Resource::bookSlot(uint idx, SbBooking* nb)
         delete nb;
         return false;
     }
+    // The slot will be booked in all cases below.
+    if (!bookedSlotIndex.isEmpty() && bookedSlotIndexBoard == scoreboard)
+    {
+        for (int i = idx; i < bookedSlotIndex.count(); i = i | (i + 1))
+            ++bookedSlotIndex[i];
+    }
 
     SbBooking* b;
     // Try to merge the booking with the booking in the previous slot.
@@ -654,6 +663,16 @@ Resource::getCurrentLoadSub(uint startIdx, uint endIdx, const Task* task) const
     if (!scoreboard)
         return bookings;
 
+    if (!task)
+    {
+        if (endIdx >= sbSize)
+            endIdx = sbSize - 1;
+        if (startIdx > endIdx)
+            return bookings;
+        return bookings + getBookedSlotsUpTo(endIdx) -
+            getBookedSlotsUpTo(static_cast<int>(startIdx) - 1);
+    }
+
     for (uint i = startIdx; i <= endIdx && i < sbSize; i++)
     {
         SbBooking* b = scoreboard[i];
@@ -666,6 +685,30 @@ Resource::getCurrentLoadSub(uint startIdx, uint endIdx, const Task* task) const
     return bookings;
 }
 
+long
+Resource::getBookedSlotsUpTo(int idx) const
+{
+    if (bookedSlotIndex.isEmpty() || bookedSlotIndexBoard != scoreboard)
+    {
+        // Build the tree in linear time
+        bookedSlotIndex.fill(0, sbSize);
+        for (uint i = 0; i < sbSize; i++)
+            if (scoreboard[i] >= (SbBooking*) 4)
+                bookedSlotIndex[i] += 1;
+        for (int i = 0; i < bookedSlotIndex.count(); i++)
+        {
+            int j = i | (i + 1);
+            if (j < bookedSlotIndex.count())
+                bookedSlotIndex[j] += bookedSlotIndex.at(i);
+        }
+        bookedSlotIndexBoard = scoreboard;
+    }
+    long bookings = 0;
+    for (int i = qMin(idx, bookedSlotIndex.count() - 1); i >= 0; i = (i & (i + 1)) - 1)
+        bookings += bookedSlotIndex.at(i);
+    return bookings;
+}
+
 uint
 Resource::getWorkSlots(time_t date) const
 {
@@ -1309,6 +1352,7 @@ Resource::prepareScenario(int sc)
 {
     copyBookings(sc, specifiedBookings, scoreboards);
     scoreboard = scoreboards[sc];
+    invalidateBookedSlotIndex();
 
     updateSlotMarks(sc);
 }
@@ -200,6 +200,9 @@ private:
     void initScoreboard();
 
     long getCurrentLoadSub(uint startIdx, uint endIdx, const Task* task) const;
+    /// @return the number of booked slots with an index <= @p idx
+    long getBookedSlotsUpTo(int idx) const;
+    void invalidateBookedSlotIndex() { bookedSlotIndex.clear(); }
 
     long getAllocatedSlots(int sc, uint startIdx, uint endIdx,
                            AccountType acctType, const Task* task) const;
@@ -263,6 +266,15 @@ private:
     SbBooking*** specifiedBookings;
     SbBooking*** scoreboards;
 
+    /**
+     * Fenwick tree over the booked slots of the current scoreboard, so that
+     * the load of a period can be computed without scanning all slots.
+     * It is built on demand and kept up to date by bookSlot().
+     */
+    mutable QVector<long> bookedSlotIndex;
+    /// The scoreboard the bookedSlotIndex has been built for
+    mutable SbBooking** bookedSlotIndexBoard;
+
     ResourceScenario* scenarios;
 
     /**
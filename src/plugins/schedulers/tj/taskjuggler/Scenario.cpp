@@ -24,8 +24,7 @@ Scenario::Scenario(Project* p, const QString& i, const QString& n,
     projectionMode(false),
     strictBookings(false),
     optimize(false),
-    minSlackRate(0.05),
-    maxPaths(10000000)
+    minSlackRate(0.05)
 {
     p->addScenario(this);
     if (pr)
@@ -36,7 +35,6 @@ Scenario::Scenario(Project* p, const QString& i, const QString& n,
         optimize = pr->optimize;
         strictBookings = pr->strictBookings;
         minSlackRate = pr->minSlackRate;
-        maxPaths = pr->maxPaths;
     }
 }
 
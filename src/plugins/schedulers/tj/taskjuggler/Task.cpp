@@ -37,6 +37,12 @@
 #include "ShiftSelection.h"
 
 #include <QExplicitlySharedDataPointer>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+
+#include <algorithm>
+#include <limits>
 
 namespace TJ
 {
@@ -1004,6 +1010,30 @@ Task::bookResource(Allocation *allocation, Resource* r, time_t date, time_t slot
     return booked;
 }
 
+QVector<QPair<double, Resource*> >
+Task::relativeLoads(const QList<Resource*>& resources, time_t date) const
+{
+    /* The load of each resource is computed once. The resources keep an
+     * index of their booked slots, so this does not need to scan the
+     * bookings from the project start. */
+    QVector<QPair<double, Resource*> > loads;
+    loads.reserve(resources.count());
+    foreach (Resource *r, resources)
+    {
+        /* We calculate the load as a relative value to the daily
+         * max load. This way part time people will reach their
+         * max as slowly as the full timers. */
+        double load =
+            r->getCurrentLoad(Interval(project->getStart(), date), 0) /
+            ((r->getLimits() && r->getLimits()->getDailyMax() > 0) ?
+             project->convertToDailyLoad(r->getLimits()->getDailyMax() *
+                                         project->getScheduleGranularity()) :
+             1.0);
+        loads.append(qMakePair(load, r));
+    }
+    return loads;
+}
+
 QList<Resource*>
 Task::createCandidateList(int sc, time_t date, Allocation* a)
 {
@@ -1043,91 +1073,53 @@ Task::createCandidateList(int sc, time_t date, Allocation* a)
              * idea is to pick the resource that is most likely to be used
              * least during this project (because of the specified
              * allocations) and try to use it first. Unfortunately this
-             * algorithm can make things worse in certain plan setups. */
-            while (!candidates.isEmpty())
-            {
-                /* Find canidate with smallest allocationProbability and
-                 * append it to the candidate list. */
-                double minProbability = 0;
-                Resource* minProbResource = 0;
-                foreach (Resource *r, candidates)
-                {
-                    double probability = r->getAllocationProbability(sc);
-                    if (minProbability == 0 || probability < minProbability)
-                    {
-                        minProbability = probability;
-                        minProbResource = r;
-                    }
-                }
-                cl.append(minProbResource);
-                candidates.removeAt(candidates.indexOf(minProbResource));
-            }
+             * algorithm can make things worse in certain plan setups.
+             * A resource has a probability of 0 if no task with an effort
+             * allocates it. The old selection sort used 0 as 'no minimum
+             * found yet', so such a resource restarted the search and the
+             * result depended on the order of the candidates. These
+             * resources are now tried last, in the specified order. */
+            QVector<QPair<double, Resource*> > keys;
+            keys.reserve(candidates.count());
+            foreach (Resource *r, candidates)
+                keys.append(qMakePair(r->getAllocationProbability(sc), r));
+            std::stable_sort(keys.begin(), keys.end(),
+                             [](const QPair<double, Resource*> &k1,
+                                const QPair<double, Resource*> &k2) {
+                                 if (k1.first == 0 || k2.first == 0)
+                                     return k1.first != 0 && k2.first == 0;
+                                 return k1.first < k2.first;
+                             });
+            for (int i = 0; i < keys.count(); ++i)
+                cl.append(keys.at(i).second);
             break;
         }
         case Allocation::minLoaded:
         {
             if (DEBUGTS(25))
                 qDebug("minLoad");
-            while (!candidates.isEmpty())
-            {
-                double minLoad = 0;
-                Resource* minLoaded = 0;
-                foreach (Resource *r, candidates)
-                {
-                    /* We calculate the load as a relative value to the daily
-                     * max load. This way part time people will reach their
-                     * max as slowly as the full timers. */
-                    double load =
-                        r->getCurrentLoad(Interval(project->getStart(),
-                                                        date), 0) /
-                        ((r->getLimits() &&
-                          r->getLimits()->getDailyMax() > 0) ?
-                         project->convertToDailyLoad
-                         (r->getLimits()->getDailyMax() *
-                          project->getScheduleGranularity()) : 1.0);
-
-                    if (minLoaded == 0 || load < minLoad)
-                    {
-                        minLoad = load;
-                        minLoaded = r;
-                    }
-                }
-                cl.append(minLoaded);
-                candidates.removeAt(candidates.indexOf(minLoaded));
-            }
+            QVector<QPair<double, Resource*> > keys = relativeLoads(candidates, date);
+            std::stable_sort(keys.begin(), keys.end(),
+                             [](const QPair<double, Resource*> &k1,
+                                const QPair<double, Resource*> &k2) {
+                                 return k1.first < k2.first;
+                             });
+            for (int i = 0; i < keys.count(); ++i)
+                cl.append(keys.at(i).second);
             break;
         }
         case Allocation::maxLoaded:
         {
             if (DEBUGTS(25))
                 qDebug("maxLoad");
-            while (!candidates.isEmpty())
-            {
-                double maxLoad = 0;
-                Resource* maxLoaded = 0;
-                foreach (Resource *r, candidates)
-                {
-                    /* We calculate the load as a relative value to the daily
-                     * max load. This way part time people will reach their
-                     * max as fast as the full timers. */
-                    double load =
-                        r->getCurrentLoad(Interval(project->getStart(),
-                                                        date), 0) /
-                        ((r->getLimits() &&
-                          r->getLimits()->getDailyMax() > 0) ?
-                         project->convertToDailyLoad
-                         (r->getLimits()->getDailyMax() *
-                          project->getScheduleGranularity()) : 1.0);
-
-                    if (maxLoaded == 0 || load > maxLoad)
-                    {
-                        maxLoad = load;
-                        maxLoaded = r;
-                    }
-                }
-                cl.append(maxLoaded);
-                candidates.removeAt(candidates.indexOf(maxLoaded));
-            }
+            QVector<QPair<double, Resource*> > keys = relativeLoads(candidates, date);
+            std::stable_sort(keys.begin(), keys.end(),
+                             [](const QPair<double, Resource*> &k1,
+                                const QPair<double, Resource*> &k2) {
+                                 return k1.first > k2.first;
+                             });
+            for (int i = 0; i < keys.count(); ++i)
+                cl.append(keys.at(i).second);
             break;
         }
         case Allocation::random:
@@ -3108,262 +3100,285 @@ Task::computePathCriticalness(int sc)
      * criticalness of this chain is equal to the sum of the individual
      * criticalnesses of the tasks that are trailing this task. It does not
      * take the user-defined priorities into account.
+     *
+     * The values are computed in reverse topological order using an explicit
+     * stack, so every task is only evaluated once and deep dependency chains
+     * cannot overflow the call stack.
      */
     // If the value has been computed already, just return it.
     if (scenarios[sc].pathCriticalness >= 0.0)
         return scenarios[sc].pathCriticalness;
 
-    double maxCriticalness = 0.0;
-    if (hasSubs())
+    QVector<Task*> stack;
+    QSet<Task*> expanded;
+    stack.append(this);
+    while (!stack.isEmpty())
     {
-        double criticalness;
-        for (TaskListIterator tli(getSubListIterator()); tli.hasNext();)
+        Task* task = stack.last();
+        if (task->scenarios[sc].pathCriticalness >= 0.0)
         {
-            Task *t = static_cast<Task*>(tli.next());
-            criticalness = t->computePathCriticalness(sc);
-
-            if (criticalness > maxCriticalness)
-                maxCriticalness = criticalness;
-        }
-    }
-    else
-    {
-        /* We only care about leaf tasks because that's were the resources are
-         * actually used. Container tasks are respected during path tracking,
-         * though.
-         * Therefore, we generate a list of all successors to this task. These
-         * are directly specified successors or successors of any of the
-         * parent tasks of this task. */
-        TaskList followerList;
-        Task* t = this;
-        while (t)
-        {
-            for (TaskListIterator tli(t->followers); tli.hasNext();) {
-                Task *t = static_cast<Task*>(tli.next());
-                if (followerList.indexOf(t) == -1)
-                    followerList.append(t);
-            }
-            t = static_cast<Task*>(t->parent);
+            stack.removeLast();
+            continue;
         }
+        /* If the task has been expanded before and its successors are still
+         * not done, they are part of a loop. Loops are reported elsewhere, so
+         * we just ignore the successors that are not done yet. */
+        bool inLoop = expanded.contains(task);
+        expanded.insert(task);
 
-
-        double criticalness;
-        for (TaskListIterator tli(followerList); tli.hasNext();)
+        bool done = true;
+        double maxCriticalness = 0.0;
+        foreach (Task* t, task->pathCriticalnessSuccessors())
         {
-            Task *t = static_cast<Task*>(tli.next());
-            criticalness = t->computePathCriticalness(sc);
-
-            if (criticalness > maxCriticalness)
+            double criticalness = t->scenarios[sc].pathCriticalness;
+            if (criticalness < 0.0)
+            {
+                if (!inLoop)
+                {
+                    stack.append(t);
+                    done = false;
+                }
+            }
+            else if (criticalness > maxCriticalness)
                 maxCriticalness = criticalness;
         }
+        if (done)
+        {
+            task->scenarios[sc].pathCriticalness =
+                task->scenarios[sc].criticalness + maxCriticalness;
+            stack.removeLast();
+        }
     }
-
-    scenarios[sc].pathCriticalness = scenarios[sc].criticalness +
-        maxCriticalness;
-
     return scenarios[sc].pathCriticalness;
 }
 
-void
-Task::checkAndMarkCriticalPath(int sc, double minSlack, time_t maxEnd)
-{
-    // The algorithm has to start at a leaf task that has no predecessors.
-    if (hasSubs() || !previous.isEmpty())
-        return;
-
-    if (DEBUGPA(3))
-        qDebug()<<"Starting critical path search at"<<id;
-
-    long worstMinSlackTime = static_cast<long>((maxEnd - getStart(sc)) *
-                                               minSlack);
-    long checks = 0;
-    long found = 0;
-    analyzePath(sc, minSlack, getStart(sc), 0, worstMinSlackTime, checks,
-                found);
-}
-
-bool
-Task::analyzePath(int sc, double minSlack, time_t pathStart, long busyTime,
-                  long worstMinSlackTime, long& checks, long& found)
+TaskList
+Task::pathCriticalnessSuccessors() const
 {
-    /* Safeguard to limit the runtime for this NP hard algorithm. */
-    long maxPaths = project->getScenario(sc)->getMaxPaths();
-    if (maxPaths > 0 && checks >= maxPaths)
-        return false;
-
-    if (DEBUGPA(14))
-        qDebug()<<"  * Checking task"<<id;
-
-    bool critical = false;
-
     if (hasSubs())
     {
-        if (DEBUGPA(15))
-            qDebug()<<"  > Sub check started for"<<id;
-
-        for (TaskListIterator tli(*sub); tli.hasNext();) {
+        TaskList list;
+        for (TaskListIterator tli(getSubListIterator()); tli.hasNext();)
+            list.append(static_cast<Task*>(tli.next()));
+        return list;
+    }
+    /* We only care about leaf tasks because that's were the resources are
+     * actually used. Container tasks are respected during path tracking,
+     * though.
+     * Therefore, we generate a list of all successors to this task. These
+     * are directly specified successors or successors of any of the
+     * parent tasks of this task. */
+    TaskList followerList;
+    QSet<Task*> seen;
+    for (const Task* task = this; task; task = task->getParent())
+    {
+        for (TaskListIterator tli(task->followers); tli.hasNext();) {
             Task *t = static_cast<Task*>(tli.next());
-            if (t->analyzePath(sc, minSlack, pathStart, busyTime,
-                                    worstMinSlackTime, checks, found))
-                critical = true;
+            if (!seen.contains(t))
+            {
+                seen.insert(t);
+                followerList.append(t);
+            }
         }
-        if (DEBUGPA(15))
-            qDebug()<<"  < Sub check finished for"<<id;
     }
-    else
-    {
-        busyTime += (getEnd(sc) + 1 - getStart(sc));
+    return followerList;
+}
 
-        /* If we have enough slack already that the path cannot be critical,
-         * we stop looking at the rest of the path. */
-        long currentSlack = (getEnd(sc) + 1 - pathStart) - busyTime;
-        if (currentSlack > worstMinSlackTime)
+void
+Task::markCriticalPaths(int sc, double minSlack, const TaskList& tasks)
+{
+    /* A path is considered critical if the ratio of busy time and overall
+     * path time is above the minSlack threshold, that is if
+     *   busy - (1 - minSlack) * (end(last) + 1 - start(first)) > 0
+     * A path through a task is split into the best prefix ending with the
+     * task and the best suffix following the task. Both are computed with a
+     * longest path pass over the task network in topological order, so the
+     * runtime is linear in the number of tasks and dependencies.
+     * Container tasks are part of the network with a zero duration, paths
+     * that reach a container continue in all of its sub tasks. */
+    const double busyRate = 1.0 - minSlack;
+    const double none = -std::numeric_limits<double>::infinity();
+
+    QVector<Task*> nodes;
+    QHash<Task*, int> index;
+    for (TaskListIterator tli(tasks); tli.hasNext();) {
+        Task *t = static_cast<Task*>(tli.next());
+        index.insert(t, nodes.count());
+        nodes.append(t);
+    }
+    const int count = nodes.count();
+    QVector<QVector<int> > successors(count);
+    QVector<int> inDegree(count, 0);
+    QVector<double> duration(count, 0.0);
+    QVector<double> prefix(count, none);
+    QVector<double> suffix(count, none);
+    for (int i = 0; i < count; ++i)
+    {
+        Task* task = nodes.at(i);
+        TaskList list;
+        if (task->hasSubs())
         {
-            checks++;
-            if (DEBUGPA(6))
-                qDebug()<<"Path cannot be critical. Stopping at task"<<id;
-            return false;
+            list = task->pathCriticalnessSuccessors();
         }
-
-        /* Find out if any of the followers is a sibling of the parent of this
-         * task. */
-        bool hasBrotherFollower = false;
-        for (TaskListIterator tli(followers); tli.hasNext() && !hasBrotherFollower;)
-            for (Task* t = static_cast<Task*>(tli.next()); t; t = t->getParent())
-                if (t == getParent())
-                {
-                    hasBrotherFollower = true;
-                    break;
-                }
-
-        /* We first have to gather a list of all followers of this task. This
-         * list must also include the followers registered for all parent
-         * tasks of this task as they are followers as well. */
-        TaskList allFollowers;
-        for (Task* task = this; task; task = task->getParent())
+        else
         {
-            for (TaskListIterator tli(task->followers); tli.hasNext();) {
-                Task *t = static_cast<Task*>(tli.next());
-                if (allFollowers.indexOf(t) < 0)
-                    allFollowers.append(t);
-            }
-            /* If the task has a follower that is a sibling of the same parent
-             * we ignore the parent followers. */
-            if (hasBrotherFollower)
-                break;
-        }
-
-        /* Get a list of all transient followers that follow the direct and
-         * indirect followers of this task. If the allFollowers list contain
-         * any of the transient followers, we can ignore it later. */
-        TaskList transientFollowers;
-        for (TaskListIterator tli(allFollowers); tli.hasNext();) {
-            Task *t = static_cast<Task*>(tli.next());
-            t->collectTransientFollowers(transientFollowers);
-        }
-        /* For inherited dependencies we only follow the bottommost task that
-         * is a follower. All parents in the allFollowers list are ignored. */
-        TaskList ignoreList;
-        for (TaskListIterator tli(allFollowers); tli.hasNext();) {
-            Task *t = static_cast<Task*>(tli.next());
-            for (Task* p = t->getParent(); p; p = p->getParent()) {
-                if (allFollowers.indexOf(p) >= 0 && ignoreList.indexOf(p) < 0)
-                    ignoreList.append(p);
+            duration[i] = task->getEnd(sc) + 1 - task->getStart(sc);
+            // Paths start at leaf tasks that have no predecessors
+            if (task->previous.isEmpty())
+                prefix[i] = busyRate * task->getStart(sc) + duration.at(i);
+            // and end at leaf tasks that have no followers
+            if (!task->criticalPathFollowers(list))
+                suffix[i] = -busyRate * (task->getEnd(sc) + 1);
+        }
+        for (TaskListIterator tli(list); tli.hasNext();) {
+            int j = index.value(static_cast<Task*>(tli.next()), -1);
+            if (j >= 0)
+            {
+                successors[i].append(j);
+                ++inDegree[j];
             }
         }
-        /* Now we can check the paths through the remaining followers. */
-        for (TaskListIterator tli(allFollowers); tli.hasNext();)
-        {
-            Task *t = static_cast<Task*>(tli.next());
-            if (ignoreList.indexOf(t) >= 0 ||
-                transientFollowers.indexOf(t) >= 0)
-                continue;
+    }
 
-            if (DEBUGPA(16))
-                qDebug()<<QString("  > Follower check started for %1").arg(t->id);
+    QVector<int> order;
+    order.reserve(count);
+    for (int i = 0; i < count; ++i)
+        if (inDegree.at(i) == 0)
+            order.append(i);
+    for (int k = 0; k < order.count(); ++k)
+        foreach (int j, successors.at(order.at(k)))
+            if (--inDegree[j] == 0)
+                order.append(j);
+    // Tasks that are part of a loop are not in 'order' and are ignored.
 
-            if (t->analyzePath(sc, minSlack, pathStart, busyTime,
-                                    worstMinSlackTime, checks, found))
-            {
-                if (scenarios[sc].criticalLinks.indexOf(t) < 0)
-                {
-                    if (DEBUGPA(5))
-                        qDebug()<<QString("  +++ Critical link %1 -> %2").arg(name).arg(t->id);
-                    scenarios[sc].criticalLinks.append(t);
-                }
+    for (int k = 0; k < order.count(); ++k)
+    {
+        int i = order.at(k);
+        foreach (int j, successors.at(i))
+            prefix[j] = qMax(prefix.at(j), prefix.at(i) + duration.at(j));
+    }
+    for (int k = order.count() - 1; k >= 0; --k)
+    {
+        int i = order.at(k);
+        foreach (int j, successors.at(i))
+            suffix[i] = qMax(suffix.at(i), duration.at(j) + suffix.at(j));
+    }
 
-                critical = true;
-            }
+    long found = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        if (prefix.at(i) + suffix.at(i) <= 0.0)
+            continue;
 
-            if (DEBUGPA(16))
-                qDebug()<<"  < Follower check finished for"<<id;
-        }
+        Task* task = nodes.at(i);
+        task->scenarios[sc].isOnCriticalPath = true;
+        if (task->hasSubs())
+            continue;
 
-        if (allFollowers.isEmpty())
-        {
-            // We've reached the end of a path. Now let's see if it's critical.
-            long overallDuration = getEnd(sc) + 1 - pathStart;
-            /* A path is considered critical if the ratio of busy time and
-             * overall path time is above the minSlack threshold and the path
-             * contains more than one task. */
-            critical = overallDuration > 0 &&
-                ((double) busyTime / overallDuration) > (1.0 - minSlack);
-            if (critical)
+        found++;
+        /* A follower that is also a transient follower of another follower
+         * is not a critical link, the path continues through the other
+         * follower. Only critical tasks need this list. */
+        QSet<Task*> transientFollowers;
+        foreach (int j, successors.at(i))
+            nodes.at(j)->collectTransientFollowers(transientFollowers);
+        foreach (int j, successors.at(i))
+        {
+            Task* t = nodes.at(j);
+            if (transientFollowers.contains(t))
+                continue;
+            if (prefix.at(i) + duration.at(j) + suffix.at(j) > 0.0 &&
+                !task->scenarios[sc].criticalLinks.contains(t))
             {
-                found++;
                 if (DEBUGPA(5))
-                    qDebug()<<"Critical path with"<<(100.0 - ((double) busyTime / overallDuration) * 100.0)<<"% slack ending at"<<id<<"found";
+                    qDebug()<<QString("  +++ Critical link %1 -> %2").arg(task->name).arg(t->id);
+                task->scenarios[sc].criticalLinks.append(t);
             }
-            else
+        }
+    }
+    if (DEBUGPA(1))
+        qDebug()<<found<<"tasks on critical paths found.";
+}
+
+bool
+Task::criticalPathFollowers(TaskList& list) const
+{
+    /* Find out if any of the followers is a sibling of the parent of this
+     * task. */
+    bool hasBrotherFollower = false;
+    for (TaskListIterator tli(followers); tli.hasNext() && !hasBrotherFollower;)
+        for (Task* t = static_cast<Task*>(tli.next()); t; t = t->getParent())
+            if (t == getParent())
             {
-                if (DEBUGPA(11))
-                    qDebug()<<"Path ending at"<<id<<"is not critical";
+                hasBrotherFollower = true;
+                break;
             }
-            if (++checks == maxPaths)
+
+    /* We first have to gather a list of all followers of this task. This
+     * list must also include the followers registered for all parent
+     * tasks of this task as they are followers as well. */
+    TaskList allFollowers;
+    QSet<Task*> followerSet;
+    for (const Task* task = this; task; task = task->getParent())
+    {
+        for (TaskListIterator tli(task->followers); tli.hasNext();) {
+            Task *t = static_cast<Task*>(tli.next());
+            if (!followerSet.contains(t))
             {
-                warningMessage(QString("Maximum number of paths reached during "
-                                    "critical path analysis. Set 'maxPaths' "
-                                    "to 0 if you want an exhaustive search. "
-                                    "Aborting critical paths detection."));
-                return false;
+                followerSet.insert(t);
+                allFollowers.append(t);
             }
-            if (checks % 100000 == 0 && DEBUGPA(1))
-                qDebug()<<"Already check"<<checks<<"paths."<<found<<"critical found.";
         }
+        /* If the task has a follower that is a sibling of the same parent
+         * we ignore the parent followers. */
+        if (hasBrotherFollower)
+            break;
     }
 
-    if (critical)
-       scenarios[sc].isOnCriticalPath = true;
-
-    if (DEBUGPA(14))
-        qDebug()<<"  - Check of task"<<id<<"completed ("<<checks<<")";
-    return critical;
+    /* For inherited dependencies we only follow the bottommost task that
+     * is a follower. All parents in the allFollowers list are ignored.
+     * Followers that can also be reached through another follower are kept
+     * here. The path through the other follower always has more busy time,
+     * so they do not change which tasks are critical. They are only
+     * filtered from the critical links. */
+    QSet<Task*> ignoreSet;
+    for (TaskListIterator tli(allFollowers); tli.hasNext();) {
+        Task *t = static_cast<Task*>(tli.next());
+        for (Task* p = t->getParent(); p; p = p->getParent())
+            if (followerSet.contains(p))
+                ignoreSet.insert(p);
+    }
+    for (TaskListIterator tli(allFollowers); tli.hasNext();) {
+        Task *t = static_cast<Task*>(tli.next());
+        if (!ignoreSet.contains(t))
+            list.append(t);
+    }
+    return !allFollowers.isEmpty();
 }
 
 void
-Task::collectTransientFollowers(TaskList& list)
-{
-    if (hasSubs())
-    {
-        for (TaskListIterator tli(followers); tli.hasNext();) {
+Task::collectTransientFollowers(QSet<Task*>& set) const
+{
+    /* The transient followers of a container are its followers, those of a
+     * leaf task are the followers of its parents. Followers found this way
+     * are searched the same way. */
+    QVector<const Task*> stack;
+    stack.append(this);
+    while (!stack.isEmpty())
+    {
+        const Task* task = stack.takeLast();
+        TaskList list;
+        if (task->hasSubs())
+            list.append(task->followers);
+        else
+            for (const Task* p = task->getParent(); p; p = p->getParent())
+                list.append(p->followers);
+        for (TaskListIterator tli(list); tli.hasNext();) {
             Task *t = static_cast<Task*>(tli.next());
-            if (list.indexOf(t) < 0)
+            if (!set.contains(t))
             {
-                list.append(t);
-                t->collectTransientFollowers(list);
-            }
-        }
-    }
-    else
-    {
-        for (Task* task = getParent(); task; task = task->getParent()) {
-            for (TaskListIterator tli(task->followers); tli.hasNext();) {
-                Task *t = static_cast<Task*>(tli.next());
-                if (list.indexOf(t) < 0)
-                {
-                    list.append(t);
-                    t->collectTransientFollowers(list);
-                }
+                set.insert(t);
+                stack.append(t);
             }
         }
     }
@@ -22,6 +22,7 @@
 #include <stdarg.h>
 
 #include <QDomDocument>
+#include <QSet>
 
 #include "debug.h"
 #include "TaskList.h"
@@ -316,7 +317,8 @@ public:
     void finishScenario(int sc);
     void computeCriticalness(int sc);
     double getCriticalness(int sc) const { return scenarios[sc].criticalness; }
-    void checkAndMarkCriticalPath(int sc, double minSlack, time_t maxEnd);
+    /// Mark the tasks and links on critical paths of all @p tasks
+    static void markCriticalPaths(int sc, double minSlack, const TaskList& tasks);
 
     double computePathCriticalness(int sc);
     double getPathCriticalness(int sc) const
@@ -415,6 +417,7 @@ private:
             bookedResources.inSort((CoreAttributes*) r);
     }
     QList<Resource*> createCandidateList(int sc, time_t date, Allocation* a);
+    QVector<QPair<double, Resource*> > relativeLoads(const QList<Resource*>& resources, time_t date) const;
     time_t earliestStart(int sc) const;
     time_t latestEnd(int sc) const;
 
@@ -427,9 +430,9 @@ private:
     bool hasStartDependency() const;
     bool hasEndDependency() const;
 
-    bool analyzePath(int sc, double minSlack, time_t pathStart, long busyTime,
-                     long worstMinSlackTime, long& checked, long& found);
-    void collectTransientFollowers(TaskList& list);
+    TaskList pathCriticalnessSuccessors() const;
+    bool criticalPathFollowers(TaskList& list) const;
+    void collectTransientFollowers(QSet<Task*>& set) const;
 
     bool countMilestones(int sc, time_t now, int& totalMilestones,
                          int& completedMilestones,
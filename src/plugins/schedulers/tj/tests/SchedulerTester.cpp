@@ -31,8 +31,10 @@
 #include "kptxmlloaderobject.h"
 
 #include <QTest>
+#include <QScopedPointer>
 
 #include "tests/DateTimeTester.h"
+#include "tests/ProjectGenerator.h"
 
 #include "tests/debug.cpp"
 
@@ -125,6 +127,44 @@ qDebug() << "+++++++++++++++++++++++++++calculate-end";
     }
 }
 
+void SchedulerTester::estimateVariants()
+{
+    QScopedPointer<Project> project( ProjectGenerator::createProject( 10, 2, 1 ) );
+    foreach ( Task *t, project->allTasks() ) {
+        if ( t->type() == Node::Type_Task ) {
+            t->estimate()->setOptimisticRatio( -50 );
+            t->estimate()->setPessimisticRatio( 100 );
+        }
+    }
+    ScheduleManager *sm = ProjectGenerator::createScheduleManager( project.data(), "Expected" );
+    ScheduleManager *optimistic = ProjectGenerator::createScheduleManager( project.data(), "Optimistic" );
+    ScheduleManager *pessimistic = ProjectGenerator::createScheduleManager( project.data(), "Pessimistic" );
+    QMap<ScheduleManager*, int> variants;
+    variants.insert( optimistic, Estimate::Use_Optimistic );
+    variants.insert( pessimistic, Estimate::Use_Pessimistic );
+
+    PlanTJPlugin tj( 0, QVariantList() );
+    QVERIFY( tj.capabilities() & SchedulerPlugin::EstimateVariants );
+    tj.calculateEstimateVariants( *project, sm, variants, true/*nothread*/ );
+
+    QCOMPARE( sm->calculationResult(), (int)ScheduleManager::CalculationDone );
+    QCOMPARE( optimistic->calculationResult(), (int)ScheduleManager::CalculationDone );
+    QCOMPARE( pessimistic->calculationResult(), (int)ScheduleManager::CalculationDone );
+
+    // Each variant is written back to its own manager
+    const DateTime expectedEnd = project->endTime( sm->scheduleId() );
+    const DateTime optimisticEnd = project->endTime( optimistic->scheduleId() );
+    const DateTime pessimisticEnd = project->endTime( pessimistic->scheduleId() );
+    QVERIFY( expectedEnd.isValid() );
+    QVERIFY( optimisticEnd < expectedEnd );
+    QVERIFY( expectedEnd < pessimisticEnd );
+
+    // and the task schedules differ in the same way
+    Task *task = project->allTasks().last();
+    QVERIFY( task->endTime( optimistic->scheduleId() ) < task->endTime( sm->scheduleId() ) );
+    QVERIFY( task->endTime( sm->scheduleId() ) < task->endTime( pessimistic->scheduleId() ) );
+}
+
 void SchedulerTester::compare( const QString &fname, Node *n, long id1, long id2 )
 {
     QString s = QString( "%1: '%2' Compare task schedules:\n Expected: %3\n   Result: %4" ).arg( fname ).arg( n->name() );
@@ -33,6 +33,7 @@ class SchedulerTester : public QObject
     Q_OBJECT
 private Q_SLOTS:
     void test();
+    void estimateVariants();
 
 private:
     QStringList data();
@@ -23,6 +23,8 @@
 #include "Interval.h"
 #include "Task.h"
 #include "Resource.h"
+#include "Scenario.h"
+#include "TjMessageHandler.h"
 #include "CoreAttributesList.h"
 #include "Utility.h"
 #include "UsageLimits.h"
@@ -1012,6 +1014,279 @@ void TaskJuggler::units()
     }
 }
 
+void TaskJuggler::candidateOrder_data()
+{
+    QTest::addColumn<int>( "mode" );
+    QTest::addColumn<bool>( "preload" );
+    QTest::addColumn<QString>( "expected" );
+
+    // With preload, R1 is booked by another task before the candidates are compared
+    QTest::newRow( "order" ) << (int)TJ::Allocation::order << true << "R1";
+    QTest::newRow( "minLoaded" ) << (int)TJ::Allocation::minLoaded << true << "R2";
+    QTest::newRow( "minLoaded, equal load" ) << (int)TJ::Allocation::minLoaded << false << "R1";
+    QTest::newRow( "maxLoaded" ) << (int)TJ::Allocation::maxLoaded << true << "R1";
+    QTest::newRow( "maxLoaded, equal load" ) << (int)TJ::Allocation::maxLoaded << false << "R1";
+    QTest::newRow( "minAllocationProbability" ) << (int)TJ::Allocation::minAllocationProbability << true << "R2";
+    QTest::newRow( "minAllocationProbability, equal probability" ) << (int)TJ::Allocation::minAllocationProbability << false << "R1";
+}
+
+void TaskJuggler::candidateOrder()
+{
+    QFETCH( int, mode );
+    QFETCH( bool, preload );
+    QFETCH( QString, expected );
+
+    QDateTime pstart = QDateTime::fromString( "2011-07-01 09:00:00", Qt::ISODate );
+    QDateTime pend = pstart.addDays(1);
+
+    TJ::Project *proj = new TJ::Project();
+    proj->setScheduleGranularity( TJ::ONEHOUR );
+
+    proj->setStart( pstart.toTime_t() );
+    proj->setEnd( pend.toTime_t() );
+
+    TJ::Resource *r1 = new TJ::Resource( proj, "R1", "R1", 0 );
+    TJ::Resource *r2 = new TJ::Resource( proj, "R2", "R2", 0 );
+    foreach ( TJ::Resource *r, QList<TJ::Resource*>() << r1 << r2 ) {
+        r->setEfficiency( 1.0 );
+        for (int day = 0; day < 7; ++day) {
+            r->setWorkingHours( day, *(proj->getWorkingHours(day)) );
+        }
+    }
+
+    if ( preload ) {
+        TJ::Task *p = new TJ::Task(proj, "P", "P", 0, QString(), 0);
+        p->setSpecifiedStart( 0, proj->getStart() );
+        p->setEffort( 0, 1.0 / proj->getDailyWorkingHours() );
+        TJ::Allocation *a = new TJ::Allocation();
+        a->addCandidate( r1 );
+        p->addAllocation( a );
+    }
+
+    TJ::Task *t = new TJ::Task(proj, "T", "T", 0, QString(), 0);
+    t->setSpecifiedStart( 0, proj->getStart() + 2 * TJ::ONEHOUR );
+    t->setEffort( 0, 1.0 / proj->getDailyWorkingHours() );
+    TJ::Allocation *a = new TJ::Allocation();
+    a->setSelectionMode( static_cast<TJ::Allocation::SelectionModeType>( mode ) );
+    a->addCandidate( r1 );
+    a->addCandidate( r2 );
+    t->addAllocation( a );
+
+    QVERIFY( proj->pass2( true ) );
+    QVERIFY( proj->scheduleAllScenarios() );
+
+    TJ::Resource *booked = expected == "R1" ? r1 : r2;
+    TJ::Resource *other = booked == r1 ? r2 : r1;
+    QVERIFY( t->isBookedResource( 0, booked ) );
+    QVERIFY( ! t->isBookedResource( 0, other ) );
+
+    delete proj;
+}
+
+void TaskJuggler::criticalPath()
+{
+    QDateTime pstart = QDateTime::fromString( "2011-07-01 00:00:00", Qt::ISODate );
+    QDateTime pend = pstart.addDays(1);
+
+    TJ::Project *proj = new TJ::Project();
+    proj->setScheduleGranularity( TJ::ONEHOUR ); // seconds
+    proj->getScenario( 0 )->setMinSlackRate( 0.1 );
+
+    proj->setStart( pstart.toTime_t() );
+    proj->setEnd( pend.toTime_t() );
+
+    // T1 -> T2 is a path without slack
+    TJ::Task *t1 = new TJ::Task(proj, "T1", "T1", 0, QString(), 0);
+    t1->setScheduling( TJ::Task::ASAP );
+    t1->setSpecifiedStart( 0, proj->getStart() );
+    t1->setDuration( 0, (double)(TJ::ONEHOUR) / TJ::ONEDAY );
+
+    TJ::Task *t2 = new TJ::Task(proj, "T2", "T2", 0, QString(), 0);
+    t2->setScheduling( TJ::Task::ASAP );
+    t2->setDuration( 0, (double)(TJ::ONEHOUR) / TJ::ONEDAY );
+    t2->addDepends( t1->getId() );
+
+    // T3 -> T4 has lots of slack
+    TJ::Task *t3 = new TJ::Task(proj, "T3", "T3", 0, QString(), 0);
+    t3->setScheduling( TJ::Task::ASAP );
+    t3->setSpecifiedStart( 0, proj->getStart() );
+    t3->setDuration( 0, (double)(TJ::ONEHOUR) / TJ::ONEDAY );
+
+    TJ::Task *t4 = new TJ::Task(proj, "T4", "T4", 0, QString(), 0);
+    t4->setScheduling( TJ::Task::ALAP );
+    t4->setSpecifiedEnd( 0, proj->getEnd() - 1 );
+    t4->setDuration( 0, (double)(TJ::ONEHOUR) / TJ::ONEDAY );
+    t4->addDepends( t3->getId() );
+
+    QVERIFY( proj->pass2( true ) );
+    QVERIFY( proj->scheduleAllScenarios() );
+
+    QVERIFY( t1->isOnCriticalPath( 0 ) );
+    QVERIFY( t2->isOnCriticalPath( 0 ) );
+    QVERIFY( t1->hasCriticalLinkTo( 0, t2 ) );
+
+    QVERIFY( ! t3->isOnCriticalPath( 0 ) );
+    QVERIFY( ! t4->isOnCriticalPath( 0 ) );
+    QVERIFY( ! t3->hasCriticalLinkTo( 0, t4 ) );
+
+    delete proj;
+}
+
+void TaskJuggler::criticalLinks()
+{
+    QDateTime pstart = QDateTime::fromString( "2011-07-01 00:00:00", Qt::ISODate );
+    QDateTime pend = pstart.addDays(1);
+
+    TJ::Project *proj = new TJ::Project();
+    proj->setScheduleGranularity( TJ::ONEHOUR ); // seconds
+    proj->getScenario( 0 )->setMinSlackRate( 0.5 );
+
+    proj->setStart( pstart.toTime_t() );
+    proj->setEnd( pend.toTime_t() );
+
+    // T -> A -> X, where A inherits the dependency on X from its parent C,
+    // and a direct T -> X that is also reached through A
+    TJ::Task *t = new TJ::Task(proj, "T", "T", 0, QString(), 0);
+    t->setScheduling( TJ::Task::ASAP );
+    t->setSpecifiedStart( 0, proj->getStart() );
+    t->setDuration( 0, (double)(TJ::ONEHOUR) / TJ::ONEDAY );
+
+    TJ::Task *c = new TJ::Task(proj, "C", "C", 0, QString(), 0);
+
+    TJ::Task *a = new TJ::Task(proj, "A", "A", c, QString(), 0);
+    a->setScheduling( TJ::Task::ASAP );
+    a->setDuration( 0, (double)(TJ::ONEHOUR) / TJ::ONEDAY );
+    a->addDepends( t->getId() );
+
+    TJ::Task *x = new TJ::Task(proj, "X", "X", 0, QString(), 0);
+    x->setScheduling( TJ::Task::ASAP );
+    x->setDuration( 0, (double)(TJ::ONEHOUR) / TJ::ONEDAY );
+    x->addDepends( c->getId() );
+    x->addDepends( t->getId() );
+
+    QVERIFY( proj->pass2( true ) );
+    QVERIFY( proj->scheduleAllScenarios() );
+
+    QVERIFY( t->isOnCriticalPath( 0 ) );
+    QVERIFY( a->isOnCriticalPath( 0 ) );
+    QVERIFY( x->isOnCriticalPath( 0 ) );
+    QVERIFY( t->hasCriticalLinkTo( 0, a ) );
+    QVERIFY( a->hasCriticalLinkTo( 0, x ) );
+    // The path continues through A, so the direct link is not critical
+    QVERIFY( ! t->hasCriticalLinkTo( 0, x ) );
+
+    delete proj;
+}
+
+void TaskJuggler::loopDetection()
+{
+    QDateTime pstart = QDateTime::fromString( "2011-07-01 00:00:00", Qt::ISODate );
+    QDateTime pend = pstart.addDays(1);
+    {
+        TJ::Project *proj = new TJ::Project();
+        proj->setStart( pstart.toTime_t() );
+        proj->setEnd( pend.toTime_t() );
+
+        // A long chain without loops
+        TJ::Task *previous = 0;
+        for ( int i = 0; i < 1000; ++i ) {
+            TJ::Task *t = new TJ::Task(proj, QString( "T%1" ).arg( i ), QString( "T%1" ).arg( i ), 0, QString(), 0);
+            t->setScheduling( TJ::Task::ASAP );
+            t->setDuration( 0, (double)(TJ::ONEHOUR) / TJ::ONEDAY / 100 );
+            if ( previous ) {
+                t->addDepends( previous->getId() );
+            } else {
+                t->setSpecifiedStart( 0, proj->getStart() );
+            }
+            previous = t;
+        }
+        TJMH.reset();
+        QVERIFY( proj->pass2( false ) );
+        QCOMPARE( TJMH.getErrors(), 0 );
+
+        delete proj;
+    }
+    {
+        TJ::Project *proj = new TJ::Project();
+        proj->setStart( pstart.toTime_t() );
+        proj->setEnd( pend.toTime_t() );
+
+        TJ::Task *t1 = new TJ::Task(proj, "T1", "T1", 0, QString(), 0);
+        t1->setSpecifiedStart( 0, proj->getStart() );
+        t1->setDuration( 0, (double)(TJ::ONEHOUR) / TJ::ONEDAY );
+        TJ::Task *t2 = new TJ::Task(proj, "T2", "T2", 0, QString(), 0);
+        t2->setDuration( 0, (double)(TJ::ONEHOUR) / TJ::ONEDAY );
+        TJ::Task *t3 = new TJ::Task(proj, "T3", "T3", 0, QString(), 0);
+        t3->setDuration( 0, (double)(TJ::ONEHOUR) / TJ::ONEDAY );
+
+        t2->addDepends( t1->getId() );
+        t3->addDepends( t2->getId() );
+        t2->addDepends( t3->getId() );
+
+        TJMH.reset();
+        QVERIFY( ! proj->pass2( false ) );
+        QVERIFY( TJMH.getErrors() > 0 );
+        bool found = false;
+        for ( int i = 0; i < TJMH.getMessageCount(); ++i ) {
+            if ( TJMH.getMessage( i ).contains( "Dependency loop detected" ) ) {
+                found = true;
+                break;
+            }
+        }
+        QVERIFY( found );
+
+        delete proj;
+    }
+}
+
+void TaskJuggler::scenarios()
+{
+    QDateTime pstart = QDateTime::fromString( "2011-07-01 00:00:00", Qt::ISODate );
+    QDateTime pend = pstart.addDays(1);
+
+    TJ::Project *proj = new TJ::Project();
+    proj->setScheduleGranularity( TJ::ONEHOUR ); // seconds
+    // scenarios must be created before tasks
+    new TJ::Scenario( proj, "pessimistic", "Pessimistic", proj->getScenario( 0 ) );
+    new TJ::Scenario( proj, "inherited", "Inherited", proj->getScenario( 0 ) );
+    QCOMPARE( proj->getMaxScenarios(), 3 );
+    QCOMPARE( proj->getScenarioIndex( "pessimistic" ), 2 );
+    QCOMPARE( proj->getScenarioIndex( "inherited" ), 3 );
+
+    proj->setStart( pstart.toTime_t() );
+    proj->setEnd( pend.toTime_t() );
+
+    TJ::Task *t1 = new TJ::Task(proj, "T1", "T1", 0, QString(), 0);
+    t1->setScheduling( TJ::Task::ASAP );
+    t1->setSpecifiedStart( 0, proj->getStart() );
+    t1->setDuration( 0, (double)(TJ::ONEHOUR) / TJ::ONEDAY );
+    t1->setDuration( 1, 2.0 * TJ::ONEHOUR / TJ::ONEDAY );
+
+    TJ::Task *t2 = new TJ::Task(proj, "T2", "T2", 0, QString(), 0);
+    t2->setScheduling( TJ::Task::ASAP );
+    t2->setDuration( 0, (double)(TJ::ONEHOUR) / TJ::ONEDAY );
+    t2->setDuration( 1, 3.0 * TJ::ONEHOUR / TJ::ONEDAY );
+    t2->addDepends( t1->getId() );
+
+    TJMH.reset();
+    QVERIFY( proj->pass2( false ) );
+    QVERIFY( proj->scheduleAllScenarios() );
+    QCOMPARE( TJMH.getErrors(), 0 );
+
+    // plan
+    QCOMPARE( t1->getStart( 0 ), proj->getStart() );
+    QCOMPARE( t2->getEnd( 0 ), proj->getStart() + 2 * TJ::ONEHOUR - 1 );
+    // pessimistic has its own durations
+    QCOMPARE( t1->getStart( 1 ), proj->getStart() );
+    QCOMPARE( t1->getEnd( 1 ), proj->getStart() + 2 * TJ::ONEHOUR - 1 );
+    QCOMPARE( t2->getEnd( 1 ), proj->getStart() + 5 * TJ::ONEHOUR - 1 );
+    // inherited gets the start and durations of the plan scenario
+    QCOMPARE( t1->getStart( 2 ), proj->getStart() );
+    QCOMPARE( t2->getEnd( 2 ), t2->getEnd( 0 ) );
+
+    delete proj;
+}
+
 } //namespace KPlato
 
 QTEST_GUILESS_MAIN( KPlato::TaskJuggler )
@@ -48,6 +48,12 @@ private Q_SLOTS:
     void scheduleConstraints();
     void resourceConflict();
     void units();
+    void candidateOrder_data();
+    void candidateOrder();
+    void criticalPath();
+    void criticalLinks();
+    void loopDetection();
+    void scenarios();
 
 private:
     TJ::Project *project;
@@ -33,6 +33,7 @@
 #include "kptcalendar.h"
 #include "kptproject.h"
 #include "kptschedule.h"
+#include "kptappointment.h"
 #include "kptresource.h"
 #include "kptcommand.h"
 
@@ -206,6 +207,134 @@ QVariant Scripting::Project::headerData( int objectType, const QString &property
     return QVariant();
 }
 
+QVariantList Scripting::Project::columns( int objectType, const QStringList &properties, const QString &role, qlonglong scheduleId )
+{
+    switch ( objectType ) {
+        case 0: return nodeColumns( properties, role, scheduleId );
+        case 1: return resourceColumns( properties, role );
+        case 2: return accountColumns( properties, role );
+        default: break;
+    }
+    return QVariantList();
+}
+
+static void addNodes( QList<const KPlato::Node*> &lst, const KPlato::Node *node )
+{
+    lst << node;
+    foreach ( const KPlato::Node *n, node->childNodeIterator() ) {
+        addNodes( lst, n );
+    }
+}
+
+QVariantList Scripting::Project::nodeColumns( const QStringList &properties, const QString &role, long schedule )
+{
+    setNodeModelSchedule( schedule );
+    QList<const KPlato::Node*> nodes;
+    addNodes( nodes, kplatoProject() );
+
+    QVariantList result;
+    foreach ( const QString &property, properties ) {
+        // resolve column and role once pr property, not pr node
+        int col = nodeColumnNumber( property );
+        int r = stringToRole( role, m_nodeprogramroles.value( col ) );
+        QVariantList values;
+        values.reserve( nodes.count() );
+        foreach ( const KPlato::Node *n, nodes ) {
+            values << ( r < 0 ? QVariant() : nodeValue( n, col, r ) );
+        }
+        result << QVariant( values );
+    }
+    return result;
+}
+
+static void addResource( QList<QModelIndex> &lst, const KPlato::ResourceItemModel &model, KPlato::Resource *resource )
+{
+    lst << model.index( resource );
+    // same as Scripting::Resource::childAt()
+    if ( resource->type() == KPlato::Resource::Type_Team ) {
+        foreach ( KPlato::Resource *r, resource->teamMembers() ) {
+            addResource( lst, model, r );
+        }
+    }
+}
+
+QVariantList Scripting::Project::resourceColumns( const QStringList &properties, const QString &role )
+{
+    QList<QModelIndex> indexes;
+    foreach ( KPlato::ResourceGroup *g, kplatoProject()->resourceGroups() ) {
+        indexes << m_resourceModel.index( g );
+        foreach ( KPlato::Resource *r, g->resources() ) {
+            addResource( indexes, m_resourceModel, r );
+        }
+    }
+    QVariantList result;
+    foreach ( const QString &property, properties ) {
+        int col = resourceColumnNumber( property );
+        int r = stringToRole( role, m_resourceprogramroles.value( col ) );
+        QVariantList values;
+        values.reserve( indexes.count() );
+        foreach ( const QModelIndex &idx, indexes ) {
+            QModelIndex i = idx.sibling( idx.row(), col );
+            values << ( r < 0 || ! i.isValid() ? QVariant() : m_resourceModel.data( i, r ) );
+        }
+        result << QVariant( values );
+    }
+    return result;
+}
+
+static void addAccount( QList<const KPlato::Account*> &lst, const KPlato::Account *account )
+{
+    lst << account;
+    for ( int i = 0; i < account->childCount(); ++i ) {
+        addAccount( lst, account->childAt( i ) );
+    }
+}
+
+QVariantList Scripting::Project::accountColumns( const QStringList &properties, const QString &role )
+{
+    QList<const KPlato::Account*> accounts;
+    foreach ( KPlato::Account *a, kplatoProject()->accounts().accountList() ) {
+        addAccount( accounts, a );
+    }
+    QVariantList result;
+    // the account model has the same data for DisplayRole and EditRole
+    int r = stringToRole( role );
+    foreach ( const QString &property, properties ) {
+        int col = accountColumnNumber( property );
+        QVariantList values;
+        values.reserve( accounts.count() );
+        foreach ( const KPlato::Account *a, accounts ) {
+            QModelIndex idx = m_accountModel.index( a, col );
+            values << ( r < 0 || ! idx.isValid() ? QVariant() : m_accountModel.data( idx, r ) );
+        }
+        result << QVariant( values );
+    }
+    return result;
+}
+
+QVariantList Scripting::Project::appointmentColumns( qlonglong scheduleId )
+{
+    QVariantList resources, tasks, starts, ends, loads;
+    foreach ( KPlato::ResourceGroup *g, kplatoProject()->resourceGroups() ) {
+        foreach ( KPlato::Resource *r, g->resources() ) {
+            foreach ( KPlato::Appointment *a, r->appointments( scheduleId ) ) {
+                KPlato::Node *n = a->node() ? a->node()->node() : 0;
+                if ( n == 0 ) {
+                    continue;
+                }
+                foreach ( const KPlato::AppointmentInterval &ai, a->intervals().map() ) {
+                    resources << r->id();
+                    tasks << n->id();
+                    starts << ai.startTime().toString();
+                    ends << ai.endTime().toString();
+                    loads << ai.load();
+                }
+            }
+        }
+    }
+    return QVariantList() << QVariant( resources ) << QVariant( tasks ) << QVariant( starts ) << QVariant( ends ) << QVariant( loads );
+}
+
 int Scripting::Project::scheduleCount() const
 {
     return kplatoProject()->numScheduleManagers();
@@ -296,23 +425,32 @@ QObject *Scripting::Project::taskAt( int index )
     return childAt( index );
 }
 
-QVariant Scripting::Project::nodeData( const KPlato::Node *node, const QString &property, const QString &role, long schedule )
+void Scripting::Project::setNodeModelSchedule( long schedule )
 {
     KPlato::ScheduleManager *sm = kplatoProject()->scheduleManager( schedule );
     if ( m_nodeModel.scheduleManager() != sm ) {
-        m_nodeModel.setScheduleManager( kplatoProject()->scheduleManager( schedule ) );
+        m_nodeModel.setScheduleManager( sm );
     }
+}
+
+QVariant Scripting::Project::nodeData( const KPlato::Node *node, const QString &property, const QString &role, long schedule )
+{
+    setNodeModelSchedule( schedule );
     int col = nodeColumnNumber( property );
-    QModelIndex idx = m_nodeModel.index( node );
-    idx = m_nodeModel.index( idx.row(), col, idx.parent() );
-    if ( ! idx.isValid() ) {
-        debugPlanScripting<<"Failed"<<node<<property<<idx;
-        return QVariant();
-    }
     int r = stringToRole( role, m_nodeprogramroles.value( col ) );
     if ( r < 0 ) {
         return QVariant(); // invalid role
     }
+    return nodeValue( node, col, r );
+}
+
+QVariant Scripting::Project::nodeValue( const KPlato::Node *node, int col, int r )
+{
+    QModelIndex idx = m_nodeModel.index( node, col );
+    if ( ! idx.isValid() ) {
+        debugPlanScripting<<"Failed"<<node<<col<<idx;
+        return QVariant();
+    }
     if ( col == NodeModel::NodeDescription && r == Qt::DisplayRole ) {
         r = Qt::EditRole; // cannot use displayrole here
     }
@@ -106,6 +106,16 @@ namespace Scripting {
             /// Return header text
             QVariant headerData( int objectType, const QString &property, const QString &role = "DisplayRole" );
 
+            /// Return the data of all objects of @p objectType for each of the @p properties.
+            /// @p objectType is 0 for tasks, 1 for resources and 2 for accounts (as in headerData()).
+            /// The result holds one list of values per property, the values are in the same order
+            /// as a depth first traversal of the objects using childAt().
+            /// Tasks include the project itself and resources include the resource groups.
+            QVariantList columns( int objectType, const QStringList &properties, const QString &role = "DisplayRole", qlonglong scheduleId = -1 );
+            /// Return all appointment intervals in schedule @p scheduleId.
+            /// The result holds the lists of resource ids, task ids, start times, end times and loads
+            QVariantList appointmentColumns( qlonglong scheduleId );
+
             /// Return number of schedule managers
             int scheduleCount() const;
             /// Return schedule manager at @p index
@@ -240,6 +250,14 @@ namespace Scripting {
             QVariant setAccountData( KPlato::Account *account, const QString &property, const QVariant &data, const QString &role );
 
         protected:
+            /// Return the data of @p node in @p column using the model @p role
+            QVariant nodeValue( const KPlato::Node *node, int column, int role );
+            /// Set the node model to use the schedule manager with identity @p schedule
+            void setNodeModelSchedule( long schedule );
+            QVariantList nodeColumns( const QStringList &properties, const QString &role, long schedule );
+            QVariantList resourceColumns( const QStringList &properties, const QString &role );
+            QVariantList accountColumns( const QStringList &properties, const QString &role );
+
             int nodeColumnNumber( const QString &property ) const;
             /// Map program role to a role that fetches data in a format that can be used in setData()
             int programRole( const QMap<int, int> &map, int column ) const;
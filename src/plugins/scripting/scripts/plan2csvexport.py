@@ -65,26 +65,10 @@ class PlanExport:
             if len(record) > 0:
                 writer.writerow( record )
 
-        if objectType == 0: # Nodes
-            self.exportValues( writer, proj, proj, props, schedule )
-        elif objectType == 1: # Resources
-            for i in range( proj.resourceGroupCount() ):
-                self.exportValues( writer, proj, proj.resourceGroupAt( i ), props, schedule )
-        elif objectType == 2: # Accounts
-            for i in range( proj.accountCount() ):
-                self.exportValues( writer, proj, proj.accountAt( i ), props, schedule )
-
-
-    def exportValues(self, writer, project, dataobject, props, schedule ):
-        record = []
-        for prop in props:
-            record.append(project.data( dataobject, prop, "DisplayRole", schedule ))
-
-        if len(record) > 0:
-            writer.writerow( record )
-
-        for i in range( dataobject.childCount() ):
-            self.exportValues( writer, project, dataobject.childAt( i ), props, schedule )
+        # Fetch all values in one call, one list pr property
+        columns = proj.columns( objectType, props, "DisplayRole", schedule )
+        for record in zip( *columns ):
+            writer.writerow( list( record ) )
 
     def showDataSelectionDialog(self, Plan ):
         tabledialog = self.forms.createDialog("Property List")
@@ -77,26 +77,14 @@ class PlanExport:
                     return
             writer.next()
 
-        if objectType == 0: # Nodes
-            self.exportValues( writer, proj, proj, props, schedule )
-        elif objectType == 1: # Resources
-            for i in range( proj.resourceGroupCount() ):
-                self.exportValues( writer, proj, proj.resourceGroupAt( i ), props, schedule )
-        elif objectType == 2: # Accounts
-            for i in range( proj.accountCount() ):
-                self.exportValues( writer, proj, proj.accountAt( i ), props, schedule )
-
-    def exportValues(self, writer, project, dataobject, props, schedule ):
-        record = []
-        for prop in props:
-            record.append(project.data(dataobject, prop, "DisplayRole", schedule))
-
-        if not writer.setValues(record):
-            if self.forms.showMessageBox("WarningContinueCancel", T.i18n("Warning"), T.i18n("Failed to set all properties of '%1' to cell '%2'", [", ".join(record), writer.cell()])) == "Cancel":
-                return
-        writer.next()
-        for i in range( dataobject.childCount() ):
-            self.exportValues( writer, project, dataobject.childAt( i ), props, schedule )
+        # Fetch all values in one call, one list pr property
+        columns = proj.columns( objectType, props, "DisplayRole", schedule )
+        for record in zip( *columns ):
+            record = list( record )
+            if not writer.setValues(record):
+                if self.forms.showMessageBox("WarningContinueCancel", T.i18n("Warning"), T.i18n("Failed to set all properties of '%1' to cell '%2'", [", ".join(record), writer.cell()])) == "Cancel":
+                    return
+            writer.next()
 
     def showDataSelectionDialog(self, writer, Plan ):
         tabledialog = self.forms.createDialog("Property List")
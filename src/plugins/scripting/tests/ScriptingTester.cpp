@@ -23,6 +23,9 @@
 
 #include "Module.h"
 
+#include "kptmaindocument.h"
+#include "tests/ProjectGenerator.h"
+
 #include <QTest>
 #include <Kross/Core/Action>
 #include <Kross/Core/Manager>
@@ -44,6 +47,7 @@ QStringList ScriptingTester::initTestList()
         << "resource_access.py"
         << "resource_readwrite.py"
         << "resource_team.py"
+        << "columns_access.py"
         ;
     return scripts;
 }
@@ -63,6 +67,15 @@ void ScriptingTester::initTestCase()
         Kross::Manager::self().addObject( m_module, "Plan" );
         Kross::Manager::self().addObject( m_result, "TestResult" );
 
+        // A project with a calculated schedule, for the scripts that need appointments
+        Scripting::Module *scheduled = new Scripting::Module( this );
+        Project *project = ProjectGenerator::createProject( 10, 3, 1 );
+        ScheduleManager *sm = ProjectGenerator::createScheduleManager( project, "Scheduled" );
+        project->calculate( *sm );
+        QVERIFY( sm->isScheduled() );
+        scheduled->part()->setProject( project );
+        Kross::Manager::self().addObject( scheduled, "PlanScheduled" );
+
         QStringList scripts = initTestList();
         for ( int i = 0; i < scripts.count(); ++i ) {
             //Create a new Kross::Action instance.
@@ -0,0 +1,90 @@
+#!/usr/bin/env kross
+# -*- coding: utf-8 -*-
+
+import traceback
+import Kross
+import Plan
+import PlanScheduled
+import TestResult
+
+
+TestResult.setResult( True )
+asserttext = "Test of property '{0}' failed for row {1}:\n   Expected: '{3}'\n     Result: '{2}'"
+
+def collect(project, obj, lst):
+    lst.append(obj)
+    for i in range( obj.childCount() ):
+        collect(project, obj.childAt( i ), lst)
+
+def check(project, objectType, objects, props):
+    columns = project.columns( objectType, props )
+    assert len(columns) == len(props), "Wrong number of columns: {0}".format(len(columns))
+    for c in range( len( props ) ):
+        assert len(columns[c]) == len(objects), "Wrong number of rows: {0}".format(len(columns[c]))
+        for r in range( len( objects ) ):
+            data = project.data(objects[r], props[c])
+            result = columns[c][r]
+            text = asserttext.format(props[c], r, result, data)
+            assert result == data, text
+
+try:
+    project = Plan.project()
+    assert project is not None, "Project not found"
+
+    task = project.createTask( 0 )
+    assert task is not None, "Could not create task"
+    sub = project.createTask( task )
+    assert sub is not None, "Could not create sub-task"
+
+    objects = []
+    collect(project, project, objects)
+    check(project, 0, objects, ['Name', 'Type', 'WBSCode', 'Description'])
+
+    objects = []
+    for i in range( project.accountCount() ):
+        collect(project, project.accountAt( i ), objects)
+    check(project, 2, objects, ['Name', 'Description'])
+
+    group = project.createResourceGroup()
+    assert group is not None, "Could not create resource group"
+    assert project.createResource( group ) is not None, "Could not create resource"
+    assert project.createResource( group ) is not None, "Could not create resource"
+
+    objects = []
+    for i in range( project.resourceGroupCount() ):
+        collect(project, project.resourceGroupAt( i ), objects)
+    check(project, 1, objects, ['Name', 'Type', 'Email'])
+
+    # Without a schedule there are no appointments, but the columns must still be consistent
+    columns = project.appointmentColumns( -1 )
+    assert len(columns) == 5, "Wrong number of appointment columns: {0}".format(len(columns))
+    for c in range( len( columns ) ):
+        assert len(columns[c]) == len(columns[0]), "Appointment column {0} has {1} rows, expected {2}".format(c, len(columns[c]), len(columns[0]))
+    assert len(columns[0]) == 0, "Appointments without a schedule: {0}".format(len(columns[0]))
+
+    # 10 tasks, each booking one of 3 resources
+    scheduled = PlanScheduled.project()
+    assert scheduled.scheduleCount() == 1, "Wrong number of schedules: {0}".format(scheduled.scheduleCount())
+    sid = scheduled.scheduleAt( 0 ).id()
+    columns = scheduled.appointmentColumns( sid )
+    assert len(columns) == 5, "Wrong number of appointment columns: {0}".format(len(columns))
+    rows = len(columns[0])
+    assert rows >= 10, "Too few appointment rows: {0}".format(rows)
+    for c in range( len( columns ) ):
+        assert len(columns[c]) == rows, "Appointment column {0} has {1} rows, expected {2}".format(c, len(columns[c]), rows)
+    for r in range( rows ):
+        resource = scheduled.findResource( columns[0][r] )
+        assert resource is not None, "Unknown resource in row {0}: {1}".format(r, columns[0][r])
+        assert len(resource.appointmentIntervals( sid )) > 0, "Resource in row {0} has no appointments".format(r)
+        assert scheduled.findTask( columns[1][r] ) is not None, "Unknown task in row {0}: {1}".format(r, columns[1][r])
+        assert columns[2][r] != "" and columns[3][r] != "", "Missing interval in row {0}".format(r)
+        assert columns[4][r] > 0, "No load in row {0}: {1}".format(r, columns[4][r])
+    assert len(set(columns[1])) == 10, "Wrong number of booked tasks: {0}".format(len(set(columns[1])))
+    assert len(set(columns[0])) == 3, "Wrong number of booked resources: {0}".format(len(set(columns[0])))
+
+    columns = project.columns( 9, ['Name'] )
+    assert len(columns) == 0, "Invalid object type should give no data"
+
+except:
+    TestResult.setResult( False )
+    TestResult.setMessage("\n" + traceback.format_exc(1))